@@ -0,0 +1,1004 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../src/actuator_channel.h"
+#include "../src/bulk_startup.h"
+#include "../src/control_loop.h"
+#include "../src/control_strategy.h"
+#include "../src/filtered_thermometer.h"
+#include "../src/polling_thermometer.h"
+#include "../src/room_simulator.h"
+#include "../src/schedule.h"
+#include "../src/sharded_executor.h"
+#include "../src/strategy_thermostat.h"
+#include "../src/sysfs_thermometer.h"
+#include "../src/telemetry_log.h"
+#include "../src/thermostat.h"
+#include "../src/thermostat_fleet.h"
+#include "../src/thermostat_snapshot.h"
+#include "../src/trace_replay.h"
+#include "../src/zone_thermometer.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+// Thermometer driver behind the abstract interface, as a real driver would be.
+class VirtualThermometer: public Thermometer {
+public:
+    Temperature temperature = 20_degC;
+    TemperatureCallback callback;
+
+    Temperature GetTemperature() const override { return this->temperature; }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override {
+        benchmark::DoNotOptimize(high);
+        benchmark::DoNotOptimize(low);
+        return low < high;
+    }
+    void RegisterCallback(TemperatureCallback cb) override { this->callback = std::move(cb); }
+
+    void Fire(bool isHigh) { this->callback(isHigh); }
+};
+
+// Temperature controller behind the abstract interface.
+class VirtualTemperatureController: public TemperatureController {
+public:
+    bool heating = false;
+    bool cooling = false;
+
+    void Heat(bool on) override { this->heating = on; }
+    void Cool(bool on) override { this->cooling = on; }
+};
+
+// Thermometer driver used through BasicThermostat without virtual calls. The registered callable is stored in
+// place and invoked through a single function pointer.
+class InlineThermometer {
+private:
+    alignas(void *) unsigned char storage[sizeof(void *)];
+    void (*invoke)(const void *, bool) = nullptr;
+
+public:
+    Temperature temperature = 20_degC;
+
+    Temperature GetTemperature() const { return this->temperature; }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) {
+        benchmark::DoNotOptimize(high);
+        benchmark::DoNotOptimize(low);
+        return low < high;
+    }
+    template <typename Callback>
+    void RegisterCallback(Callback cb) {
+        static_assert(sizeof(Callback) <= sizeof(storage), "callback does not fit in place");
+        new (this->storage) Callback(cb);
+        this->invoke = [](const void *callable, bool isHigh) { (*static_cast<const Callback *>(callable))(isHigh); };
+    }
+
+    void Fire(bool isHigh) { this->invoke(this->storage, isHigh); }
+};
+
+// Temperature controller used through BasicThermostat without virtual calls.
+class InlineTemperatureController {
+public:
+    bool heating = false;
+    bool cooling = false;
+
+    void Heat(bool on) { this->heating = on; }
+    void Cool(bool on) { this->cooling = on; }
+};
+
+struct VirtualDrivers {
+    using Meter = VirtualThermometer;
+    using Controller = VirtualTemperatureController;
+    using Stat = Thermostat;
+};
+
+struct InlineDrivers {
+    using Meter = InlineThermometer;
+    using Controller = InlineTemperatureController;
+    using Stat = BasicThermostat<InlineThermometer, InlineTemperatureController>;
+};
+
+// Inline drivers with the metrics chosen explicitly, to measure the instrumentation overhead whatever the
+// THERMOSTAT_ENABLE_METRICS setting.
+template <typename Metrics>
+struct MeasuredInlineDrivers {
+    using Meter = InlineThermometer;
+    using Controller = InlineTemperatureController;
+    using Stat = BasicThermostat<InlineThermometer, InlineTemperatureController, std::chrono::steady_clock, Metrics>;
+};
+
+// One thermostat with its drivers, allocated together.
+template <typename Drivers>
+struct Zone {
+    typename Drivers::Meter meter;
+    typename Drivers::Controller controller;
+    typename Drivers::Stat stat{this->meter, this->controller};
+};
+
+template <typename Drivers>
+void BM_Construct(benchmark::State &state) {
+    typename Drivers::Meter meter;
+    typename Drivers::Controller controller;
+    for (auto _ : state) {
+        typename Drivers::Stat stat(meter, controller);
+        benchmark::DoNotOptimize(&stat);
+    }
+}
+BENCHMARK_TEMPLATE(BM_Construct, VirtualDrivers);
+BENCHMARK_TEMPLATE(BM_Construct, InlineDrivers);
+
+template <typename Drivers>
+void BM_ThermometerCallback(benchmark::State &state) {
+    Zone<Drivers> zone;
+    bool isHigh = false;
+    for (auto _ : state) {
+        zone.meter.Fire(isHigh);
+        isHigh = !isHigh;
+        benchmark::DoNotOptimize(zone.controller.heating);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ThermometerCallback, VirtualDrivers);
+BENCHMARK_TEMPLATE(BM_ThermometerCallback, InlineDrivers);
+BENCHMARK_TEMPLATE(BM_ThermometerCallback, MeasuredInlineDrivers<NullThermostatMetrics>);
+BENCHMARK_TEMPLATE(BM_ThermometerCallback, MeasuredInlineDrivers<ThermostatMetrics>);
+
+template <typename Drivers>
+void BM_SetTemperatureThresholds(benchmark::State &state) {
+    Zone<Drivers> zone;
+    Temperature high = 30_degC;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(zone.stat.SetTemperatureThresholds(high, 10_degC));
+        high = high == 30_degC ? 31_degC : 30_degC;
+    }
+}
+BENCHMARK_TEMPLATE(BM_SetTemperatureThresholds, VirtualDrivers);
+BENCHMARK_TEMPLATE(BM_SetTemperatureThresholds, InlineDrivers);
+BENCHMARK_TEMPLATE(BM_SetTemperatureThresholds, MeasuredInlineDrivers<NullThermostatMetrics>);
+BENCHMARK_TEMPLATE(BM_SetTemperatureThresholds, MeasuredInlineDrivers<ThermostatMetrics>);
+
+template <typename Drivers>
+void BM_EnableThermostat(benchmark::State &state) {
+    Zone<Drivers> zone;
+    for (auto _ : state) {
+        zone.stat.EnableThermostat(false);
+        zone.stat.EnableThermostat(true);
+        benchmark::DoNotOptimize(zone.controller.heating);
+    }
+}
+BENCHMARK_TEMPLATE(BM_EnableThermostat, VirtualDrivers);
+BENCHMARK_TEMPLATE(BM_EnableThermostat, InlineDrivers);
+
+// Callbacks spread over many thermostats, so that their state no longer fits in the caches.
+template <typename Drivers>
+void BM_CallbackManyThermostats(benchmark::State &state) {
+    std::vector<std::unique_ptr<Zone<Drivers>>> zones;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        zones.push_back(std::make_unique<Zone<Drivers>>());
+    }
+    std::size_t next = 0;
+    bool isHigh = false;
+    for (auto _ : state) {
+        zones[next]->meter.Fire(isHigh);
+        // Stride through the zones so consecutive callbacks do not touch neighbouring memory.
+        next = (next + 7919) % zones.size();
+        isHigh = !isHigh;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_CallbackManyThermostats, VirtualDrivers)->RangeMultiplier(8)->Range(1, 1 << 18);
+BENCHMARK_TEMPLATE(BM_CallbackManyThermostats, InlineDrivers)->RangeMultiplier(8)->Range(1, 1 << 18);
+// The histograms make each thermostat about 800 bytes larger, which shows once the zones leave the caches.
+BENCHMARK_TEMPLATE(BM_CallbackManyThermostats, MeasuredInlineDrivers<NullThermostatMetrics>)
+    ->RangeMultiplier(64)->Range(1, 1 << 18);
+BENCHMARK_TEMPLATE(BM_CallbackManyThermostats, MeasuredInlineDrivers<ThermostatMetrics>)
+    ->RangeMultiplier(64)->Range(1, 1 << 18);
+
+// The same decisions evaluated by ThermostatFleet in one pass, reported per zone.
+void BM_FleetEvaluate(benchmark::State &state) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+    std::vector<Temperature> readings(state.range(0));
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        fleet.AddZone(20_degC);
+        readings[i] = Temperature::FromCelsius(static_cast<int>(i % 60) - 10);
+    }
+    fleet.Evaluate(changes);
+    for (auto _ : state) {
+        for (Temperature &reading : readings) {
+            reading = reading == 59_degC ? -10_degC : reading + 1_degC;
+        }
+        fleet.SetReadings(readings.data(), readings.size());
+        fleet.Evaluate(changes);
+        benchmark::DoNotOptimize(changes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FleetEvaluate)->RangeMultiplier(8)->Range(1 << 9, 1 << 18);
+
+// Telemetry appends into a ring of a million records, from one or more threads.
+TelemetryLog *sharedTelemetry = nullptr;
+const char *const telemetryPath = "thermostat_bench.tlm";
+
+void OpenTelemetry(const benchmark::State &) {
+    std::remove(telemetryPath);
+    sharedTelemetry = new TelemetryLog;
+    sharedTelemetry->Open(telemetryPath, 1 << 20);
+}
+
+void CloseTelemetry(const benchmark::State &) {
+    delete sharedTelemetry;
+    sharedTelemetry = nullptr;
+    std::remove(telemetryPath);
+}
+
+void BM_TelemetryAppend(benchmark::State &state) {
+    int value = 0;
+    for (auto _ : state) {
+        sharedTelemetry->Append(0, TelemetryEvent::Reading, ++value, 0);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(TelemetryRecord));
+}
+BENCHMARK(BM_TelemetryAppend)->Setup(OpenTelemetry)->Teardown(CloseTelemetry)->ThreadRange(1, 4)->UseRealTime();
+
+// Thermometer callbacks of a thermostat recording its alarms and decisions.
+template <typename Drivers>
+void BM_ThermometerCallbackTelemetry(benchmark::State &state) {
+    Zone<Drivers> zone;
+    zone.stat.AttachTelemetry(sharedTelemetry, 1);
+    bool isHigh = false;
+    for (auto _ : state) {
+        zone.meter.Fire(isHigh);
+        isHigh = !isHigh;
+        benchmark::DoNotOptimize(zone.controller.heating);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ThermometerCallbackTelemetry, VirtualDrivers)->Setup(OpenTelemetry)->Teardown(CloseTelemetry);
+BENCHMARK_TEMPLATE(BM_ThermometerCallbackTelemetry, InlineDrivers)->Setup(OpenTelemetry)->Teardown(CloseTelemetry);
+
+// Sensor threads posting notifications for their own thermostat into one shared control loop.
+ControlLoop *sharedLoop = nullptr;
+
+void StartSharedLoop(const benchmark::State &) {
+    sharedLoop = new ControlLoop(1 << 16);
+    sharedLoop->Start();
+}
+
+void StopSharedLoop(const benchmark::State &) {
+    delete sharedLoop;
+    sharedLoop = nullptr;
+}
+
+void BM_CallbackContention(benchmark::State &state) {
+    VirtualThermometer meter;
+    VirtualTemperatureController controller;
+    Thermostat stat(meter, controller, *sharedLoop);
+    bool isHigh = false;
+    for (auto _ : state) {
+        meter.Fire(isHigh);
+        isHigh = !isHigh;
+    }
+    state.SetItemsProcessed(state.iterations());
+    // The thermostat must not be destroyed while its events are queued.
+    sharedLoop->WaitIdle();
+
+    if (state.thread_index() == 0) {
+        ControlLoopStats stats = sharedLoop->GetStats();
+        state.counters["dropped"] = static_cast<double>(stats.dropped);
+        state.counters["max_depth"] = static_cast<double>(stats.maxQueueDepth);
+        state.counters["p99_ns"] = static_cast<double>(stats.p99Latency.count());
+    }
+}
+BENCHMARK(BM_CallbackContention)->Setup(StartSharedLoop)->Teardown(StopSharedLoop)->ThreadRange(1, 8)->UseRealTime();
+
+// Thermometer decorator counting the notifications delivered to the thermostat.
+class CountingThermometer: public Thermometer {
+private:
+    Thermometer &inner;
+    TemperatureCallback forward; // Callback registered by the thermostat.
+
+public:
+    std::uint64_t callbacks = 0;
+
+    explicit CountingThermometer(Thermometer &meter): inner(meter) {}
+
+    Temperature GetTemperature() const override { return this->inner.GetTemperature(); }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override { return this->inner.SetTemperatureThresholds(high, low); }
+    void RegisterCallback(TemperatureCallback callback) override {
+        this->forward = callback;
+        this->inner.RegisterCallback([this](bool isHigh) {
+            ++this->callbacks;
+            this->forward(isHigh);
+        });
+    }
+};
+
+// A simulated year of one room in threshold mode (range 0) and deadband mode (range 1) on the same 19..23 band,
+// reporting the notifications and actuator transitions per simulated day.
+void BM_ControlModeYear(benchmark::State &state) {
+    std::uint64_t callbacks = 0;
+    std::uint64_t transitions = 0;
+    for (auto _ : state) {
+        RoomSimulation simulation;
+        SimulatedRoom &room = simulation.AddRoom();
+        CountingThermometer meter(room.GetThermometer());
+        Thermostat stat(meter, room.GetController());
+        if (state.range(0) == 0) {
+            stat.SetTemperatureThresholds(23_degC, 19_degC);
+        }
+        else {
+            stat.SetDeadbandMode(21_degC, 2_degC);
+        }
+        simulation.Run(std::chrono::hours(24 * 365), std::chrono::minutes(1), 1);
+        callbacks = meter.callbacks;
+        transitions = room.GetController().Transitions();
+    }
+    state.counters["callbacks_per_day"] = static_cast<double>(callbacks) / 365.0;
+    state.counters["transitions_per_day"] = static_cast<double>(transitions) / 365.0;
+}
+BENCHMARK(BM_ControlModeYear)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// One tick of a poll scheduler shared by many polled sensors with stable readings, whose intervals have backed
+// off to between 10 and 60 seconds. The cost per tick follows the polls due, not the number of sensors.
+void BM_PollSchedulerTick(benchmark::State &state) {
+    PollScheduler scheduler(std::chrono::milliseconds(10));
+    std::vector<std::unique_ptr<PollingThermometer>> meters;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        PollingPolicy policy{std::chrono::seconds(10 + i % 51), std::chrono::seconds(10 + i % 51)};
+        meters.push_back(std::make_unique<PollingThermometer>(scheduler, []() { return 20_degC; }, policy));
+    }
+    for (auto _ : state) {
+        scheduler.Advance(1);
+    }
+    std::uint64_t polls = 0;
+    for (const std::unique_ptr<PollingThermometer> &meter : meters) {
+        polls += meter->Polls();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["polls_per_tick"] = static_cast<double>(polls) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_PollSchedulerTick)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+
+// Replay of a thousand day-long traces of noisy sensors on a work-stealing pool, reporting samples per second.
+void BM_TraceReplay(benchmark::State &state) {
+    std::vector<Trace> traces(1000);
+    std::uint32_t noise = 1;
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        for (int minute = 0; minute < 24 * 60; ++minute) {
+            noise = noise * 1664525u + 1013904223u;
+            int temperature = 21 + (minute / 30 + static_cast<int>(i)) % 9 - 4 + static_cast<int>(noise >> 30) - 1;
+            traces[i].push_back(TraceSample{std::chrono::minutes(minute), Temperature::FromCelsius(temperature)});
+        }
+    }
+    WorkStealingPool pool(static_cast<unsigned>(state.range(0)));
+    ReplayConfiguration configure = [](ReplayThermostat &stat) { stat.SetDeadbandMode(21_degC, 2_degC); };
+
+    double samplesPerSecond = 0.0;
+    for (auto _ : state) {
+        ReplayResult result = ReplayTraces(traces, configure, pool);
+        samplesPerSecond = result.SamplesPerSecond();
+        benchmark::DoNotOptimize(result.commands.data());
+    }
+    state.counters["samples_per_second"] = samplesPerSecond;
+}
+BENCHMARK(BM_TraceReplay)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Thermometer on a slow bus: every read blocks for 200us, as an I2C or 1-Wire sensor would.
+class SlowBusThermometer: public Thermometer {
+public:
+    TemperatureCallback callback;
+
+    Temperature GetTemperature() const override {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        return 20_degC;
+    }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override { return low < high; }
+    void RegisterCallback(TemperatureCallback cb) override { this->callback = std::move(cb); }
+};
+
+// Startup of 256 zones on slow sensors with the given number of reads in flight. With one read in flight this is
+// the cost of constructing the thermostats one after the other.
+void BM_BulkStartup(benchmark::State &state) {
+    constexpr std::size_t zones = 256;
+    std::vector<SlowBusThermometer> meters(zones);
+    std::vector<VirtualTemperatureController> controllers(zones);
+    BulkStartupReport report;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<std::unique_ptr<Thermostat>> stats;
+        std::vector<StartupZone<Thermostat, SlowBusThermometer>> startup;
+        for (std::size_t i = 0; i < zones; ++i) {
+            stats.push_back(std::make_unique<Thermostat>(meters[i], controllers[i], deferredStart));
+            startup.push_back({stats.back().get(), &meters[i]});
+        }
+        state.ResumeTiming();
+        report = StartThermostats(startup, static_cast<unsigned>(state.range(0))).get();
+    }
+    state.SetItemsProcessed(state.iterations() * zones);
+    state.counters["p50_us"] = std::chrono::duration<double, std::micro>(report.Percentile(0.5)).count();
+    state.counters["p99_us"] = std::chrono::duration<double, std::micro>(report.Percentile(0.99)).count();
+}
+BENCHMARK(BM_BulkStartup)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Thermometer counting the reads made on the sensor bus.
+class CountingBusThermometer: public Thermometer {
+public:
+    Temperature temperature = 20_degC;
+    mutable std::uint64_t reads = 0;
+    TemperatureCallback callback;
+
+    Temperature GetTemperature() const override {
+        ++this->reads;
+        return this->temperature;
+    }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override { return low < high; }
+    void RegisterCallback(TemperatureCallback cb) override { this->callback = std::move(cb); }
+};
+
+// Temperature controller counting the actuator writes.
+class CountingTemperatureController: public TemperatureController {
+public:
+    std::uint64_t writes = 0;
+
+    void Heat(bool) override { ++this->writes; }
+    void Cool(bool) override { ++this->writes; }
+};
+
+constexpr std::size_t restartZones = 100000;
+
+// Start of 100k zones from scratch: every thermostat reads its sensor and writes its actuators.
+void BM_ColdStart(benchmark::State &state) {
+    std::vector<CountingBusThermometer> meters(restartZones);
+    std::vector<CountingTemperatureController> controllers(restartZones);
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<Thermostat>> stats;
+        stats.reserve(restartZones);
+        for (std::size_t i = 0; i < restartZones; ++i) {
+            stats.push_back(std::make_unique<Thermostat>(meters[i], controllers[i]));
+        }
+        state.PauseTiming();
+        stats.clear();
+        state.ResumeTiming();
+    }
+    std::uint64_t reads = 0;
+    std::uint64_t writes = 0;
+    for (std::size_t i = 0; i < restartZones; ++i) {
+        reads += meters[i].reads;
+        writes += controllers[i].writes;
+    }
+    double starts = static_cast<double>(state.iterations() * restartZones);
+    state.counters["reads_per_zone"] = static_cast<double>(reads) / starts;
+    state.counters["writes_per_zone"] = static_cast<double>(writes) / starts;
+}
+BENCHMARK(BM_ColdStart)->Unit(benchmark::kMillisecond);
+
+// Restart of the same 100k zones from a snapshot file, including mapping the file.
+void BM_WarmRestart(benchmark::State &state) {
+    std::string path = std::string(std::getenv("TMPDIR") != nullptr ? std::getenv("TMPDIR") : "/tmp") +
+                       "/thermostat_bench.snap";
+    std::vector<CountingBusThermometer> meters(restartZones);
+    std::vector<CountingTemperatureController> controllers(restartZones);
+    {
+        ThermostatSnapshotWriter writer;
+        if (!writer.Create(path, restartZones)) {
+            state.SkipWithError("cannot create the snapshot file");
+            return;
+        }
+        for (std::size_t i = 0; i < restartZones; ++i) {
+            Thermostat stat(meters[i], controllers[i]);
+            stat.SetTemperatureThresholds(25_degC, 15_degC);
+            writer[i] = stat.SaveState();
+        }
+        writer.Commit();
+    }
+    for (std::size_t i = 0; i < restartZones; ++i) {
+        meters[i].reads = 0;
+        controllers[i].writes = 0;
+    }
+
+    for (auto _ : state) {
+        ThermostatSnapshot snapshot;
+        snapshot.Open(path);
+        std::vector<std::unique_ptr<Thermostat>> stats;
+        stats.reserve(snapshot.Size());
+        for (std::size_t i = 0; i < snapshot.Size(); ++i) {
+            stats.push_back(std::make_unique<Thermostat>(meters[i], controllers[i], snapshot[i]));
+        }
+        state.PauseTiming();
+        stats.clear();
+        state.ResumeTiming();
+    }
+    std::uint64_t reads = 0;
+    std::uint64_t writes = 0;
+    for (std::size_t i = 0; i < restartZones; ++i) {
+        reads += meters[i].reads;
+        writes += controllers[i].writes;
+    }
+    double starts = static_cast<double>(state.iterations() * restartZones);
+    state.counters["reads_per_zone"] = static_cast<double>(reads) / starts;
+    state.counters["writes_per_zone"] = static_cast<double>(writes) / starts;
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_WarmRestart)->Unit(benchmark::kMillisecond);
+
+// One sensor reading changing in a zone of range(0) sensors, aggregate update only.
+template <Aggregation Kind>
+void BM_SensorAggregateUpdate(benchmark::State &state) {
+    std::size_t sensors = static_cast<std::size_t>(state.range(0));
+    SensorAggregate aggregate(Kind, sensors);
+    std::uint32_t noise = 1;
+    for (std::size_t i = 0; i < sensors; ++i) {
+        aggregate.Update(i, Temperature::FromCelsius(20 + static_cast<int>(i % 5)));
+    }
+    std::size_t sensor = 0;
+    for (auto _ : state) {
+        noise = noise * 1664525u + 1013904223u;
+        aggregate.Update(sensor, Temperature::FromDeciCelsius(150 + static_cast<int>(noise >> 24)));
+        benchmark::DoNotOptimize(aggregate.Value());
+        sensor = sensor + 1 == sensors ? 0 : sensor + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SensorAggregateUpdate, Aggregation::Mean)->RangeMultiplier(2)->Range(4, 32);
+BENCHMARK_TEMPLATE(BM_SensorAggregateUpdate, Aggregation::Median)->RangeMultiplier(2)->Range(4, 32);
+BENCHMARK_TEMPLATE(BM_SensorAggregateUpdate, Aggregation::Max)->RangeMultiplier(2)->Range(4, 32);
+
+// A sensor notification through a median zone thermometer of range(0) sensors: read, aggregate update, re-arm.
+void BM_ZoneSensorNotification(benchmark::State &state) {
+    std::vector<VirtualThermometer> meters(static_cast<std::size_t>(state.range(0)));
+    std::vector<Thermometer *> sensors;
+    for (VirtualThermometer &meter : meters) {
+        sensors.push_back(&meter);
+    }
+    ZoneThermometer zone(sensors, Aggregation::Median);
+    std::size_t sensor = 0;
+    for (auto _ : state) {
+        meters[sensor].temperature = meters[sensor].temperature == 20_degC ? 24_degC : 20_degC;
+        meters[sensor].Fire(meters[sensor].temperature == 24_degC);
+        sensor = sensor + 1 == meters.size() ? 0 : sensor + 1;
+    }
+    benchmark::DoNotOptimize(zone.GetTemperature());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ZoneSensorNotification)->RangeMultiplier(2)->Range(4, 32);
+
+// One sample of range(0) sysfs temperature files by the reactor: a pread and a parse per sensor.
+void BM_SysfsSample(benchmark::State &state) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "thermostat_bench_sysfs";
+    SysfsReactor reactor;
+    std::vector<std::unique_ptr<SysfsThermometer>> meters;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        std::filesystem::path zone = root / "class" / "thermal" / ("thermal_zone" + std::to_string(i));
+        std::filesystem::create_directories(zone);
+        std::ofstream(zone / "temp") << 20000 + 1000 * (i % 10) << "\n";
+    }
+    for (const SysfsSensor &sensor : DiscoverSysfsSensors(root.string())) {
+        meters.push_back(std::make_unique<SysfsThermometer>(reactor));
+        meters.back()->Open(sensor.path);
+    }
+    for (auto _ : state) {
+        reactor.Sample();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    meters.clear();
+    std::filesystem::remove_all(root);
+}
+BENCHMARK(BM_SysfsSample)->RangeMultiplier(8)->Range(1, 64);
+
+
+// Relay daemon standing in for the privileged process, draining a shared memory actuator channel.
+class ShmRelayDaemon {
+public:
+    static constexpr const char *name = "/thermostat_bench_actuators";
+    ActuatorChannelConsumer consumer;
+    std::atomic<bool> running;
+    std::uint64_t applied = 0;
+    std::thread thread;
+
+    ShmRelayDaemon(): running(true) {
+        this->consumer.Create(name, 4096);
+        this->thread = std::thread([this]() {
+            while (this->running.load(std::memory_order_relaxed)) {
+                if (this->consumer.Drain([this](const ActuatorCommandRecord &command) {
+                        this->applied += command.heat + command.cool; }) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    ~ShmRelayDaemon() {
+        this->running.store(false);
+        this->thread.join();
+    }
+};
+
+// Socket baseline: the same commands over a local seqpacket socket, one message per batch. The daemon answers
+// with the sequence of the last command of messages whose last command has reserved set to 1.
+class SocketRelayDaemon {
+public:
+    int fds[2];
+    std::uint64_t applied = 0;
+    std::thread thread;
+
+    SocketRelayDaemon() {
+        ::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, this->fds);
+        this->thread = std::thread([this]() {
+            ActuatorCommandRecord batch[ActuatorChannel::maxBatch];
+            ssize_t length;
+            while ((length = ::recv(this->fds[1], batch, sizeof(batch), 0)) > 0) {
+                std::size_t count = static_cast<std::size_t>(length) / sizeof(ActuatorCommandRecord);
+                for (std::size_t i = 0; i < count; ++i) {
+                    this->applied += batch[i].heat + batch[i].cool;
+                }
+                if (batch[count - 1].reserved == 1 &&
+                        ::send(this->fds[1], &batch[count - 1].sequence, sizeof(std::uint64_t), 0) < 0) {
+                    break;
+                }
+            }
+        });
+    }
+    ~SocketRelayDaemon() {
+        ::shutdown(this->fds[0], SHUT_RDWR);
+        this->thread.join();
+        ::close(this->fds[0]);
+        ::close(this->fds[1]);
+    }
+
+    // Sends count commands in one message, and waits for the acknowledgement if asked.
+    bool Send(ActuatorCommandRecord *batch, std::size_t count, bool acknowledge) {
+        batch[count - 1].reserved = acknowledge ? 1 : 0;
+        if (::send(this->fds[0], batch, count * sizeof(ActuatorCommandRecord), 0) < 0) {
+            return false;
+        }
+        std::uint64_t sequence = 0;
+        return !acknowledge || ::recv(this->fds[0], &sequence, sizeof(sequence), 0) == sizeof(sequence);
+    }
+};
+
+// One actuator command applied by the relay daemon and acknowledged, through the shared memory channel.
+void BM_ActuatorRoundTripShm(benchmark::State &state) {
+    ShmRelayDaemon daemon;
+    ActuatorChannel channel;
+    channel.Open(ShmRelayDaemon::name);
+    bool heat = false;
+    for (auto _ : state) {
+        heat = !heat;
+        channel.Submit(0, heat, !heat);
+        channel.WaitForAcknowledgement(channel.PublishedSequence(), std::chrono::seconds(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ActuatorRoundTripShm)->UseRealTime();
+
+// The same round trip through the socket baseline.
+void BM_ActuatorRoundTripSocket(benchmark::State &state) {
+    SocketRelayDaemon daemon;
+    ActuatorCommandRecord command{};
+    for (auto _ : state) {
+        ++command.sequence;
+        command.heat = command.heat == 0 ? 1 : 0;
+        command.cool = command.heat == 0 ? 1 : 0;
+        daemon.Send(&command, 1, true);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ActuatorRoundTripSocket)->UseRealTime();
+
+// 1024 commands in batches of range(0), acknowledged once at the end, through the shared memory channel.
+void BM_ActuatorThroughputShm(benchmark::State &state) {
+    ShmRelayDaemon daemon;
+    ActuatorChannel channel;
+    channel.Open(ShmRelayDaemon::name, static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (std::uint32_t zone = 0; zone < 1024; ++zone) {
+            while (!channel.Submit(zone, zone % 2 == 0, zone % 2 == 1)) {
+                std::this_thread::yield();
+            }
+        }
+        while (!channel.Flush()) {
+            std::this_thread::yield();
+        }
+        channel.WaitForAcknowledgement(channel.PublishedSequence(), std::chrono::seconds(1));
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_ActuatorThroughputShm)->RangeMultiplier(8)->Range(1, 64)->UseRealTime();
+
+// The same commands through the socket baseline, one message per batch.
+void BM_ActuatorThroughputSocket(benchmark::State &state) {
+    SocketRelayDaemon daemon;
+    std::size_t batchSize = static_cast<std::size_t>(state.range(0));
+    ActuatorCommandRecord batch[ActuatorChannel::maxBatch] = {};
+    std::uint64_t sequence = 0;
+    for (auto _ : state) {
+        for (std::uint32_t zone = 0; zone < 1024; zone += batchSize) {
+            for (std::size_t i = 0; i < batchSize; ++i) {
+                batch[i].sequence = ++sequence;
+                batch[i].zone = zone + i;
+                batch[i].heat = (zone + i) % 2 == 0;
+                batch[i].cool = (zone + i) % 2 == 1;
+            }
+            daemon.Send(batch, batchSize, zone + batchSize >= 1024);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_ActuatorThroughputSocket)->RangeMultiplier(8)->Range(1, 64)->UseRealTime();
+
+// Thermostat standing in for the zones of the schedule benchmarks, so that only the scheduling is measured.
+struct ScheduledZone {
+    Temperature high;
+    Temperature low;
+
+    bool SetTemperatureThresholds(Temperature newHigh, Temperature newLow) {
+        this->high = newHigh;
+        this->low = newLow;
+        return newLow < newHigh;
+    }
+};
+
+constexpr std::size_t scheduledZones = 100000;
+
+// Schedules of 100k zones drawn from 1000 variants of an office week, with occupancy starting and ending at
+// different times.
+std::vector<ScheduleTable::ScheduleId> BuildSchedules(ScheduleTable &table) {
+    std::vector<ScheduleTable::ScheduleId> schedules(scheduledZones);
+    for (std::size_t i = 0; i < scheduledZones; ++i) {
+        unsigned variant = static_cast<unsigned>(i % 1000);
+        std::vector<ScheduleEntry> periods;
+        for (unsigned day = 0; day < 5; ++day) {
+            periods.push_back(ScheduleEntry{23_degC, 20_degC, WeekMinute(day, 6, variant % 120)});
+            periods.push_back(ScheduleEntry{28_degC, 15_degC, WeekMinute(day, 17, variant / 120 * 15)});
+        }
+        table.Add(periods, schedules[i]);
+    }
+    return schedules;
+}
+
+// One minute of the schedules of 100k zones through the scheduler, averaged over a week of minutes.
+void BM_ScheduleAdvance(benchmark::State &state) {
+    ScheduleTable table;
+    std::vector<ScheduleTable::ScheduleId> schedules = BuildSchedules(table);
+    std::vector<ScheduledZone> zones(scheduledZones);
+    BasicThermostatScheduler<ScheduledZone> scheduler(table, scheduledZones, ScheduleTime(0));
+    for (std::size_t i = 0; i < scheduledZones; ++i) {
+        BasicThermostatScheduler<ScheduledZone>::ZoneId zone;
+        scheduler.Attach(zones[i], schedules[i], zone);
+    }
+    ScheduleTime now(0);
+    std::size_t changed = 0;
+    for (auto _ : state) {
+        now += std::chrono::minutes(1);
+        changed += scheduler.Advance(now);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["schedules"] = static_cast<double>(table.Size());
+    state.counters["changes_per_minute"] = static_cast<double>(changed) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_ScheduleAdvance);
+
+// The same minute as an external service would run it: every zone is looked up and its thresholds set again.
+void BM_ScheduleRescan(benchmark::State &state) {
+    ScheduleTable table;
+    std::vector<ScheduleTable::ScheduleId> schedules = BuildSchedules(table);
+    std::vector<ScheduledZone> zones(scheduledZones);
+    ScheduleTime now(0);
+    for (auto _ : state) {
+        now += std::chrono::minutes(1);
+        for (std::size_t i = 0; i < scheduledZones; ++i) {
+            ScheduleTime next;
+            const ScheduleEntry &period = table.Lookup(schedules[i], now, next);
+            zones[i].SetTemperatureThresholds(period.high, period.low);
+        }
+        benchmark::DoNotOptimize(zones.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScheduleRescan)->Unit(benchmark::kMillisecond);
+
+// Day-long traces of a room swinging through the thresholds, read by a sensor with up to 0.8 °C of noise.
+std::vector<Trace> NoisyTraces() {
+    std::vector<Trace> traces(100);
+    std::uint32_t noise = 1;
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        for (int minute = 0; minute < 24 * 60; ++minute) {
+            noise = noise * 1664525u + 1013904223u;
+            int swing = (minute + static_cast<int>(i) * 7) % 240;
+            int tenths = 160 + (swing < 120 ? swing : 240 - swing) * 80 / 120 + static_cast<int>(noise >> 28) - 8;
+            traces[i].push_back(TraceSample{std::chrono::minutes(minute), Temperature::FromDeciCelsius(tenths)});
+        }
+    }
+    return traces;
+}
+
+// Replay of noisy traces through the given smoothing and a 15 minute debounce window, reporting the actuator
+// commands issued per trace. Raw readings are replayed unfiltered.
+template <Smoothing smoothing>
+void BM_NoisySensorFiltering(benchmark::State &state) {
+    std::vector<Trace> traces = NoisyTraces();
+    ReplayConfiguration configure = [](ReplayThermostat &stat) { stat.SetTemperatureThresholds(23_degC, 17_degC); };
+    FilterSettings settings;
+    settings.smoothing = smoothing;
+    settings.debounce = smoothing == Smoothing::None ? std::chrono::minutes(0) : std::chrono::minutes(15);
+    const FilterSettings *filter = smoothing == Smoothing::None ? nullptr : &settings;
+
+    std::size_t commands = 0;
+    std::size_t samples = 0;
+    for (auto _ : state) {
+        commands = 0;
+        for (const Trace &trace : traces) {
+            CommandStream stream = ReplayTrace(trace, configure, filter);
+            commands += stream.size();
+            samples += trace.size();
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(samples));
+    state.counters["commands_per_trace"] = static_cast<double>(commands) / static_cast<double>(traces.size());
+}
+BENCHMARK_TEMPLATE(BM_NoisySensorFiltering, Smoothing::None)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_NoisySensorFiltering, Smoothing::Exponential)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_NoisySensorFiltering, Smoothing::MovingAverage)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_NoisySensorFiltering, Smoothing::Kalman)->Unit(benchmark::kMillisecond);
+
+// Threaded thermostat of one zone, deciding on the shard of the zone.
+struct ShardedZone {
+    using Stat = BasicThermostat<InlineThermometer, InlineTemperatureController, std::chrono::steady_clock,
+                                 NullThermostatMetrics>;
+
+    InlineThermometer meter;
+    InlineTemperatureController controller;
+    Stat stat;
+
+    explicit ShardedZone(ControlLoop &loop): stat(this->meter, this->controller, loop) {}
+};
+
+// A burst of one notification per zone, as after an HVAC restart, handled by a sharded executor with the given
+// number of workers. The burst is queued while the executor is stopped, then timed from Start until every decision
+// is made, so the rate is that of the workers alone. 64 shards, so that idle workers can steal.
+void BM_ShardedBurst(benchmark::State &state) {
+    constexpr std::size_t zoneCount = 1 << 15;
+    constexpr std::size_t shardCount = 64;
+    ShardedExecutor executor(shardCount, static_cast<unsigned>(state.range(0)), 2 * zoneCount / shardCount);
+    std::vector<std::unique_ptr<ShardedZone>> zones;
+    for (std::uint32_t i = 0; i < zoneCount; ++i) {
+        zones.push_back(std::make_unique<ShardedZone>(executor.LoopFor(i)));
+    }
+
+    bool isHigh = false;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (std::unique_ptr<ShardedZone> &zone : zones) {
+            zone->meter.Fire(isHigh);
+        }
+        isHigh = !isHigh;
+        state.ResumeTiming();
+        executor.Start();
+        executor.WaitIdle();
+        executor.Stop();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(zoneCount));
+    state.counters["steals"] = benchmark::Counter(static_cast<double>(executor.Steals()),
+                                                  benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ShardedBurst)->RangeMultiplier(2)->Range(1, 32)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Settings of each strategy kind for the strategy benchmarks, all holding 21 °C: on/off between 20 and 22 °C,
+// deadband of 1 °C, PI over 30 minute cycles.
+StrategySettings HoldTwentyOne(StrategyKind kind) {
+    StrategySettings settings;
+    settings.kind = kind;
+    settings.onOff = OnOffStrategy{22_degC, 20_degC};
+    settings.deadband = DeadbandStrategy{21_degC, 1_degC};
+    return settings;
+}
+
+// Readings wandering around 21 °C, so that every strategy changes its decision now and then.
+std::vector<Temperature> WanderingReadings() {
+    std::vector<Temperature> readings(4096);
+    std::uint32_t noise = 1;
+    int tenths = 210;
+    for (Temperature &reading : readings) {
+        noise = noise * 1664525u + 1013904223u;
+        tenths = std::clamp(tenths + static_cast<int>(noise >> 30) - 1 - (tenths - 210) / 16, 170, 250);
+        reading = Temperature::FromDeciCelsius(tenths);
+    }
+    return readings;
+}
+
+// One decision of a strategy thermostat on a new reading, with the strategy chosen at compile time and inline
+// drivers: reading, decision, and the actuator and threshold writes when the decision changes.
+template <typename Strategy>
+void BM_StrategyDecision(benchmark::State &state) {
+    StrategySettings settings = HoldTwentyOne(static_cast<StrategyKind>(state.range(0)));
+    Strategy strategy = [&settings]() {
+        if constexpr (std::is_same_v<Strategy, PiStrategy>) {
+            return PiStrategy(settings.pi);
+        }
+        else if constexpr (std::is_same_v<Strategy, DeadbandStrategy>) {
+            return settings.deadband;
+        }
+        else {
+            return settings.onOff;
+        }
+    }();
+    std::vector<Temperature> readings = WanderingReadings();
+    InlineThermometer meter;
+    InlineTemperatureController controller;
+    BasicStrategyThermostat<Strategy, InlineThermometer, InlineTemperatureController> stat(meter, controller, strategy);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        meter.temperature = readings[next];
+        stat.Poll();
+        next = (next + 1) % readings.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["transitions"] = benchmark::Counter(static_cast<double>(stat.Transitions()),
+                                                       benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_StrategyDecision, OnOffStrategy)->Arg(static_cast<int>(StrategyKind::OnOff));
+BENCHMARK_TEMPLATE(BM_StrategyDecision, DeadbandStrategy)->Arg(static_cast<int>(StrategyKind::Deadband));
+BENCHMARK_TEMPLATE(BM_StrategyDecision, PiStrategy)->Arg(static_cast<int>(StrategyKind::Pi));
+
+// The same decisions with the strategy chosen at runtime, made by MakeControlStrategy and called through the
+// ControlStrategy interface.
+void BM_RuntimeStrategyDecision(benchmark::State &state) {
+    std::unique_ptr<ControlStrategy> strategy;
+    MakeControlStrategy(HoldTwentyOne(static_cast<StrategyKind>(state.range(0))), strategy);
+    std::vector<Temperature> readings = WanderingReadings();
+    InlineThermometer meter;
+    InlineTemperatureController controller;
+    BasicStrategyThermostat<ControlStrategy, InlineThermometer, InlineTemperatureController> stat(meter, controller,
+                                                                                                  *strategy);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        meter.temperature = readings[next];
+        stat.Poll();
+        next = (next + 1) % readings.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RuntimeStrategyDecision)->DenseRange(0, 2);
+
+// A simulated year of one room polled every minute under each strategy (range: StrategyKind), reporting the
+// actuator transitions per simulated day and the mean distance to 21 °C.
+void BM_StrategyYear(benchmark::State &state) {
+    std::uint64_t transitions = 0;
+    double error = 0.0;
+    for (auto _ : state) {
+        std::unique_ptr<ControlStrategy> strategy;
+        MakeControlStrategy(HoldTwentyOne(static_cast<StrategyKind>(state.range(0))), strategy);
+        RoomSimulation simulation;
+        SimulatedRoom &room = simulation.AddRoom();
+        StrategyThermostat stat(room.GetThermometer(), room.GetController(), *strategy);
+        double totalError = 0.0;
+        simulation.SetStepHook([&stat, &room, &totalError](std::size_t) {
+            stat.Poll();
+            totalError += std::abs(room.Temperature() - 21.0);
+        });
+        simulation.Run(std::chrono::hours(24 * 365), std::chrono::minutes(1), 1);
+        transitions = room.GetController().Transitions();
+        error = totalError / (365.0 * 24 * 60);
+    }
+    state.counters["transitions_per_day"] = static_cast<double>(transitions) / 365.0;
+    state.counters["mean_error_degC"] = error;
+}
+BENCHMARK(BM_StrategyYear)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,241 @@
+#include "actuator_channel.h"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool ValidHeader(const ActuatorChannelHeader &header, std::size_t objectSize) {
+    return header.magic == ActuatorChannelHeader::expectedMagic &&
+           header.version == ActuatorChannelHeader::currentVersion &&
+           header.cellSize == sizeof(ActuatorChannelCell) &&
+           std::has_single_bit(header.capacity) &&
+           objectSize == sizeof(ActuatorChannelHeader) + header.capacity * sizeof(ActuatorChannelCell);
+}
+
+ActuatorChannelCell *CellsOf(ActuatorChannelHeader *header) {
+    return reinterpret_cast<ActuatorChannelCell *>(reinterpret_cast<char *>(header) + sizeof(ActuatorChannelHeader));
+}
+
+std::int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+ActuatorChannel::ActuatorChannel():
+        header(nullptr),
+        cells(nullptr),
+        mappedSize(0),
+        batchSize(1),
+        batch{},
+        batched(0),
+        lastSequence(0) {
+}
+
+ActuatorChannel::~ActuatorChannel() {
+    this->Close();
+}
+
+bool ActuatorChannel::Open(const std::string &name, std::size_t batch) {
+    this->Close();
+    int object = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (object < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(object, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(ActuatorChannelHeader)) {
+        ::close(object);
+        return false;
+    }
+
+    // The mapping stays valid once the descriptor is closed.
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, object, 0);
+    ::close(object);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    ActuatorChannelHeader *mappedHeader = static_cast<ActuatorChannelHeader *>(mapping);
+    if (!ValidHeader(*mappedHeader, size)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(this->batchMutex);
+    this->header = mappedHeader;
+    this->cells = CellsOf(mappedHeader);
+    this->mappedSize = size;
+    // A batch larger than the ring could never be published.
+    this->batchSize = std::clamp<std::size_t>(batch, 1, std::min<std::size_t>(maxBatch, mappedHeader->capacity));
+    this->batched = 0;
+    this->lastSequence = 0;
+    return true;
+}
+
+void ActuatorChannel::Close() {
+    std::lock_guard<std::mutex> lock(this->batchMutex);
+    if (this->header != nullptr) {
+        this->Publish();
+        ::munmap(this->header, this->mappedSize);
+        this->header = nullptr;
+        this->cells = nullptr;
+        this->mappedSize = 0;
+        this->batched = 0;
+    }
+}
+
+bool ActuatorChannel::Submit(std::uint32_t zone, bool heat, bool cool) {
+    std::lock_guard<std::mutex> lock(this->batchMutex);
+    if (this->header == nullptr || (this->batched == this->batchSize && !this->Publish())) {
+        return false;
+    }
+    ActuatorCommandRecord &command = this->batch[this->batched++];
+    command.sequence = 0;
+    command.timestamp = Now();
+    command.zone = zone;
+    command.heat = heat ? 1 : 0;
+    command.cool = cool ? 1 : 0;
+    command.reserved = 0;
+    if (this->batched == this->batchSize) {
+        // Kept in the batch if the ring is full, and published by the next Submit or Flush.
+        this->Publish();
+    }
+    return true;
+}
+
+bool ActuatorChannel::Flush() {
+    std::lock_guard<std::mutex> lock(this->batchMutex);
+    return this->header == nullptr || this->Publish();
+}
+
+bool ActuatorChannel::Publish() {
+    if (this->batched == 0) {
+        return true;
+    }
+    std::atomic_ref<std::uint64_t> enqueue(this->header->enqueuePosition);
+    std::uint64_t mask = this->header->capacity - 1;
+    std::uint64_t count = this->batched;
+    std::uint64_t position = enqueue.load(std::memory_order_relaxed);
+    for (;;) {
+        // The consumer frees cells in order, so the batch fits once its last cell is free for this lap.
+        std::uint64_t last = position + count - 1;
+        std::uint64_t turn = std::atomic_ref<std::uint64_t>(this->cells[last & mask].turn)
+                .load(std::memory_order_acquire);
+        if (turn == last) {
+            if (enqueue.compare_exchange_weak(position, position + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else {
+            std::uint64_t current = enqueue.load(std::memory_order_relaxed);
+            if (turn < last && current == position) {
+                return false;
+            }
+            position = current;
+        }
+    }
+
+    for (std::uint64_t i = 0; i < count; ++i) {
+        ActuatorChannelCell &cell = this->cells[(position + i) & mask];
+        cell.command = this->batch[i];
+        cell.command.sequence = position + i + 1;
+        std::atomic_ref<std::uint64_t>(cell.turn).store(position + i + 1, std::memory_order_release);
+    }
+    this->lastSequence = position + count;
+    this->batched = 0;
+    return true;
+}
+
+std::uint64_t ActuatorChannel::PublishedSequence() {
+    std::lock_guard<std::mutex> lock(this->batchMutex);
+    return this->lastSequence;
+}
+
+std::uint64_t ActuatorChannel::Acknowledged() const {
+    if (this->header == nullptr) {
+        return 0;
+    }
+    return std::atomic_ref<std::uint64_t>(this->header->acknowledged).load(std::memory_order_acquire);
+}
+
+bool ActuatorChannel::WaitForAcknowledgement(std::uint64_t sequence, std::chrono::nanoseconds timeout) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    while (this->Acknowledged() < sequence) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+ActuatorChannelConsumer::ActuatorChannelConsumer():
+        header(nullptr),
+        cells(nullptr),
+        mappedSize(0) {
+}
+
+ActuatorChannelConsumer::~ActuatorChannelConsumer() {
+    this->Close();
+}
+
+bool ActuatorChannelConsumer::Create(const std::string &channelName, std::size_t capacity) {
+    this->Close();
+    std::size_t ringSize = std::bit_ceil(capacity > 0 ? capacity : 1);
+    std::size_t size = sizeof(ActuatorChannelHeader) + ringSize * sizeof(ActuatorChannelCell);
+
+    // A fresh object, so producers of a previous daemon never see a half initialized ring.
+    ::shm_unlink(channelName.c_str());
+    int object = ::shm_open(channelName.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (object < 0) {
+        return false;
+    }
+    if (::ftruncate(object, static_cast<off_t>(size)) != 0) {
+        ::close(object);
+        ::shm_unlink(channelName.c_str());
+        return false;
+    }
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, object, 0);
+    ::close(object);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(channelName.c_str());
+        return false;
+    }
+
+    // The new object reads as zeros. Cell i is free for position i, and the header is written last, so producers
+    // only accept the object once it is complete.
+    ActuatorChannelHeader *mappedHeader = static_cast<ActuatorChannelHeader *>(mapping);
+    ActuatorChannelCell *mappedCells = CellsOf(mappedHeader);
+    for (std::size_t i = 0; i < ringSize; ++i) {
+        mappedCells[i].turn = i;
+    }
+    mappedHeader->version = ActuatorChannelHeader::currentVersion;
+    mappedHeader->cellSize = sizeof(ActuatorChannelCell);
+    mappedHeader->capacity = ringSize;
+    std::atomic_ref<std::uint32_t>(mappedHeader->magic)
+            .store(ActuatorChannelHeader::expectedMagic, std::memory_order_release);
+
+    this->header = mappedHeader;
+    this->cells = mappedCells;
+    this->mappedSize = size;
+    this->name = channelName;
+    return true;
+}
+
+void ActuatorChannelConsumer::Close() {
+    if (this->header != nullptr) {
+        ::munmap(this->header, this->mappedSize);
+        ::shm_unlink(this->name.c_str());
+        this->header = nullptr;
+        this->cells = nullptr;
+        this->mappedSize = 0;
+        this->name.clear();
+    }
+}
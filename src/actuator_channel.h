@@ -0,0 +1,196 @@
+#ifndef _ACTUATOR_CHANNEL_H_
+#define _ACTUATOR_CHANNEL_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Actuator command sent through an actuator channel: the full heating and cooling state of one zone.
+ */
+struct ActuatorCommandRecord {
+    std::uint64_t sequence;  // Position of the command in the channel, starting at 1. Acknowledged in order.
+    std::int64_t timestamp;  // steady_clock time of the submission, in nanoseconds.
+    std::uint32_t zone;      // Zone whose actuators the command sets.
+    std::uint8_t heat;       // 1 to heat, 0 to stop heating.
+    std::uint8_t cool;       // 1 to cool, 0 to stop cooling.
+    std::uint16_t reserved;  // Zero.
+};
+
+static_assert(sizeof(ActuatorCommandRecord) == 24, "actuator commands are 24 bytes in shared memory");
+
+/**
+ * @brief Cell of the shared ring. The turn tells producers and the consumer whether the cell is free or holds a
+ *        published command, as in EventRing.
+ */
+struct ActuatorChannelCell {
+    std::uint64_t turn;
+    ActuatorCommandRecord command;
+};
+
+/**
+ * @brief Header at the start of the shared memory object, followed by capacity cells. Each position lives on its
+ *        own cache line, so producers and the consumer do not invalidate each other's lines.
+ */
+struct ActuatorChannelHeader {
+    static constexpr std::uint32_t expectedMagic = 0x4e484341; // "ACHN"
+    static constexpr std::uint16_t currentVersion = 1;
+
+    std::uint32_t magic;                          // expectedMagic.
+    std::uint16_t version;                        // currentVersion.
+    std::uint16_t cellSize;                       // sizeof(ActuatorChannelCell).
+    std::uint64_t capacity;                       // Number of cells, a power of two.
+    alignas(64) std::uint64_t enqueuePosition;    // Next position claimed by a producer.
+    alignas(64) std::uint64_t dequeuePosition;    // Next position read by the consumer.
+    alignas(64) std::uint64_t acknowledged;       // Sequence of the last command applied by the consumer.
+};
+
+static_assert(sizeof(ActuatorChannelHeader) == 256, "the actuator channel header is four cache lines");
+
+/**
+ * @brief Producer side of an actuator channel: a lock-free ring of actuator commands in a POSIX shared memory
+ *        object, drained by an ActuatorChannelConsumer in another process.
+ *
+ *        Commands are collected in a local batch and published together: the cells of a whole batch are claimed
+ *        with one compare-and-swap, so the cost of contention on the shared positions is paid once per batch.
+ *        Each command gets a sequence number, and the consumer acknowledges the last sequence it applied, so the
+ *        producer can tell when a decision reached the relays. Several threads and processes may produce at once.
+ */
+class ActuatorChannel {
+public:
+    static constexpr std::size_t maxBatch = 64;
+
+private:
+    ActuatorChannelHeader *header; // Start of the mapping, null while closed.
+    ActuatorChannelCell *cells;    // Cells following the header.
+    std::size_t mappedSize;        // Size of the mapping, in bytes.
+    std::size_t batchSize;         // Commands collected before they are published.
+    std::mutex batchMutex;         // Protects the batch.
+    std::array<ActuatorCommandRecord, maxBatch> batch; // Commands waiting to be published.
+    std::size_t batched;           // Number of commands in the batch.
+    std::uint64_t lastSequence;    // Sequence of the last command published.
+
+    // Publishes the batch. Called with the batch lock held.
+    bool Publish();
+
+public:
+    ActuatorChannel();
+    ~ActuatorChannel();
+
+    ActuatorChannel(const ActuatorChannel &) = delete;
+    ActuatorChannel &operator=(const ActuatorChannel &) = delete;
+
+    /**
+     * @brief Maps a channel created by the consumer.
+     * @param name Name of the shared memory object, starting with a slash.
+     * @param batch Commands collected before they are published, between 1 (publish at once) and maxBatch.
+     * @ret   True if the channel is open, false if the object does not exist or is not an actuator channel.
+     */
+    bool Open(const std::string &name, std::size_t batch = 1);
+
+    /**
+     * @brief Publishes the pending commands and unmaps the channel.
+     */
+    void Close();
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    /**
+     * @brief Adds a command to the batch, and publishes the batch once it is full. Sequence numbers are assigned
+     *        when the batch is published.
+     * @ret   True if the command was accepted, false if the batch is full and the ring has no room for it.
+     */
+    bool Submit(std::uint32_t zone, bool heat, bool cool);
+
+    /**
+     * @brief Publishes the pending commands.
+     * @ret   True if the batch is empty, false if the ring has no room for it. The batch is kept to retry later.
+     */
+    bool Flush();
+
+    /**
+     * @brief Returns the sequence of the last command published by this producer, 0 if none was.
+     */
+    std::uint64_t PublishedSequence();
+
+    /**
+     * @brief Returns the sequence of the last command applied by the consumer, from any producer.
+     */
+    std::uint64_t Acknowledged() const;
+
+    /**
+     * @brief Waits until the consumer acknowledged the given sequence.
+     * @ret   True if it was acknowledged within the timeout, false otherwise.
+     */
+    bool WaitForAcknowledgement(std::uint64_t sequence, std::chrono::nanoseconds timeout);
+};
+
+/**
+ * @brief Consumer side of an actuator channel, run by the daemon that drives the relays, or by a test process
+ *        standing in for it. Only one consumer may drain a channel.
+ */
+class ActuatorChannelConsumer {
+private:
+    ActuatorChannelHeader *header; // Start of the mapping, null while closed.
+    ActuatorChannelCell *cells;    // Cells following the header.
+    std::size_t mappedSize;        // Size of the mapping, in bytes.
+    std::string name;              // Name of the shared memory object, unlinked on Close.
+
+public:
+    ActuatorChannelConsumer();
+    ~ActuatorChannelConsumer();
+
+    ActuatorChannelConsumer(const ActuatorChannelConsumer &) = delete;
+    ActuatorChannelConsumer &operator=(const ActuatorChannelConsumer &) = delete;
+
+    /**
+     * @brief Creates the shared memory object of a channel, replacing any previous one of the same name.
+     * @param channelName Name of the shared memory object, starting with a slash.
+     * @param capacity Minimum number of commands in flight, rounded up to a power of two.
+     * @ret   True if the channel was created, false otherwise.
+     */
+    bool Create(const std::string &channelName, std::size_t capacity);
+
+    /**
+     * @brief Unmaps and removes the shared memory object.
+     */
+    void Close();
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    /**
+     * @brief Visits the published commands in sequence order, then acknowledges the last one visited.
+     * @param visit Callable invoked with each command, which should apply it to the relays.
+     * @param max Maximum number of commands visited.
+     * @ret   The number of commands visited.
+     */
+    template <typename Visitor>
+    std::size_t Drain(Visitor &&visit, std::size_t max = SIZE_MAX) {
+        std::atomic_ref<std::uint64_t> dequeue(this->header->dequeuePosition);
+        std::uint64_t position = dequeue.load(std::memory_order_relaxed);
+        std::uint64_t mask = this->header->capacity - 1;
+        std::size_t count = 0;
+        for (; count < max; ++count, ++position) {
+            ActuatorChannelCell &cell = this->cells[position & mask];
+            std::atomic_ref<std::uint64_t> turn(cell.turn);
+            if (turn.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            ActuatorCommandRecord command = cell.command;
+            // Hand the cell back to the producers before acting, so a slow relay does not hold up the ring.
+            turn.store(position + this->header->capacity, std::memory_order_release);
+            dequeue.store(position + 1, std::memory_order_relaxed);
+            visit(command);
+        }
+        if (count > 0) {
+            std::atomic_ref<std::uint64_t>(this->header->acknowledged).store(position, std::memory_order_release);
+        }
+        return count;
+    }
+};
+
+#endif //_ACTUATOR_CHANNEL_H_
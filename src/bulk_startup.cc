@@ -0,0 +1,45 @@
+#include "bulk_startup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+std::chrono::nanoseconds BulkStartupReport::Percentile(double fraction) const {
+    if (this->latencies.empty()) {
+        return std::chrono::nanoseconds(0);
+    }
+    std::vector<std::chrono::nanoseconds> sorted(this->latencies);
+    std::size_t rank = static_cast<std::size_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+BulkStartupReport RunBulkStartup(std::size_t zones, const std::function<void (std::size_t)> &start,
+                                 unsigned maxInFlight) {
+    BulkStartupReport report;
+    report.latencies.resize(zones);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    // Each worker starts one zone at a time, so the number of workers bounds the zones in flight. Zones are
+    // handed out through a shared counter, so a slow sensor only holds back its own worker.
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        for (std::size_t i = next.fetch_add(1); i < zones; i = next.fetch_add(1)) {
+            std::chrono::steady_clock::time_point zoneBegin = std::chrono::steady_clock::now();
+            start(i);
+            report.latencies[i] = std::chrono::steady_clock::now() - zoneBegin;
+        }
+    };
+    std::size_t workers = std::min<std::size_t>(std::max(1u, maxInFlight), zones);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    report.total = std::chrono::steady_clock::now() - begin;
+    return report;
+}
@@ -0,0 +1,68 @@
+#ifndef _BULK_STARTUP_H_
+#define _BULK_STARTUP_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <vector>
+
+/**
+ * @brief Timings of a bulk startup.
+ */
+struct BulkStartupReport {
+    std::chrono::nanoseconds total{0};               // From the call to the last zone becoming active.
+    std::vector<std::chrono::nanoseconds> latencies; // Startup time of each zone, in the order the zones were given.
+
+    /**
+     * @brief Returns the startup latency below which the given fraction of the zones became active.
+     * @param fraction Between 0 and 1.
+     */
+    std::chrono::nanoseconds Percentile(double fraction) const;
+
+    /**
+     * @brief Returns the startup latency of the slowest zone.
+     */
+    std::chrono::nanoseconds Max() const { return this->Percentile(1.0); }
+};
+
+/**
+ * @brief Runs the startup of each zone, with at most maxInFlight zones starting at the same time, and times them.
+ *        Returns once every zone has started.
+ * @param zones Number of zones.
+ * @param start Starts the zone of the given index. Called from up to maxInFlight threads at once.
+ * @param maxInFlight Maximum number of zones starting at the same time, at least 1.
+ */
+BulkStartupReport RunBulkStartup(std::size_t zones, const std::function<void (std::size_t)> &start,
+                                 unsigned maxInFlight);
+
+/**
+ * @brief Zone started by StartThermostats: a thermostat created with deferredStart and its thermometer.
+ */
+template <typename Stat, typename Meter>
+struct StartupZone {
+    Stat *thermostat;
+    const Meter *thermometer;
+};
+
+/**
+ * @brief Starts many thermostats concurrently instead of one after the other. For each zone, the thermometer
+ *        thresholds are configured, the callback registered and the first temperature read, and the zone becomes
+ *        active as soon as its reading arrives. At most maxInFlight zones wait on their thermometer at the same time,
+ *        bounding the load on the sensor bus.
+ * @param zones The zones to start. The thermostats must have been created with deferredStart, and must outlive the
+ *              returned future.
+ * @param maxInFlight Maximum number of zones starting at the same time, at least 1.
+ * @ret   Future of the startup timings, ready once every zone is active.
+ */
+template <typename Stat, typename Meter>
+std::future<BulkStartupReport> StartThermostats(std::vector<StartupZone<Stat, Meter>> zones, unsigned maxInFlight) {
+    return std::async(std::launch::async, [zones = std::move(zones), maxInFlight]() {
+        return RunBulkStartup(zones.size(), [&zones](std::size_t i) {
+            zones[i].thermostat->ConfigureThermometer();
+            zones[i].thermostat->Activate(zones[i].thermometer->GetTemperature());
+        }, maxInFlight);
+    });
+}
+
+#endif //_BULK_STARTUP_H_
@@ -0,0 +1,64 @@
+#include "caching_temperature_controller.h"
+
+CachingTemperatureController::CachingTemperatureController(TemperatureController &controller):
+        backend(controller),
+        heatKnown(false),
+        coolKnown(false),
+        heating(false),
+        cooling(false),
+        requestedWrites(0),
+        issuedWrites(0) {
+}
+
+void CachingTemperatureController::Heat(bool on) {
+    ++this->requestedWrites;
+    if (!this->heatKnown || this->heating != on) {
+        this->backend.Heat(on);
+        ++this->issuedWrites;
+        this->heating = on;
+        this->heatKnown = true;
+    }
+}
+
+void CachingTemperatureController::Cool(bool on) {
+    ++this->requestedWrites;
+    if (!this->coolKnown || this->cooling != on) {
+        this->backend.Cool(on);
+        ++this->issuedWrites;
+        this->cooling = on;
+        this->coolKnown = true;
+    }
+}
+
+void CachingTemperatureController::SetMode(bool heat, bool cool) {
+    bool heatChanged = !this->heatKnown || this->heating != heat;
+    bool coolChanged = !this->coolKnown || this->cooling != cool;
+
+    if (this->backend.SupportsModeTransition()) {
+        this->requestedWrites += 2;
+        if (heatChanged || coolChanged) {
+            this->backend.SetMode(heat, cool);
+            ++this->issuedWrites;
+            this->heating = heat;
+            this->cooling = cool;
+            this->heatKnown = true;
+            this->coolKnown = true;
+        }
+    }
+    else {
+        // Same order as the default SetMode, each write being dropped if it would not change the state.
+        if (cool) {
+            this->Cool(true);
+            this->Heat(heat);
+        }
+        else {
+            this->Heat(heat);
+            this->Cool(false);
+        }
+    }
+}
+
+void CachingTemperatureController::Invalidate() {
+    this->heatKnown = false;
+    this->coolKnown = false;
+}
@@ -0,0 +1,57 @@
+#ifndef _CACHING_TEMPERATURE_CONTROLLER_H_
+#define _CACHING_TEMPERATURE_CONTROLLER_H_
+
+#include <cstdint>
+#include "temperature_controller.h"
+
+/**
+ * @brief Temperature controller that sits in front of another controller and remembers the last state written to
+ *        it. Writes that would not change the state are dropped, and when the backend supports mode transitions
+ *        a change of heating and cooling state is sent as a single SetMode write.
+ */
+class CachingTemperatureController: public TemperatureController {
+private:
+    TemperatureController &backend; // Controller that receives the writes that change its state.
+    bool heatKnown;      // Whether the heating state of the backend is known.
+    bool coolKnown;      // Whether the cooling state of the backend is known.
+    bool heating;        // Last heating state written to the backend.
+    bool cooling;        // Last cooling state written to the backend.
+    std::uint64_t requestedWrites; // Number of Heat and Cool writes requested, a SetMode counting as two.
+    std::uint64_t issuedWrites;    // Number of writes sent to the backend, a SetMode counting as one.
+
+public:
+    /**
+     * @brief Creates a cache in front of the given controller. The state of the controller is unknown until the
+     *        first write, so the first write of each kind is always forwarded.
+     * @param controller The controller that receives the writes.
+     */
+    explicit CachingTemperatureController(TemperatureController &controller);
+
+    void Heat(bool on) override;
+    void Cool(bool on) override;
+    void SetMode(bool heat, bool cool) override;
+    bool SupportsModeTransition() const override { return true; }
+
+    /**
+     * @brief Forgets the cached state, so the next writes are forwarded. Use when the backend state may have been
+     *        changed by someone else, e.g. after a relay bus reset.
+     */
+    void Invalidate();
+
+    /**
+     * @brief Returns the number of Heat and Cool writes requested from this controller, a SetMode counting as two.
+     */
+    std::uint64_t RequestedWrites() const { return this->requestedWrites; }
+
+    /**
+     * @brief Returns the number of writes sent to the backend.
+     */
+    std::uint64_t IssuedWrites() const { return this->issuedWrites; }
+
+    /**
+     * @brief Returns the number of writes that were not sent to the backend.
+     */
+    std::uint64_t SavedWrites() const { return this->requestedWrites - this->issuedWrites; }
+};
+
+#endif //_CACHING_TEMPERATURE_CONTROLLER_H_
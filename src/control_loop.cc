@@ -0,0 +1,167 @@
+#include "control_loop.h"
+
+#include <bit>
+
+namespace {
+
+std::int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+ControlLoop::ControlLoop(std::size_t capacity, std::size_t batch, LoopWakeup *wakeup):
+        queue(capacity),
+        batchSize(batch > 0 ? batch : 1),
+        running(false),
+        sleeping(false),
+        wakeups(0),
+        group(wakeup),
+        posted(0),
+        processed(0),
+        dropped(0),
+        maxQueueDepth(0),
+        maxLatency(0) {
+    for (std::atomic<std::uint64_t> &bucket : this->latencyHistogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+ControlLoop::~ControlLoop() {
+    this->Stop();
+}
+
+void ControlLoop::Start() {
+    if (!this->running.exchange(true)) {
+        this->controlThread = std::thread(&ControlLoop::Run, this);
+    }
+}
+
+void ControlLoop::Stop() {
+    if (this->running.exchange(false)) {
+        this->wakeups.fetch_add(1);
+        this->wakeups.notify_one();
+        this->controlThread.join();
+    }
+}
+
+bool ControlLoop::Post(Handler handler, void *context, bool value) {
+    if (!this->queue.TryPush(Event{handler, context, NowNanoseconds(), value})) {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    this->posted.fetch_add(1, std::memory_order_relaxed);
+
+    std::size_t depth = this->queue.Size();
+    std::size_t maxDepth = this->maxQueueDepth.load(std::memory_order_relaxed);
+    while (depth > maxDepth && !this->maxQueueDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {
+    }
+
+    this->WakeControlThread();
+    return true;
+}
+
+void ControlLoop::Send(Handler handler, void *context, bool value) {
+    while (!this->queue.TryPush(Event{handler, context, NowNanoseconds(), value})) {
+        std::this_thread::yield();
+    }
+    this->posted.fetch_add(1, std::memory_order_relaxed);
+    this->WakeControlThread();
+}
+
+void ControlLoop::WakeControlThread() {
+    if (this->group != nullptr) {
+        this->group->Notify();
+        return;
+    }
+    // Pairs with the fence in Run: either the control thread sees the new event, or we see it is going to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->sleeping.load(std::memory_order_relaxed)) {
+        this->wakeups.fetch_add(1);
+        this->wakeups.notify_one();
+    }
+}
+
+void ControlLoop::WaitIdle() const {
+    std::uint64_t target = this->posted.load(std::memory_order_acquire);
+    while (this->processed.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+void ControlLoop::Run() {
+    while (this->running.load(std::memory_order_relaxed)) {
+        if (this->Drain() > 0) {
+            continue;
+        }
+
+        // Nothing to do, sleep until a producer signals a new event or the loop is stopped.
+        std::uint32_t ticket = this->wakeups.load();
+        this->sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->queue.Size() == 0 && this->running.load(std::memory_order_relaxed)) {
+            this->wakeups.wait(ticket);
+        }
+        this->sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // Handle what is left, so no accepted event is lost.
+    while (this->Drain() > 0) {
+    }
+}
+
+std::size_t ControlLoop::Drain() {
+    std::size_t count = 0;
+    Event event;
+    while (count < this->batchSize && this->queue.TryPop(event)) {
+        event.handler(event.context, event.value);
+
+        std::int64_t latency = NowNanoseconds() - event.postedAt;
+        if (latency < 1) {
+            latency = 1;
+        }
+        std::size_t bucket = std::bit_width(static_cast<std::uint64_t>(latency)) - 1;
+        this->latencyHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        if (latency > this->maxLatency.load(std::memory_order_relaxed)) {
+            this->maxLatency.store(latency, std::memory_order_relaxed);
+        }
+        ++count;
+    }
+    if (count > 0) {
+        this->processed.fetch_add(count, std::memory_order_release);
+    }
+    return count;
+}
+
+std::chrono::nanoseconds ControlLoop::LatencyPercentile(double fraction) const {
+    std::uint64_t total = 0;
+    for (const std::atomic<std::uint64_t> &bucket : this->latencyHistogram) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    std::uint64_t rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < latencyBuckets; ++i) {
+        seen += this->latencyHistogram[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            return std::chrono::nanoseconds(std::int64_t(1) << (i + 1 < 63 ? i + 1 : 62));
+        }
+    }
+    return std::chrono::nanoseconds(this->maxLatency.load(std::memory_order_relaxed));
+}
+
+ControlLoopStats ControlLoop::GetStats() const {
+    ControlLoopStats stats;
+    stats.posted = this->posted.load(std::memory_order_relaxed);
+    stats.processed = this->processed.load(std::memory_order_relaxed);
+    stats.dropped = this->dropped.load(std::memory_order_relaxed);
+    stats.maxQueueDepth = this->maxQueueDepth.load(std::memory_order_relaxed);
+    stats.p50Latency = this->LatencyPercentile(0.50);
+    stats.p99Latency = this->LatencyPercentile(0.99);
+    stats.maxLatency = std::chrono::nanoseconds(this->maxLatency.load(std::memory_order_relaxed));
+    return stats;
+}
@@ -0,0 +1,189 @@
+#ifndef _CONTROL_LOOP_H_
+#define _CONTROL_LOOP_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "event_ring.h"
+
+/**
+ * @brief Snapshot of the counters kept by a ControlLoop.
+ */
+struct ControlLoopStats {
+    std::uint64_t posted;               // Events accepted into the queue.
+    std::uint64_t processed;            // Events handled by the control thread.
+    std::uint64_t dropped;              // Events rejected because the queue was full.
+    std::size_t maxQueueDepth;          // Largest number of queued events observed after a post.
+    std::chrono::nanoseconds p50Latency; // Median time between post and handling (power of two resolution).
+    std::chrono::nanoseconds p99Latency; // 99th percentile time between post and handling (power of two resolution).
+    std::chrono::nanoseconds maxLatency; // Largest time between post and handling.
+};
+
+/**
+ * @brief Wakes the threads draining a group of control loops, e.g. the workers of a ShardedExecutor. A post into any
+ *        loop of the group wakes one sleeping thread.
+ */
+class LoopWakeup {
+private:
+    std::atomic<std::uint32_t> sleepers; // Threads between PrepareWait and the end of Wait or CancelWait.
+    std::atomic<std::uint32_t> signals;  // Bumped to wake the sleeping threads.
+
+public:
+    LoopWakeup(): sleepers(0), signals(0) {}
+
+    LoopWakeup(const LoopWakeup &) = delete;
+    LoopWakeup &operator=(const LoopWakeup &) = delete;
+
+    /**
+     * @brief First step of going to sleep. Check for work after this call, then call Wait or CancelWait.
+     * @ret   The ticket to pass to Wait.
+     */
+    std::uint32_t PrepareWait() {
+        std::uint32_t ticket = this->signals.load();
+        this->sleepers.fetch_add(1);
+        // Pairs with the fence in Notify: either the sleeper sees the new event, or the poster sees the sleeper.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return ticket;
+    }
+
+    // Sleeps until a notification made after PrepareWait.
+    void Wait(std::uint32_t ticket) {
+        this->signals.wait(ticket);
+        this->sleepers.fetch_sub(1);
+    }
+
+    // Gives up going to sleep, work was found.
+    void CancelWait() { this->sleepers.fetch_sub(1); }
+
+    /**
+     * @brief Wakes one sleeping thread, if any. Only a fence and a load when no thread sleeps.
+     */
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->sleepers.load(std::memory_order_relaxed) > 0) {
+            this->signals.fetch_add(1);
+            this->signals.notify_one();
+        }
+    }
+
+    // Wakes every sleeping thread.
+    void NotifyAll() {
+        this->signals.fetch_add(1);
+        this->signals.notify_all();
+    }
+};
+
+/**
+ * @brief ControlLoop moves thermostat work off the thermometer threads. Thermometer callbacks only post a small
+ *        event into a bounded lock-free queue; a dedicated control thread drains the queue in batches and runs the
+ *        handlers, which issue the actuator commands.
+ */
+class ControlLoop {
+public:
+    // Function run on the control thread for an event, with the context and value given when posting.
+    using Handler = void (*)(void *context, bool value);
+
+private:
+    struct Event {
+        Handler handler;
+        void *context;
+        std::int64_t postedAt; // steady_clock time of the post, in nanoseconds.
+        bool value;
+    };
+
+    static constexpr std::size_t latencyBuckets = 64;
+
+    EventRing<Event> queue;    // Events waiting for the control thread.
+    std::size_t batchSize;     // Maximum number of events handled between two checks for stop requests.
+    std::thread controlThread; // Thread draining the queue, running while the loop is started.
+    std::atomic<bool> running;  // Cleared to ask the control thread to stop.
+    std::atomic<bool> sleeping; // Set while the control thread waits for new events.
+    std::atomic<std::uint32_t> wakeups; // Bumped to wake the control thread.
+    LoopWakeup *group;          // Threads draining the loop instead of the control thread, null if none.
+
+    std::atomic<std::uint64_t> posted;
+    std::atomic<std::uint64_t> processed;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<std::size_t> maxQueueDepth;
+    std::atomic<std::int64_t> maxLatency;
+    // Latency histogram, bucket i counts latencies in [2^i, 2^(i+1)) nanoseconds. Only written by the control thread.
+    std::array<std::atomic<std::uint64_t>, latencyBuckets> latencyHistogram;
+
+    // Body of the control thread.
+    void Run();
+
+    // Wakes the control thread, or a thread of the group, if it is waiting for events.
+    void WakeControlThread();
+
+    // Handles up to batchSize queued events, returns the number handled.
+    std::size_t Drain();
+
+    // Returns the upper bound of the bucket holding the given fraction of the recorded latencies.
+    std::chrono::nanoseconds LatencyPercentile(double fraction) const;
+
+public:
+    /**
+     * @brief Creates a stopped control loop.
+     * @param capacity Minimum number of events the queue can hold before events are dropped.
+     * @param batch Maximum number of events handled in one pass over the queue.
+     * @param wakeup If not null, the loop is drained by the threads of this group through RunBatch instead of by
+     *               its own control thread, and posts wake them. Must outlive the loop.
+     */
+    explicit ControlLoop(std::size_t capacity = 1024, std::size_t batch = 64, LoopWakeup *wakeup = nullptr);
+
+    // Stops the control thread, handling the events still queued.
+    ~ControlLoop();
+
+    ControlLoop(const ControlLoop &) = delete;
+    ControlLoop &operator=(const ControlLoop &) = delete;
+
+    /**
+     * @brief Starts the control thread. Events posted before the loop is started are kept in the queue.
+     */
+    void Start();
+
+    /**
+     * @brief Stops the control thread after handling all queued events.
+     */
+    void Stop();
+
+    /**
+     * @brief Queues an event for the control thread. Never blocks, so it is safe to call from thermometer threads.
+     * @ret   True if the event was queued, false if the queue was full and the event was dropped.
+     */
+    bool Post(Handler handler, void *context, bool value);
+
+    /**
+     * @brief Queues an event for the control thread, waiting for room in the queue if it is full. Meant for
+     *        configuration changes that must not be lost.
+     */
+    void Send(Handler handler, void *context, bool value);
+
+    /**
+     * @brief Handles up to one batch of queued events on the calling thread, for loops drained by a group of threads
+     *        instead of their own control thread. Calls must not overlap, and the loop must not be started.
+     * @ret   The number of events handled.
+     */
+    std::size_t RunBatch() { return this->Drain(); }
+
+    /**
+     * @brief Returns the number of queued events. Only approximate while events are posted or handled.
+     */
+    std::size_t Pending() const { return this->queue.Size(); }
+
+    /**
+     * @brief Waits until every event posted so far has been handled. The loop must be started, or drained by the
+     *        threads of its group.
+     */
+    void WaitIdle() const;
+
+    /**
+     * @brief Returns the loop counters. Lock-free, may be called from any thread while the loop runs.
+     */
+    ControlLoopStats GetStats() const;
+};
+
+#endif //_CONTROL_LOOP_H_
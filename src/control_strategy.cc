@@ -0,0 +1,47 @@
+#include "control_strategy.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Converts a gain per degree to the fixed-point output per tenth of a degree.
+std::int64_t FixedGain(double gainPerDegree) {
+    return std::llround(std::max(gainPerDegree, 0.0) * static_cast<double>(PiStrategy::one) / Temperature::scale);
+}
+
+} // namespace
+
+PiStrategy::PiStrategy(const PiSettings &settings):
+        setpoint(settings.setpoint),
+        proportional(FixedGain(settings.proportionalGain)),
+        integralGain(FixedGain(settings.integralGain)),
+        cycle(std::max<std::uint32_t>(settings.cycleSamples, 1)),
+        integral(0),
+        onSamples(0),
+        phase(0) {
+}
+
+bool MakeControlStrategy(const StrategySettings &settings, std::unique_ptr<ControlStrategy> &strategy) {
+    switch (settings.kind) {
+    case StrategyKind::OnOff:
+        if (settings.onOff.low >= settings.onOff.high) {
+            return false;
+        }
+        strategy = std::make_unique<PolymorphicStrategy<OnOffStrategy>>(settings.onOff);
+        return true;
+    case StrategyKind::Deadband:
+        if (settings.deadband.band <= Temperature()) {
+            return false;
+        }
+        strategy = std::make_unique<PolymorphicStrategy<DeadbandStrategy>>(settings.deadband);
+        return true;
+    case StrategyKind::Pi:
+        if (settings.pi.proportionalGain < 0.0 || settings.pi.integralGain < 0.0 || settings.pi.cycleSamples == 0) {
+            return false;
+        }
+        strategy = std::make_unique<PolymorphicStrategy<PiStrategy>>(PiStrategy(settings.pi));
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,242 @@
+#ifndef _CONTROL_STRATEGY_H_
+#define _CONTROL_STRATEGY_H_
+
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include "temperature.h"
+
+/**
+ * @brief Heating and cooling state decided by a control strategy.
+ */
+struct ActuatorState {
+    bool heat; // True if the room should be heated.
+    bool cool; // True if the room should be cooled.
+
+    bool operator==(const ActuatorState &) const = default;
+};
+
+/**
+ * @brief Thermometer thresholds a control strategy wants armed, so that the thermometer notifies it when its
+ *        decision may change.
+ */
+struct ArmedThresholds {
+    Temperature high;
+    Temperature low;
+
+    bool operator==(const ArmedThresholds &) const = default;
+};
+
+/**
+ * @brief Requirements on a control strategy. A strategy decides the actuator state from a reading, or from a
+ *        threshold notification, given the current state. Thresholds returns the thresholds to arm in a state.
+ *        Concrete strategies satisfy it with plain member functions so that decisions are inlined, ControlStrategy
+ *        through virtual calls.
+ */
+template <typename T>
+concept ControlPolicy = requires(T &strategy, const T &constStrategy, Temperature temperature, bool isHigh,
+                                 ActuatorState state) {
+    { strategy.Decide(temperature, state) } -> std::same_as<ActuatorState>;
+    { strategy.OnCrossing(isHigh, state) } -> std::same_as<ActuatorState>;
+    { constStrategy.Thresholds(state) } -> std::same_as<ArmedThresholds>;
+};
+
+/**
+ * @brief On/off control, as ControlMode::Threshold: heat below the low threshold and cool above the high threshold,
+ *        until the opposite threshold is crossed. The thresholds stay armed. Requires low < high.
+ */
+struct OnOffStrategy {
+    Temperature high; // Maximum desired temperature.
+    Temperature low;  // Minimum desired temperature.
+
+    // Between the thresholds the current state is kept, decide from the idle state to switch off there instead.
+    ActuatorState Decide(Temperature temperature, ActuatorState state) const {
+        return ActuatorState{temperature < this->low || (state.heat && temperature <= this->high),
+                             temperature > this->high || (state.cool && temperature >= this->low)};
+    }
+    ActuatorState OnCrossing(bool isHigh, ActuatorState) const { return ActuatorState{!isHigh, isHigh}; }
+    ArmedThresholds Thresholds(ActuatorState) const { return ArmedThresholds{this->high, this->low}; }
+};
+
+/**
+ * @brief Hysteresis around a setpoint, as ControlMode::Deadband: heat or cool once the temperature leaves
+ *        [setpoint - band, setpoint + band], and stop at the setpoint. Only the threshold that can end the current
+ *        state is armed. Requires band > 0.
+ */
+struct DeadbandStrategy {
+    Temperature setpoint; // Desired temperature.
+    Temperature band;     // How far the temperature may drift from the setpoint before heating or cooling.
+
+    ActuatorState Decide(Temperature temperature, ActuatorState state) const {
+        // Keep heating or cooling until the setpoint is reached, otherwise only act outside of the band.
+        bool heat = temperature < this->setpoint - this->band || (state.heat && temperature <= this->setpoint);
+        bool cool = !heat &&
+                    (temperature > this->setpoint + this->band || (state.cool && temperature >= this->setpoint));
+        return ActuatorState{heat, cool};
+    }
+
+    // While heating only the setpoint (high threshold) is armed, while cooling only the setpoint (low threshold).
+    ActuatorState OnCrossing(bool isHigh, ActuatorState state) const {
+        return ActuatorState{!isHigh && !state.cool, isHigh && !state.heat};
+    }
+
+    ArmedThresholds Thresholds(ActuatorState state) const {
+        // Unused thresholds are pushed to the limits, the thermometer clamps them to its measurable range.
+        if (state.heat) {
+            return ArmedThresholds{this->setpoint, Temperature::Lowest()};
+        }
+        if (state.cool) {
+            return ArmedThresholds{Temperature::Highest(), this->setpoint};
+        }
+        return ArmedThresholds{this->setpoint + this->band, this->setpoint - this->band};
+    }
+};
+
+/**
+ * @brief Settings of a PiStrategy.
+ */
+struct PiSettings {
+    Temperature setpoint = Temperature::FromCelsius(21);
+    double proportionalGain = 0.5;   // Duty cycle per degree below the setpoint, e.g. 0.5 is full power at 2 °C.
+    double integralGain = 0.05;      // Duty cycle accumulated per degree below the setpoint and duty cycle.
+    std::uint32_t cycleSamples = 30; // Readings per duty cycle. The actuators switch at most twice per cycle.
+};
+
+/**
+ * @brief Fixed-point proportional-integral control with a duty-cycle output. Each Decide is one sample: at the start
+ *        of a duty cycle the output is computed from the error, then the room is heated (positive output) or cooled
+ *        (negative output) for that fraction of the cycle's samples. The integral is clamped to full power to avoid
+ *        windup. Decisions only use integer arithmetic. Call Decide at a fixed rate, e.g. through
+ *        BasicStrategyThermostat::Poll; threshold notifications do not change the decision and no threshold is
+ *        armed.
+ */
+class PiStrategy {
+public:
+    static constexpr std::int64_t one = 1 << 16; // Full power, in the fixed-point format of the output.
+
+private:
+    Temperature setpoint;
+    std::int64_t proportional; // Output per tenth of a degree of error.
+    std::int64_t integralGain; // Output accumulated per tenth of a degree of error, once per cycle.
+    std::uint32_t cycle;       // Samples per duty cycle.
+    std::int64_t integral;     // Accumulated output, within [-one, one].
+    std::int32_t onSamples;    // Samples of the current cycle to heat (positive) or cool (negative).
+    std::uint32_t phase;       // Sample of the current cycle.
+
+public:
+    /**
+     * @brief Creates a PI strategy. Negative gains are taken as 0 and a cycle of 0 samples as 1.
+     */
+    explicit PiStrategy(const PiSettings &settings);
+
+    ActuatorState Decide(Temperature temperature, ActuatorState) {
+        if (this->phase == 0) {
+            std::int64_t error = (this->setpoint - temperature).DeciCelsius();
+            this->integral = Clamp(this->integral + this->integralGain * error);
+            std::int64_t output = Clamp(this->proportional * error + this->integral);
+            std::int64_t scaled = output * this->cycle;
+            this->onSamples = static_cast<std::int32_t>((scaled + (scaled < 0 ? -one / 2 : one / 2)) / one);
+        }
+        std::int32_t activeSamples = this->onSamples < 0 ? -this->onSamples : this->onSamples;
+        bool active = this->phase < static_cast<std::uint32_t>(activeSamples);
+        this->phase = this->phase + 1 == this->cycle ? 0 : this->phase + 1;
+        return ActuatorState{active && this->onSamples > 0, active && this->onSamples < 0};
+    }
+
+    ActuatorState OnCrossing(bool, ActuatorState state) const { return state; }
+
+    ArmedThresholds Thresholds(ActuatorState) const {
+        return ArmedThresholds{Temperature::Highest(), Temperature::Lowest()};
+    }
+
+    /**
+     * @brief Returns the output of the current duty cycle, from -1 (full cooling) to 1 (full heating).
+     */
+    double Duty() const { return static_cast<double>(this->onSamples) / static_cast<double>(this->cycle); }
+
+private:
+    static std::int64_t Clamp(std::int64_t value) { return value < -one ? -one : (value > one ? one : value); }
+};
+
+/**
+ * @brief Control strategy interface, for strategies chosen at runtime, e.g. from a configuration file.
+ */
+class ControlStrategy {
+public:
+    virtual ~ControlStrategy() = default;
+
+    virtual ActuatorState Decide(Temperature temperature, ActuatorState state) = 0;
+    virtual ActuatorState OnCrossing(bool isHigh, ActuatorState state) = 0;
+    virtual ArmedThresholds Thresholds(ActuatorState state) const = 0;
+};
+
+/**
+ * @brief Any concrete strategy behind the ControlStrategy interface.
+ */
+template <ControlPolicy Policy>
+class PolymorphicStrategy final: public ControlStrategy {
+private:
+    Policy policy;
+
+public:
+    explicit PolymorphicStrategy(const Policy &strategy): policy(strategy) {}
+
+    ActuatorState Decide(Temperature temperature, ActuatorState state) override {
+        return this->policy.Decide(temperature, state);
+    }
+    ActuatorState OnCrossing(bool isHigh, ActuatorState state) override {
+        return this->policy.OnCrossing(isHigh, state);
+    }
+    ArmedThresholds Thresholds(ActuatorState state) const override { return this->policy.Thresholds(state); }
+
+    Policy &Get() { return this->policy; }
+};
+
+/**
+ * @brief Control strategies that MakeControlStrategy can create.
+ */
+enum class StrategyKind {
+    OnOff,
+    Deadband,
+    Pi,
+};
+
+/**
+ * @brief Configuration of a control strategy chosen at runtime. Only the fields of the chosen kind are used.
+ */
+struct StrategySettings {
+    StrategyKind kind = StrategyKind::OnOff;
+    OnOffStrategy onOff{Temperature::FromCelsius(40), Temperature::FromCelsius(10)};
+    DeadbandStrategy deadband{Temperature::FromCelsius(21), Temperature::FromCelsius(1)};
+    PiSettings pi;
+};
+
+/**
+ * @brief Creates the strategy described by a configuration.
+ * @param settings The configuration.
+ * @param strategy Receives the new strategy.
+ * @ret   True if the settings are valid (on/off: low < high, deadband: band > 0, PI: non-negative gains and at
+ *        least one sample per cycle), false otherwise.
+ */
+bool MakeControlStrategy(const StrategySettings &settings, std::unique_ptr<ControlStrategy> &strategy);
+
+/**
+ * @brief Switches heating and cooling to the given state, switching on before switching off so the room is never
+ *        left without the requested action. Controllers with a SetMode(heat, cool) function get a single call.
+ */
+template <typename Controller>
+void WriteActuators(Controller &controller, ActuatorState state) {
+    if constexpr (requires { controller.SetMode(state.heat, state.cool); }) {
+        controller.SetMode(state.heat, state.cool);
+    }
+    else if (state.cool) {
+        controller.Cool(true);
+        controller.Heat(state.heat);
+    }
+    else {
+        controller.Heat(state.heat);
+        controller.Cool(false);
+    }
+}
+
+#endif //_CONTROL_STRATEGY_H_
@@ -0,0 +1,118 @@
+#ifndef _EVENT_RING_H_
+#define _EVENT_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief Bounded lock-free ring buffer. Any number of threads may push and pop concurrently; each cell carries a
+ *        sequence number that tells producers and consumers whether it is free or holds a published value, so
+ *        neither side ever blocks. Pushing into a full ring fails instead of waiting.
+ */
+template <typename T>
+class EventRing {
+    static_assert(std::is_trivially_copyable_v<T>, "EventRing stores plain event records");
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells; // Storage, with a power of two number of cells.
+    std::size_t mask;              // Number of cells minus one, used to wrap positions.
+    alignas(64) std::atomic<std::size_t> enqueuePosition; // Next position to be written by a producer.
+    alignas(64) std::atomic<std::size_t> dequeuePosition; // Next position to be read by a consumer.
+
+public:
+    /**
+     * @brief Creates a ring able to hold at least the given number of events.
+     * @param capacity Minimum capacity, rounded up to a power of two.
+     */
+    explicit EventRing(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        this->cells = std::make_unique<Cell[]>(size);
+        this->mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        this->enqueuePosition.store(0, std::memory_order_relaxed);
+        this->dequeuePosition.store(0, std::memory_order_relaxed);
+    }
+
+    EventRing(const EventRing &) = delete;
+    EventRing &operator=(const EventRing &) = delete;
+
+    /**
+     * @brief Appends an event to the ring.
+     * @ret   True if the event was stored, false if the ring is full.
+     */
+    bool TryPush(const T &value) {
+        std::size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = this->cells[position & this->mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest event from the ring.
+     * @ret   True if an event was copied into value, false if the ring is empty.
+     */
+    bool TryPop(T &value) {
+        std::size_t position = this->dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = this->cells[position & this->mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (this->dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + this->mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = this->dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of events in the ring. Only approximate while other threads are pushing or popping.
+     */
+    std::size_t Size() const {
+        std::size_t dequeued = this->dequeuePosition.load(std::memory_order_relaxed);
+        std::size_t enqueued = this->enqueuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /**
+     * @brief Returns the maximum number of events the ring can hold.
+     */
+    std::size_t Capacity() const { return this->mask + 1; }
+};
+
+#endif //_EVENT_RING_H_
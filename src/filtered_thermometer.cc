@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cmath>
+#include "filtered_thermometer.h"
+
+namespace {
+
+// Variances are given in °C² and kept in tenths of a degree squared.
+constexpr double varianceScale = Temperature::scale * Temperature::scale;
+
+} // namespace
+
+NoiseFilter::NoiseFilter(const FilterSettings &settings):
+        smoothing(settings.smoothing),
+        alpha(std::clamp(settings.alpha, 0.001, 1.0)),
+        window(std::clamp<std::size_t>(settings.window, 1, maxWindow)),
+        processNoise(std::max(settings.processNoise, 0.0) * varianceScale),
+        measurementNoise(std::max(settings.measurementNoise, 0.0001) * varianceScale),
+        ring(),
+        next(0),
+        count(0),
+        sum(0),
+        estimate(0.0),
+        variance(0.0),
+        primed(false) {
+}
+
+Temperature NoiseFilter::Update(Temperature reading) {
+    const double tenths = reading.DeciCelsius();
+    if (!this->primed) {
+        this->estimate = tenths;
+        this->variance = this->measurementNoise;
+        this->primed = true;
+    }
+
+    switch (this->smoothing) {
+    case Smoothing::Exponential:
+        this->estimate += this->alpha * (tenths - this->estimate);
+        break;
+    case Smoothing::MovingAverage:
+        if (this->count == this->window) {
+            this->sum -= this->ring[this->next].DeciCelsius();
+        }
+        else {
+            ++this->count;
+        }
+        this->ring[this->next] = reading;
+        this->sum += reading.DeciCelsius();
+        this->next = this->next + 1 == this->window ? 0 : this->next + 1;
+        this->estimate = static_cast<double>(this->sum) / static_cast<double>(this->count);
+        break;
+    case Smoothing::Kalman: {
+        // Predict: the temperature is assumed constant, its uncertainty grows. Correct with the reading.
+        this->variance += this->processNoise;
+        double gain = this->variance / (this->variance + this->measurementNoise);
+        this->estimate += gain * (tenths - this->estimate);
+        this->variance *= 1.0 - gain;
+        break;
+    }
+    case Smoothing::None:
+    default:
+        this->estimate = tenths;
+        break;
+    }
+    return this->Value();
+}
+
+Temperature NoiseFilter::Value() const {
+    return Temperature::FromDeciCelsius(static_cast<std::int32_t>(std::lround(this->estimate)));
+}
@@ -0,0 +1,252 @@
+#ifndef _FILTERED_THERMOMETER_H_
+#define _FILTERED_THERMOMETER_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "thermometer.h"
+#include "threshold_monitor.h"
+
+/**
+ * @brief How a FilteredThermometer smooths the readings of its sensor.
+ */
+enum class Smoothing {
+    None,          // Readings are used as read.
+    Exponential,   // Exponential moving average.
+    MovingAverage, // Mean of the last readings, kept in a ring buffer.
+    Kalman,        // Scalar Kalman filter with a constant temperature model.
+};
+
+/**
+ * @brief Settings of a FilteredThermometer.
+ */
+struct FilterSettings {
+    Smoothing smoothing = Smoothing::Exponential;
+    double alpha = 0.25;                   // Exponential: weight of a new reading, in (0, 1].
+    std::size_t window = 8;                // MovingAverage: number of readings averaged, 1 to maxWindow.
+    double processNoise = 0.0025;          // Kalman: variance of the temperature change between readings, in °C².
+    double measurementNoise = 0.25;        // Kalman: variance of a reading, in °C².
+    std::chrono::milliseconds debounce{0}; // Notifications closer than this are merged, 0 forwards all of them.
+};
+
+/**
+ * @brief Smoothing of a stream of readings, as configured by FilterSettings. State is kept in place, so updates
+ *        never allocate. Not thread-safe.
+ */
+class NoiseFilter {
+public:
+    static constexpr std::size_t maxWindow = 16;
+
+private:
+    Smoothing smoothing;
+    double alpha;                            // Exponential: weight of a new reading.
+    std::size_t window;                      // MovingAverage: number of readings averaged.
+    double processNoise;                     // Kalman: in tenths of a degree squared.
+    double measurementNoise;                 // Kalman: in tenths of a degree squared.
+    std::array<Temperature, maxWindow> ring; // MovingAverage: last readings.
+    std::size_t next;                        // MovingAverage: position of the next reading in the ring.
+    std::size_t count;                       // MovingAverage: number of readings in the ring.
+    std::int64_t sum;                        // MovingAverage: sum of the readings in the ring, in tenths.
+    double estimate;                         // Filtered temperature, in tenths of a degree.
+    double variance;                         // Kalman: variance of the estimate, in tenths squared.
+    bool primed;                             // Whether a reading was received.
+
+public:
+    /**
+     * @brief Creates a filter. Out of range settings are clamped to the nearest valid value.
+     */
+    explicit NoiseFilter(const FilterSettings &settings);
+
+    /**
+     * @brief Adds a reading and returns the filtered temperature.
+     */
+    Temperature Update(Temperature reading);
+
+    /**
+     * @brief Returns the filtered temperature, rounded to a tenth of a degree, or 0 °C before the first reading.
+     */
+    Temperature Value() const;
+};
+
+/**
+ * @brief Thermometer between a noisy sensor and a thermostat. Each call to Poll reads the sensor and smooths the
+ *        reading, and the threshold contract of the Thermometer interface applies to the smoothed temperature.
+ *        Call Poll at the sampling rate of the sensor, e.g. from a PollScheduler. The sensor's thresholds and
+ *        callback are not used.
+ *
+ *        With a debounce window, a notification is forwarded at once and opens the window. Later notifications in
+ *        the window are merged: when the window closes, the last of them is forwarded if it differs from the one
+ *        forwarded before, and opens a new window. Windows are closed by Poll and by the next notification.
+ *        Notifications caused by setting new thresholds are always forwarded at once.
+ *
+ *        Callbacks run with the thermometer lock held. Nothing allocates after construction.
+ * @tparam Clock Source of time for the debounce windows.
+ */
+template <typename Clock = std::chrono::steady_clock>
+class BasicFilteredThermometer: public Thermometer {
+private:
+    Thermometer &sensor;                   // Sensor read by Poll.
+    NoiseFilter filter;                    // Smoothing of the sensor readings.
+    typename Clock::duration debounce;     // Length of the debounce windows.
+    ThresholdMonitor monitor;              // Keeps the thresholds and notifies crossings of the smoothed value.
+    TemperatureCallback callback;          // Callback registered by the thermometer user.
+    typename Clock::time_point windowEnd;  // End of the current debounce window.
+    bool windowOpen;                       // Whether a debounce window is open.
+    bool hasPending;                       // Whether a notification was merged in the current window.
+    bool pending;                          // Last notification merged in the current window.
+    bool lastForwarded;                    // Last notification forwarded.
+    bool configuring;                      // Set while new thresholds are being set.
+    std::uint64_t notifications;           // Crossings of the smoothed temperature.
+    std::uint64_t forwarded;               // Notifications forwarded to the callback.
+    mutable std::recursive_mutex mutex;    // Protects the members above. Recursive, so that the callback can set
+                                           // the thresholds.
+
+    // Called by the monitor on each crossing of the smoothed temperature.
+    void OnCrossing(bool isHigh);
+
+    // Forwards a notification and opens a debounce window.
+    void Forward(bool isHigh, typename Clock::time_point now);
+
+    // Closes the debounce window if it has ended, forwarding the notification merged in it if any.
+    void CloseWindow(typename Clock::time_point now);
+
+public:
+    /**
+     * @brief Creates a filtered thermometer, reading the sensor once.
+     * @param noisySensor The sensor. Must outlive the filtered thermometer.
+     * @param settings Smoothing and debounce settings.
+     * @param minMeasurable Minimum measurable temperature, lower thresholds are clamped to it.
+     * @param maxMeasurable Maximum measurable temperature, higher thresholds are clamped to it.
+     */
+    BasicFilteredThermometer(Thermometer &noisySensor, const FilterSettings &settings,
+                             Temperature minMeasurable = Temperature::FromCelsius(-40),
+                             Temperature maxMeasurable = Temperature::FromCelsius(125));
+
+    // The monitor callback points to this object, so it must not be copied or moved.
+    BasicFilteredThermometer(const BasicFilteredThermometer &) = delete;
+    BasicFilteredThermometer &operator=(const BasicFilteredThermometer &) = delete;
+
+    // Returns the smoothed temperature, without reading the sensor.
+    Temperature GetTemperature() const override;
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override;
+    void RegisterCallback(TemperatureCallback cb) override;
+
+    /**
+     * @brief Reads the sensor, smooths the reading and checks the thresholds, and closes an ended debounce window.
+     */
+    void Poll();
+
+    /**
+     * @brief Returns the number of threshold crossings of the smoothed temperature.
+     */
+    std::uint64_t Notifications() const;
+
+    /**
+     * @brief Returns the number of notifications forwarded to the callback, after debouncing.
+     */
+    std::uint64_t Forwarded() const;
+};
+
+using FilteredThermometer = BasicFilteredThermometer<>;
+
+template <typename Clock>
+BasicFilteredThermometer<Clock>::BasicFilteredThermometer(Thermometer &noisySensor, const FilterSettings &settings,
+                                                          Temperature minMeasurable, Temperature maxMeasurable):
+        sensor(noisySensor),
+        filter(settings),
+        debounce(std::chrono::duration_cast<typename Clock::duration>(settings.debounce)),
+        monitor(minMeasurable, maxMeasurable),
+        windowEnd(),
+        windowOpen(false),
+        hasPending(false),
+        pending(false),
+        lastForwarded(false),
+        configuring(false),
+        notifications(0),
+        forwarded(0) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->monitor.Update(this->filter.Update(this->sensor.GetTemperature()));
+    this->monitor.RegisterCallback([this](bool isHigh) { this->OnCrossing(isHigh); });
+}
+
+template <typename Clock>
+Temperature BasicFilteredThermometer<Clock>::GetTemperature() const {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->filter.Value();
+}
+
+template <typename Clock>
+bool BasicFilteredThermometer<Clock>::SetTemperatureThresholds(Temperature high, Temperature low) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->configuring = true;
+    bool ret = this->monitor.SetThresholds(high, low);
+    this->configuring = false;
+    return ret;
+}
+
+template <typename Clock>
+void BasicFilteredThermometer<Clock>::RegisterCallback(TemperatureCallback cb) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->callback = std::move(cb);
+}
+
+template <typename Clock>
+void BasicFilteredThermometer<Clock>::Poll() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    Temperature smoothed = this->filter.Update(this->sensor.GetTemperature());
+    this->CloseWindow(Clock::now());
+    this->monitor.Update(smoothed);
+}
+
+template <typename Clock>
+std::uint64_t BasicFilteredThermometer<Clock>::Notifications() const {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->notifications;
+}
+
+template <typename Clock>
+std::uint64_t BasicFilteredThermometer<Clock>::Forwarded() const {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->forwarded;
+}
+
+template <typename Clock>
+void BasicFilteredThermometer<Clock>::OnCrossing(bool isHigh) {
+    ++this->notifications;
+    typename Clock::time_point now = Clock::now();
+    this->CloseWindow(now);
+    if (this->windowOpen && !this->configuring) {
+        this->hasPending = true;
+        this->pending = isHigh;
+        return;
+    }
+    this->Forward(isHigh, now);
+}
+
+template <typename Clock>
+void BasicFilteredThermometer<Clock>::Forward(bool isHigh, typename Clock::time_point now) {
+    ++this->forwarded;
+    this->lastForwarded = isHigh;
+    this->hasPending = false;
+    this->windowOpen = this->debounce > Clock::duration::zero();
+    this->windowEnd = now + this->debounce;
+    if (this->callback) {
+        this->callback(isHigh);
+    }
+}
+
+template <typename Clock>
+void BasicFilteredThermometer<Clock>::CloseWindow(typename Clock::time_point now) {
+    if (!this->windowOpen || now < this->windowEnd) {
+        return;
+    }
+    this->windowOpen = false;
+    if (this->hasPending && this->pending != this->lastForwarded) {
+        this->Forward(this->pending, now);
+    }
+    this->hasPending = false;
+}
+
+#endif //_FILTERED_THERMOMETER_H_
@@ -0,0 +1,129 @@
+#ifndef _INDEXED_HEAP_H_
+#define _INDEXED_HEAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Binary heap of item indices ordered by keys stored outside of the heap. The heap knows the position of
+ *        each item, so an item whose key changed is moved to its new place in O(log n) without searching for it.
+ *        Storage is allocated once for a fixed number of items, so no operation allocates.
+ * @tparam Compare Returns true if the first key must be closer to the top than the second, e.g. std::less for a
+ *         min-heap.
+ * @tparam Key Type of the keys.
+ */
+template <typename Compare, typename Key = int>
+class IndexedHeap {
+private:
+    static constexpr std::uint32_t absent = std::numeric_limits<std::uint32_t>::max();
+
+    const Key *keys;                   // Key of each item, owned by the user of the heap.
+    std::vector<std::uint32_t> heap;   // Items, in heap order.
+    std::vector<std::uint32_t> position; // Position of each item in the heap, absent if it is not in the heap.
+    [[no_unique_address]] Compare compare;
+
+    void Place(std::size_t at, std::uint32_t item) {
+        this->heap[at] = item;
+        this->position[item] = static_cast<std::uint32_t>(at);
+    }
+
+    void SiftUp(std::size_t at) {
+        std::uint32_t item = this->heap[at];
+        while (at > 0) {
+            std::size_t parent = (at - 1) / 2;
+            if (!this->compare(this->keys[item], this->keys[this->heap[parent]])) {
+                break;
+            }
+            this->Place(at, this->heap[parent]);
+            at = parent;
+        }
+        this->Place(at, item);
+    }
+
+    void SiftDown(std::size_t at) {
+        std::uint32_t item = this->heap[at];
+        std::size_t size = this->heap.size();
+        for (std::size_t child = 2 * at + 1; child < size; child = 2 * at + 1) {
+            if (child + 1 < size && this->compare(this->keys[this->heap[child + 1]], this->keys[this->heap[child]])) {
+                ++child;
+            }
+            if (!this->compare(this->keys[this->heap[child]], this->keys[item])) {
+                break;
+            }
+            this->Place(at, this->heap[child]);
+            at = child;
+        }
+        this->Place(at, item);
+    }
+
+public:
+    /**
+     * @brief Creates an empty heap for items 0 to capacity - 1.
+     * @param itemKeys Keys of the items, indexed by item. Must outlive the heap.
+     */
+    IndexedHeap(std::size_t capacity, const Key *itemKeys):
+            keys(itemKeys),
+            position(capacity, absent) {
+        this->heap.reserve(capacity);
+    }
+
+    std::size_t Size() const { return this->heap.size(); }
+    bool Empty() const { return this->heap.empty(); }
+    bool Contains(std::uint32_t item) const { return this->position[item] != absent; }
+
+    /**
+     * @brief Returns the item with the top key. The heap must not be empty.
+     */
+    std::uint32_t Top() const { return this->heap.front(); }
+
+    /**
+     * @brief Adds an item that is not in the heap.
+     */
+    void Push(std::uint32_t item) {
+        this->heap.push_back(item);
+        this->SiftUp(this->heap.size() - 1);
+    }
+
+    /**
+     * @brief Removes and returns the item with the top key. The heap must not be empty.
+     */
+    std::uint32_t Pop() {
+        std::uint32_t top = this->heap.front();
+        std::uint32_t last = this->heap.back();
+        this->heap.pop_back();
+        this->position[top] = absent;
+        if (!this->heap.empty()) {
+            this->Place(0, last);
+            this->SiftDown(0);
+        }
+        return top;
+    }
+
+    /**
+     * @brief Removes an item that is in the heap.
+     */
+    void Remove(std::uint32_t item) {
+        std::size_t at = this->position[item];
+        std::uint32_t last = this->heap.back();
+        this->heap.pop_back();
+        this->position[item] = absent;
+        if (last != item) {
+            this->Place(at, last);
+            this->Update(last);
+        }
+    }
+
+    /**
+     * @brief Moves an item of the heap to its place after its key changed.
+     */
+    void Update(std::uint32_t item) {
+        std::size_t at = this->position[item];
+        this->SiftUp(at);
+        this->SiftDown(this->position[item]);
+    }
+};
+
+#endif //_INDEXED_HEAP_H_
@@ -0,0 +1,105 @@
+#ifndef _INPLACE_FUNCTION_H_
+#define _INPLACE_FUNCTION_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, std::size_t Capacity = 4 * sizeof(void *)>
+class InplaceFunction;
+
+/**
+ * @brief Copyable callable wrapper like std::function, that stores the callable in a fixed size buffer inside the
+ *        wrapper and never allocates. Callables larger than Capacity, or more aligned than a pointer, are rejected
+ *        at compile time.
+ * @tparam Capacity Size of the buffer, in bytes.
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R (Args...), Capacity> {
+private:
+    // Type-specific operations on the stored callable, one static table per callable type.
+    struct Operations {
+        R (*invoke)(void *callable, Args &&...args);
+        void (*copy)(void *destination, const void *source);
+        void (*destroy)(void *callable);
+    };
+
+    template <typename Callable>
+    static constexpr Operations operationsFor{
+        [](void *callable, Args &&...args) -> R {
+            return (*static_cast<Callable *>(callable))(std::forward<Args>(args)...);
+        },
+        [](void *destination, const void *source) {
+            new (destination) Callable(*static_cast<const Callable *>(source));
+        },
+        [](void *callable) {
+            static_cast<Callable *>(callable)->~Callable();
+        },
+    };
+
+    alignas(void *) mutable unsigned char storage[Capacity];
+    const Operations *operations; // Operations of the stored callable, null when empty.
+
+    void Assign(const InplaceFunction &other) {
+        if (other.operations != nullptr) {
+            other.operations->copy(this->storage, other.storage);
+        }
+        this->operations = other.operations;
+    }
+
+    void Reset() {
+        if (this->operations != nullptr) {
+            this->operations->destroy(this->storage);
+            this->operations = nullptr;
+        }
+    }
+
+public:
+    InplaceFunction(): operations(nullptr) {}
+    InplaceFunction(std::nullptr_t): operations(nullptr) {}
+
+    /**
+     * @brief Stores a copy of the callable.
+     */
+    template <typename F, typename Callable = std::decay_t<F>>
+        requires (!std::is_same_v<Callable, InplaceFunction> && std::is_invocable_r_v<R, Callable &, Args...>)
+    InplaceFunction(F &&callable): operations(&operationsFor<Callable>) {
+        static_assert(sizeof(Callable) <= Capacity, "callable does not fit in the InplaceFunction capacity");
+        static_assert(alignof(Callable) <= alignof(void *), "callable is over-aligned for InplaceFunction");
+        static_assert(std::is_copy_constructible_v<Callable>, "InplaceFunction callables must be copyable");
+        new (this->storage) Callable(std::forward<F>(callable));
+    }
+
+    InplaceFunction(const InplaceFunction &other) {
+        this->Assign(other);
+    }
+
+    InplaceFunction &operator=(const InplaceFunction &other) {
+        if (this != &other) {
+            this->Reset();
+            this->Assign(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t) {
+        this->Reset();
+        return *this;
+    }
+
+    ~InplaceFunction() {
+        this->Reset();
+    }
+
+    explicit operator bool() const { return this->operations != nullptr; }
+
+    /**
+     * @brief Calls the stored callable. The function must not be empty.
+     */
+    R operator()(Args... args) const {
+        return this->operations->invoke(this->storage, std::forward<Args>(args)...);
+    }
+};
+
+#endif //_INPLACE_FUNCTION_H_
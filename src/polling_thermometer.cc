@@ -0,0 +1,117 @@
+#include "polling_thermometer.h"
+
+#include <algorithm>
+
+PollScheduler::PollScheduler(std::chrono::milliseconds tickDuration):
+        tick(tickDuration.count() > 0 ? tickDuration : std::chrono::milliseconds(1)),
+        running(false) {
+}
+
+PollScheduler::~PollScheduler() {
+    this->Stop();
+}
+
+void PollScheduler::Start() {
+    if (!this->running.exchange(true)) {
+        this->thread = std::thread(&PollScheduler::Run, this);
+    }
+}
+
+void PollScheduler::Stop() {
+    if (this->running.exchange(false)) {
+        this->thread.join();
+    }
+}
+
+void PollScheduler::Advance(std::uint64_t ticks) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->wheel.Advance(ticks);
+}
+
+std::uint64_t PollScheduler::TicksFor(std::chrono::milliseconds duration) const {
+    std::uint64_t ticks = static_cast<std::uint64_t>((duration + this->tick - std::chrono::milliseconds(1)) / this->tick);
+    return std::max<std::uint64_t>(ticks, 1);
+}
+
+std::size_t PollScheduler::ScheduledPolls() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->wheel.Size();
+}
+
+void PollScheduler::Run() {
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + this->tick;
+    while (this->running.load()) {
+        std::this_thread::sleep_until(next);
+        // Catch up on the ticks missed while the thread was not scheduled.
+        std::uint64_t ticks = 1 + static_cast<std::uint64_t>((std::chrono::steady_clock::now() - next) / this->tick);
+        next += ticks * this->tick;
+        this->Advance(ticks);
+    }
+}
+
+PollingThermometer::PollingThermometer(PollScheduler &pollScheduler, std::function<Temperature ()> readSensor,
+                                       PollingPolicy pollingPolicy, Temperature minMeasurable,
+                                       Temperature maxMeasurable):
+        scheduler(pollScheduler),
+        read(std::move(readSensor)),
+        policy(pollingPolicy),
+        monitor(minMeasurable, maxMeasurable),
+        interval(pollScheduler.TicksFor(pollingPolicy.minInterval)),
+        lastReading(),
+        polls(0) {
+    this->timer.callback = &PollingThermometer::Expire;
+    this->timer.context = this;
+
+    std::lock_guard<std::recursive_mutex> lock(this->scheduler.mutex);
+    Temperature reading = this->read();
+    this->lastReading.store(reading, std::memory_order_relaxed);
+    this->monitor.Update(reading);
+    this->scheduler.wheel.Schedule(this->timer, this->interval);
+}
+
+PollingThermometer::~PollingThermometer() {
+    std::lock_guard<std::recursive_mutex> lock(this->scheduler.mutex);
+    this->scheduler.wheel.Cancel(this->timer);
+}
+
+Temperature PollingThermometer::GetTemperature() const {
+    return this->read();
+}
+
+bool PollingThermometer::SetTemperatureThresholds(Temperature high, Temperature low) {
+    std::lock_guard<std::recursive_mutex> lock(this->scheduler.mutex);
+    return this->monitor.SetThresholds(high, low);
+}
+
+void PollingThermometer::RegisterCallback(TemperatureCallback callback) {
+    std::lock_guard<std::recursive_mutex> lock(this->scheduler.mutex);
+    this->monitor.RegisterCallback(std::move(callback));
+}
+
+std::chrono::milliseconds PollingThermometer::PollInterval() {
+    std::lock_guard<std::recursive_mutex> lock(this->scheduler.mutex);
+    return this->interval * this->scheduler.tick;
+}
+
+void PollingThermometer::Expire(void *context) {
+    static_cast<PollingThermometer *>(context)->Poll();
+}
+
+void PollingThermometer::Poll() {
+    Temperature reading = this->read();
+    Temperature previous = this->lastReading.exchange(reading, std::memory_order_relaxed);
+    this->polls.fetch_add(1, std::memory_order_relaxed);
+
+    // Poll faster while the temperature moves, back off while it is stable.
+    std::uint64_t minTicks = this->scheduler.TicksFor(this->policy.minInterval);
+    std::uint64_t maxTicks = std::max(minTicks, this->scheduler.TicksFor(this->policy.maxInterval));
+    if (reading != previous) {
+        this->interval = std::max(minTicks, this->interval / 2);
+    }
+    else {
+        this->interval = std::min(maxTicks, this->interval * 2);
+    }
+    // Schedule before notifying, so a callback destroying the thermometer leaves no timer behind.
+    this->scheduler.wheel.Schedule(this->timer, this->interval);
+    this->monitor.Update(reading);
+}
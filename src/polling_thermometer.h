@@ -0,0 +1,141 @@
+#ifndef _POLLING_THERMOMETER_H_
+#define _POLLING_THERMOMETER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "thermometer.h"
+#include "threshold_monitor.h"
+#include "timer_wheel.h"
+
+/**
+ * @brief Shared scheduler of sensor polls. One timer wheel serves every PollingThermometer, so the cost of a tick
+ *        does not depend on the number of sensors, only on the number of polls due.
+ *
+ *        The wheel is driven either by the scheduler thread (Start) or by calls to Advance, e.g. from a test or a
+ *        simulation. Polls, and the thermometer callbacks they trigger, run with the scheduler lock held.
+ */
+class PollScheduler {
+private:
+    TimerWheel wheel;                  // Poll timers of every sensor.
+    std::chrono::milliseconds tick;    // Duration of a wheel tick.
+    std::recursive_mutex mutex;        // Protects the wheel and the thermometers using it. Recursive, so that
+                                       // callbacks can set thresholds on the thermometer polling them.
+    std::thread thread;                // Thread ticking the wheel, running while the scheduler is started.
+    std::atomic<bool> running;         // Cleared to ask the thread to stop.
+
+    // Body of the scheduler thread.
+    void Run();
+
+    friend class PollingThermometer;
+
+public:
+    /**
+     * @brief Creates a stopped scheduler.
+     * @param tickDuration Resolution of the poll intervals.
+     */
+    explicit PollScheduler(std::chrono::milliseconds tickDuration = std::chrono::milliseconds(10));
+
+    // Stops the scheduler thread. Every thermometer using the scheduler must be destroyed first.
+    ~PollScheduler();
+
+    PollScheduler(const PollScheduler &) = delete;
+    PollScheduler &operator=(const PollScheduler &) = delete;
+
+    /**
+     * @brief Starts a thread ticking the wheel in real time.
+     */
+    void Start();
+
+    /**
+     * @brief Stops the scheduler thread.
+     */
+    void Stop();
+
+    /**
+     * @brief Ticks the wheel by hand, running the polls due in order.
+     */
+    void Advance(std::uint64_t ticks);
+
+    /**
+     * @brief Returns the number of ticks in the given duration, rounded up, at least 1.
+     */
+    std::uint64_t TicksFor(std::chrono::milliseconds duration) const;
+
+    std::chrono::milliseconds TickDuration() const { return this->tick; }
+
+    /**
+     * @brief Returns the number of sensors waiting for their next poll.
+     */
+    std::size_t ScheduledPolls();
+};
+
+/**
+ * @brief How a PollingThermometer adapts its poll interval. A reading that changed halves the interval, a
+ *        reading that did not doubles it, within the given bounds.
+ */
+struct PollingPolicy {
+    std::chrono::milliseconds minInterval{1000};  // Interval while the temperature changes.
+    std::chrono::milliseconds maxInterval{60000}; // Interval while the temperature is stable.
+};
+
+/**
+ * @brief Thermometer for sensors without a hardware threshold alarm. Reads the sensor on a schedule and notifies
+ *        threshold crossings as documented by the Thermometer interface.
+ */
+class PollingThermometer: public Thermometer {
+private:
+    PollScheduler &scheduler;       // Scheduler running the polls.
+    std::function<Temperature ()> read; // Reads the sensor.
+    PollingPolicy policy;           // Bounds of the poll interval.
+    ThresholdMonitor monitor;       // Keeps the thresholds and notifies crossings.
+    TimerNode timer;                // Next poll.
+    std::uint64_t interval;         // Current poll interval, in ticks.
+    std::atomic<Temperature> lastReading; // Last reading polled.
+    std::atomic<std::uint64_t> polls; // Number of polls made.
+
+    // Polls the sensor and schedules the next poll.
+    void Poll();
+
+    // Timer callback.
+    static void Expire(void *context);
+
+public:
+    /**
+     * @brief Creates a thermometer reading the sensor once, then polling it every minInterval to start with.
+     * @param pollScheduler The scheduler running the polls. Must outlive the thermometer.
+     * @param readSensor Reads the current temperature from the sensor.
+     * @param pollingPolicy Bounds of the poll interval.
+     * @param minMeasurable Minimum measurable temperature, lower thresholds are clamped to it.
+     * @param maxMeasurable Maximum measurable temperature, higher thresholds are clamped to it.
+     */
+    PollingThermometer(PollScheduler &pollScheduler, std::function<Temperature ()> readSensor,
+                       PollingPolicy pollingPolicy = {}, Temperature minMeasurable = Temperature::FromCelsius(-40),
+                       Temperature maxMeasurable = Temperature::FromCelsius(125));
+
+    // Stops polling.
+    ~PollingThermometer() override;
+
+    PollingThermometer(const PollingThermometer &) = delete;
+    PollingThermometer &operator=(const PollingThermometer &) = delete;
+
+    // Reads the sensor.
+    Temperature GetTemperature() const override;
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override;
+    void RegisterCallback(TemperatureCallback callback) override;
+
+    /**
+     * @brief Returns the current poll interval.
+     */
+    std::chrono::milliseconds PollInterval();
+
+    /**
+     * @brief Returns the number of times the sensor was polled.
+     */
+    std::uint64_t Polls() const { return this->polls.load(std::memory_order_relaxed); }
+};
+
+#endif //_POLLING_THERMOMETER_H_
@@ -0,0 +1,153 @@
+#include "room_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <thread>
+
+namespace {
+
+constexpr double secondsPerDay = 24.0 * 3600.0;
+constexpr double secondsPerYear = 365.0 * secondsPerDay;
+
+} // namespace
+
+double Climate::OutsideTemperature(std::chrono::duration<double> time) const {
+    double seconds = time.count();
+    // Coldest day at the start of the year, coldest hour at midnight.
+    double yearly = -std::cos(2.0 * std::numbers::pi * seconds / secondsPerYear);
+    double daily = -std::cos(2.0 * std::numbers::pi * seconds / secondsPerDay);
+    return this->meanTemperature + this->yearlyAmplitude * yearly + this->dailyAmplitude * daily;
+}
+
+SimulatedThermometer::SimulatedThermometer(Temperature initialReading):
+        monitor(minMeasurable, maxMeasurable),
+        reading(initialReading) {
+    this->monitor.Update(initialReading);
+}
+
+bool SimulatedThermometer::SetTemperatureThresholds(Temperature high, Temperature low) {
+    return this->monitor.SetThresholds(high, low);
+}
+
+void SimulatedThermometer::RegisterCallback(TemperatureCallback callback) {
+    this->monitor.RegisterCallback(std::move(callback));
+}
+
+void SimulatedThermometer::Sample(double temperature) {
+    this->reading = std::clamp(Temperature::FromCelsiusRounded(temperature), minMeasurable, maxMeasurable);
+    this->monitor.Update(this->reading);
+}
+
+SimulatedTemperatureController::SimulatedTemperatureController():
+        heating(false),
+        cooling(false),
+        transitions(0) {
+}
+
+void SimulatedTemperatureController::Heat(bool on) {
+    if (on != this->heating) {
+        this->heating = on;
+        ++this->transitions;
+    }
+}
+
+void SimulatedTemperatureController::Cool(bool on) {
+    if (on != this->cooling) {
+        this->cooling = on;
+        ++this->transitions;
+    }
+}
+
+SimulatedRoom::SimulatedRoom(const RoomParameters &roomParameters):
+        parameters(roomParameters),
+        temperature(roomParameters.initialTemperature),
+        cachedStep(0.0),
+        decay(1.0),
+        heatingTime(0.0),
+        coolingTime(0.0),
+        thermometer(Temperature::FromCelsiusRounded(roomParameters.initialTemperature)) {
+}
+
+void SimulatedRoom::Step(std::chrono::duration<double> step, double outsideTemperature) {
+    double seconds = step.count();
+    if (seconds != this->cachedStep) {
+        this->decay = std::exp(-this->parameters.conductance * seconds / this->parameters.thermalMass);
+        this->cachedStep = seconds;
+    }
+
+    double power = 0.0;
+    if (this->controller.IsHeating()) {
+        power += this->parameters.heaterPower;
+        this->heatingTime += seconds;
+    }
+    if (this->controller.IsCooling()) {
+        power -= this->parameters.coolerPower;
+        this->coolingTime += seconds;
+    }
+
+    // dT/dt = (power - conductance * (T - outside)) / thermalMass, solved exactly over the step.
+    double equilibrium = outsideTemperature + power / this->parameters.conductance;
+    this->temperature = equilibrium + (this->temperature - equilibrium) * this->decay;
+    this->thermometer.Sample(this->temperature);
+}
+
+RoomSimulation::RoomSimulation(const Climate &outside):
+        climate(outside),
+        now(0) {
+}
+
+SimulatedRoom &RoomSimulation::AddRoom(const RoomParameters &parameters) {
+    this->rooms.push_back(std::make_unique<SimulatedRoom>(parameters));
+    return *this->rooms.back();
+}
+
+void RoomSimulation::SetStepHook(std::function<void (std::size_t)> hook) {
+    this->stepHook = std::move(hook);
+}
+
+void RoomSimulation::Run(std::chrono::milliseconds duration, std::chrono::milliseconds step, unsigned threads) {
+    if (step.count() <= 0 || duration.count() <= 0) {
+        return;
+    }
+    std::int64_t steps = duration / step;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::size_t workers = std::min<std::size_t>(threads, this->rooms.size());
+
+    if (workers <= 1) {
+        this->RunRooms(0, this->rooms.size(), this->now, step, steps);
+    }
+    else {
+        // Contiguous slices, so each room is only touched by one thread.
+        std::vector<std::thread> pool;
+        std::size_t first = 0;
+        for (std::size_t w = 0; w < workers; ++w) {
+            std::size_t last = first + (this->rooms.size() - first) / (workers - w);
+            pool.emplace_back(&RoomSimulation::RunRooms, this, first, last, this->now, step, steps);
+            first = last;
+        }
+        for (std::thread &worker : pool) {
+            worker.join();
+        }
+    }
+    this->now += step * steps;
+}
+
+void RoomSimulation::RunRooms(std::size_t first, std::size_t last, std::chrono::milliseconds start,
+                              std::chrono::milliseconds step, std::int64_t steps) const {
+    const std::chrono::duration<double> stepSeconds = step;
+    std::chrono::milliseconds time = start;
+    for (std::int64_t i = 0; i < steps; ++i) {
+        double outside = this->climate.OutsideTemperature(time);
+        time += step;
+        SimulationClock::current = SimulationClock::time_point(time);
+        for (std::size_t room = first; room < last; ++room) {
+            this->rooms[room]->Step(stepSeconds, outside);
+            if (this->stepHook) {
+                this->stepHook(room);
+            }
+        }
+    }
+}
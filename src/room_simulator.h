@@ -0,0 +1,184 @@
+#ifndef _ROOM_SIMULATOR_H_
+#define _ROOM_SIMULATOR_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "temperature_controller.h"
+#include "thermometer.h"
+#include "threshold_monitor.h"
+
+/**
+ * @brief Physical parameters of a simulated room.
+ */
+struct RoomParameters {
+    double thermalMass = 5.0e6;       // Heat needed to raise the room temperature by 1 degree, in J/K.
+    double conductance = 150.0;       // Heat lost to the outside per degree of difference, in W/K.
+    double heaterPower = 4000.0;      // Heat added while heating, in W.
+    double coolerPower = 4000.0;      // Heat removed while cooling, in W.
+    double initialTemperature = 20.0; // Room temperature when the simulation starts, in degrees.
+};
+
+/**
+ * @brief Outside temperature model: a yearly and a daily sine wave around a mean.
+ */
+struct Climate {
+    double meanTemperature = 12.0;   // Yearly mean, in degrees.
+    double yearlyAmplitude = 10.0;   // Difference between the mean and the warmest day, in degrees.
+    double dailyAmplitude = 5.0;     // Difference between the daily mean and the warmest hour, in degrees.
+
+    /**
+     * @brief Returns the outside temperature at the given time since the start of the simulation, which starts on
+     *        the coldest day of the year at midnight.
+     */
+    double OutsideTemperature(std::chrono::duration<double> time) const;
+};
+
+/**
+ * @brief Clock reading the virtual time of the room being simulated on the current thread. Lets thermostats
+ *        driven by a RoomSimulation use the simulated time, e.g. BasicThermostat<..., SimulationClock>.
+ */
+struct SimulationClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<SimulationClock>;
+    static constexpr bool is_steady = true;
+
+    static inline thread_local time_point current{};
+
+    static time_point now() { return current; }
+};
+
+/**
+ * @brief Thermometer of a simulated room. Reports the room temperature rounded to tenths of a degree and notifies
+ *        threshold crossings as described by the Thermometer interface.
+ */
+class SimulatedThermometer: public Thermometer {
+private:
+    ThresholdMonitor monitor; // Keeps the thresholds and notifies crossings.
+    Temperature reading;      // Last temperature read.
+
+public:
+    // Lowest and highest temperatures the thermometer can report.
+    static constexpr Temperature minMeasurable = Temperature::FromCelsius(-40);
+    static constexpr Temperature maxMeasurable = Temperature::FromCelsius(125);
+
+    explicit SimulatedThermometer(Temperature initialReading);
+
+    Temperature GetTemperature() const override { return this->reading; }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override;
+    void RegisterCallback(TemperatureCallback callback) override;
+
+    /**
+     * @brief Records a new reading from the room model, notifying threshold crossings.
+     */
+    void Sample(double temperature);
+};
+
+/**
+ * @brief Temperature controller of a simulated room. Records the requested state and the number of times
+ *        heating and cooling were switched.
+ */
+class SimulatedTemperatureController: public TemperatureController {
+private:
+    bool heating;
+    bool cooling;
+    std::uint64_t transitions; // Number of times heating or cooling changed state.
+
+public:
+    SimulatedTemperatureController();
+
+    void Heat(bool on) override;
+    void Cool(bool on) override;
+
+    bool IsHeating() const { return this->heating; }
+    bool IsCooling() const { return this->cooling; }
+    std::uint64_t Transitions() const { return this->transitions; }
+};
+
+/**
+ * @brief Single room: one thermal mass exchanging heat with the outside, heated or cooled at constant power.
+ *        The model is integrated exactly for piecewise constant heating power and outside temperature, so large
+ *        steps remain stable.
+ */
+class SimulatedRoom {
+private:
+    RoomParameters parameters;
+    double temperature;          // Current room temperature.
+    double cachedStep;           // Step, in seconds, the decay factor was computed for.
+    double decay;                // Fraction of the distance to equilibrium left after one step.
+    double heatingTime;          // Seconds spent heating.
+    double coolingTime;          // Seconds spent cooling.
+    SimulatedThermometer thermometer;
+    SimulatedTemperatureController controller;
+
+public:
+    explicit SimulatedRoom(const RoomParameters &roomParameters);
+
+    SimulatedRoom(const SimulatedRoom &) = delete;
+    SimulatedRoom &operator=(const SimulatedRoom &) = delete;
+
+    /**
+     * @brief Advances the room by one step with the current controller state, then samples the thermometer.
+     * @param step Length of the step.
+     * @param outsideTemperature Outside temperature during the step.
+     */
+    void Step(std::chrono::duration<double> step, double outsideTemperature);
+
+    double Temperature() const { return this->temperature; }
+    SimulatedThermometer &GetThermometer() { return this->thermometer; }
+    SimulatedTemperatureController &GetController() { return this->controller; }
+    std::chrono::duration<double> HeatingTime() const { return std::chrono::duration<double>(this->heatingTime); }
+    std::chrono::duration<double> CoolingTime() const { return std::chrono::duration<double>(this->coolingTime); }
+};
+
+/**
+ * @brief Simulates many independent rooms on a virtual clock. Rooms are split across worker threads, each thread
+ *        advancing its rooms without synchronizing with the others, so a simulation runs as fast as the CPUs allow.
+ *        Callbacks of a room's thermometer, and the thermostat decisions they trigger, run on the thread owning
+ *        the room.
+ */
+class RoomSimulation {
+private:
+    Climate climate;
+    std::vector<std::unique_ptr<SimulatedRoom>> rooms;
+    std::chrono::milliseconds now; // Virtual time elapsed since the start of the simulation.
+    std::function<void (std::size_t)> stepHook; // Called for each room after each of its steps.
+
+    // Advances rooms [first, last) through the given number of steps.
+    void RunRooms(std::size_t first, std::size_t last, std::chrono::milliseconds start,
+                  std::chrono::milliseconds step, std::int64_t steps) const;
+
+public:
+    explicit RoomSimulation(const Climate &outside = Climate());
+
+    /**
+     * @brief Adds a room to the simulation.
+     * @ret   The new room. It stays valid for the life of the simulation.
+     */
+    SimulatedRoom &AddRoom(const RoomParameters &parameters = RoomParameters());
+
+    std::size_t Size() const { return this->rooms.size(); }
+    SimulatedRoom &Room(std::size_t index) { return *this->rooms[index]; }
+    std::chrono::milliseconds Now() const { return this->now; }
+
+    /**
+     * @brief Registers a function called with the room index after every step of every room, on the thread
+     *        owning the room, while the SimulationClock shows the end of the step. Useful to poll thermostats.
+     */
+    void SetStepHook(std::function<void (std::size_t)> hook);
+
+    /**
+     * @brief Advances every room by the given duration.
+     * @param duration Virtual time to simulate.
+     * @param step Virtual time between two samples of each room.
+     * @param threads Number of worker threads, 0 to use one per CPU.
+     */
+    void Run(std::chrono::milliseconds duration, std::chrono::milliseconds step, unsigned threads = 0);
+};
+
+#endif //_ROOM_SIMULATOR_H_
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include "schedule.h"
+
+namespace {
+
+bool SameThresholds(const ScheduleEntry &a, const ScheduleEntry &b) {
+    return a.high == b.high && a.low == b.low;
+}
+
+// FNV-1a hash of the periods of a schedule.
+std::uint64_t Hash(const std::vector<ScheduleEntry> &periods) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](std::uint64_t value) {
+        hash ^= value;
+        hash *= 0x100000001b3ull;
+    };
+    for (const ScheduleEntry &period : periods) {
+        mix(period.minute);
+        mix(static_cast<std::uint32_t>(period.high.DeciCelsius()));
+        mix(static_cast<std::uint32_t>(period.low.DeciCelsius()));
+    }
+    return hash;
+}
+
+} // namespace
+
+ScheduleTable::ScheduleTable():
+        offsets(1, 0) {}
+
+bool ScheduleTable::Add(std::vector<ScheduleEntry> periods, ScheduleId &schedule) {
+    if (periods.empty()) {
+        return false;
+    }
+    std::sort(periods.begin(), periods.end(), [](const ScheduleEntry &a, const ScheduleEntry &b) {
+        return a.minute < b.minute;
+    });
+    for (std::size_t i = 0; i < periods.size(); ++i) {
+        if (periods[i].minute >= minutesPerWeek || periods[i].high <= periods[i].low ||
+            (i > 0 && periods[i].minute == periods[i - 1].minute)) {
+            return false;
+        }
+    }
+
+    // Canonical form: a period with the same thresholds as the one before it is part of it, including the first
+    // period of the week when the last period of the previous week has the same thresholds.
+    periods.erase(std::unique(periods.begin(), periods.end(), SameThresholds), periods.end());
+    if (periods.size() > 1 && SameThresholds(periods.front(), periods.back())) {
+        periods.erase(periods.begin());
+    }
+
+    const std::uint64_t hash = Hash(periods);
+    auto [first, last] = this->index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (std::equal(periods.begin(), periods.end(), this->Begin(it->second), this->End(it->second))) {
+            schedule = it->second;
+            return true;
+        }
+    }
+    schedule = static_cast<ScheduleId>(this->Size());
+    this->entries.insert(this->entries.end(), periods.begin(), periods.end());
+    this->offsets.push_back(static_cast<std::uint32_t>(this->entries.size()));
+    this->index.emplace(hash, schedule);
+    return true;
+}
+
+const ScheduleEntry &ScheduleTable::Lookup(ScheduleId schedule, ScheduleTime time, ScheduleTime &next) const {
+    const ScheduleEntry *begin = this->Begin(schedule);
+    const ScheduleEntry *end = this->End(schedule);
+    const std::int64_t minute = ((time.count() % minutesPerWeek) + minutesPerWeek) % minutesPerWeek;
+    const std::int64_t weekStart = time.count() - minute;
+
+    // First period starting after the given time, in this week.
+    const ScheduleEntry *following = std::upper_bound(begin, end, minute, [](std::int64_t at, const ScheduleEntry &e) {
+        return at < e.minute;
+    });
+    if (end - begin == 1) {
+        next = ScheduleTime::max();
+    }
+    else if (following == end) {
+        next = ScheduleTime(weekStart + minutesPerWeek + begin->minute);
+    }
+    else {
+        next = ScheduleTime(weekStart + following->minute);
+    }
+    // Before the first period of the week, the last period of the previous week is still in effect.
+    return following == begin ? *(end - 1) : *(following - 1);
+}
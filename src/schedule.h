@@ -0,0 +1,242 @@
+#ifndef _SCHEDULE_H_
+#define _SCHEDULE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "indexed_heap.h"
+#include "temperature.h"
+#include "thermostat.h"
+
+/**
+ * @brief Time seen by the schedules: minutes since Monday 00:00 local time of the week of 1970-01-05. The minute of
+ *        the week is this time modulo minutesPerWeek.
+ */
+using ScheduleTime = std::chrono::minutes;
+
+constexpr std::int64_t minutesPerWeek = 7 * 24 * 60;
+
+/**
+ * @brief Converts a local wall clock time to a schedule time.
+ */
+constexpr ScheduleTime ToScheduleTime(std::chrono::local_seconds time) {
+    using namespace std::chrono;
+    return floor<minutes>(time - local_days(year(1970) / January / 5));
+}
+
+/**
+ * @brief Returns the minute of the week of a day and time of day.
+ * @param day Day of the week, 0 for Monday to 6 for Sunday.
+ */
+constexpr std::uint16_t WeekMinute(unsigned day, unsigned hour, unsigned minute = 0) {
+    return static_cast<std::uint16_t>((day * 24 + hour) * 60 + minute);
+}
+
+/**
+ * @brief Period of a weekly schedule: the thermostat thresholds from the given minute of the week until the start
+ *        of the next period.
+ */
+struct ScheduleEntry {
+    Temperature high;     // High temperature threshold during the period.
+    Temperature low;      // Low temperature threshold during the period.
+    std::uint16_t minute; // Minute of the week the period starts, see WeekMinute.
+
+    friend bool operator==(const ScheduleEntry &, const ScheduleEntry &) = default;
+};
+
+/**
+ * @brief Weekly schedules shared by many thermostats. Schedules are stored one after the other in a single array,
+ *        and adding a schedule identical to one already in the table returns the existing schedule, so a building
+ *        where most zones follow a handful of schedules only stores those. Schedules cannot be removed.
+ */
+class ScheduleTable {
+public:
+    using ScheduleId = std::uint32_t;
+
+private:
+    std::vector<ScheduleEntry> entries;                      // Periods of every schedule, each sorted by minute.
+    std::vector<std::uint32_t> offsets;                      // Schedule i is entries[offsets[i], offsets[i + 1]).
+    std::unordered_multimap<std::uint64_t, ScheduleId> index; // Schedules by hash of their periods.
+
+    const ScheduleEntry *Begin(ScheduleId schedule) const { return this->entries.data() + this->offsets[schedule]; }
+    const ScheduleEntry *End(ScheduleId schedule) const { return this->entries.data() + this->offsets[schedule + 1]; }
+
+public:
+    ScheduleTable();
+
+    /**
+     * @brief Adds a schedule, or finds the identical schedule already in the table. The periods may be given in any
+     *        order, and consecutive periods with the same thresholds are merged.
+     * @param periods The periods of the schedule: at least one, with distinct minutes below minutesPerWeek and
+     *                valid thresholds (low < high).
+     * @param schedule Set to the identifier of the schedule.
+     * @ret   True if the periods are valid, false otherwise.
+     */
+    bool Add(std::vector<ScheduleEntry> periods, ScheduleId &schedule);
+
+    /**
+     * @brief Returns the period in effect at the given time.
+     * @param schedule The schedule to look up.
+     * @param time The time to look up.
+     * @param next Set to the start of the following period, or ScheduleTime::max() if the schedule has a single
+     *             period.
+     */
+    const ScheduleEntry &Lookup(ScheduleId schedule, ScheduleTime time, ScheduleTime &next) const;
+
+    /**
+     * @brief Returns the number of distinct schedules.
+     */
+    std::size_t Size() const { return this->offsets.size() - 1; }
+
+    /**
+     * @brief Returns the number of periods stored for all schedules.
+     */
+    std::size_t Periods() const { return this->entries.size(); }
+};
+
+/**
+ * @brief Applies weekly schedules to thermostats. Each attached thermostat follows one schedule of a ScheduleTable,
+ *        and gets the thresholds of the current period set when it is attached and whenever a new period starts.
+ *        The next period change of every thermostat is kept in a min-heap, so Advance only visits the thermostats
+ *        whose period changed: its cost follows the number of changes, not the number of thermostats.
+ *
+ *        Thresholds set on a thermostat by other means last until its next period starts. Not thread-safe.
+ * @tparam Stat Type with the SetTemperatureThresholds member of BasicThermostat.
+ */
+template <typename Stat>
+class BasicThermostatScheduler {
+public:
+    using ZoneId = std::uint32_t;
+
+private:
+    // Thermostat attached to the scheduler.
+    struct Zone {
+        Stat *thermostat;                  // Null while the slot is free.
+        ScheduleTable::ScheduleId schedule;
+    };
+
+    const ScheduleTable &table;
+    std::vector<Zone> zones;
+    std::vector<ZoneId> freeZones;            // Slots of detached thermostats, reused first.
+    std::vector<std::int64_t> nextTransition; // Start of the next period of each zone, in minutes.
+    IndexedHeap<std::less<std::int64_t>, std::int64_t> transitions; // Zones with a next period, soonest first.
+    ScheduleTime now;
+
+    // Sets the thresholds of the current period of a zone and queues its next period.
+    void Apply(ZoneId zone) {
+        ScheduleTime next;
+        const ScheduleEntry &entry = this->table.Lookup(this->zones[zone].schedule, this->now, next);
+        this->zones[zone].thermostat->SetTemperatureThresholds(entry.high, entry.low);
+        if (next == ScheduleTime::max()) {
+            if (this->transitions.Contains(zone)) {
+                this->transitions.Remove(zone);
+            }
+            return;
+        }
+        this->nextTransition[zone] = next.count();
+        if (this->transitions.Contains(zone)) {
+            this->transitions.Update(zone);
+        }
+        else {
+            this->transitions.Push(zone);
+        }
+    }
+
+public:
+    /**
+     * @brief Creates a scheduler. Storage for every thermostat is allocated up front.
+     * @param schedules The schedules followed by the thermostats. Must outlive the scheduler.
+     * @param capacity Maximum number of thermostats attached at the same time.
+     * @param start The current time.
+     */
+    BasicThermostatScheduler(const ScheduleTable &schedules, std::size_t capacity, ScheduleTime start):
+            table(schedules),
+            nextTransition(capacity, 0),
+            transitions(capacity, this->nextTransition.data()),
+            now(start) {
+        this->zones.reserve(capacity);
+    }
+
+    // The heap points to the transition times, so the scheduler must stay in place.
+    BasicThermostatScheduler(const BasicThermostatScheduler &) = delete;
+    BasicThermostatScheduler &operator=(const BasicThermostatScheduler &) = delete;
+
+    /**
+     * @brief Attaches a thermostat to a schedule, and sets the thresholds of the current period.
+     * @param thermostat The thermostat. Must stay attached until it is detached or the scheduler is destroyed.
+     * @param schedule A schedule of the table.
+     * @param zone Set to the identifier of the thermostat in the scheduler.
+     * @ret   True if the thermostat was attached, false if the capacity is reached or the schedule is unknown.
+     */
+    bool Attach(Stat &thermostat, ScheduleTable::ScheduleId schedule, ZoneId &zone) {
+        if (schedule >= this->table.Size()) {
+            return false;
+        }
+        if (!this->freeZones.empty()) {
+            zone = this->freeZones.back();
+            this->freeZones.pop_back();
+        }
+        else if (this->zones.size() < this->nextTransition.size()) {
+            zone = static_cast<ZoneId>(this->zones.size());
+            this->zones.push_back(Zone{nullptr, 0});
+        }
+        else {
+            return false;
+        }
+        this->zones[zone] = Zone{&thermostat, schedule};
+        this->Apply(zone);
+        return true;
+    }
+
+    /**
+     * @brief Moves an attached thermostat to another schedule, and sets the thresholds of its current period.
+     * @ret   True if the schedule was changed, false if the schedule is unknown.
+     */
+    bool SetSchedule(ZoneId zone, ScheduleTable::ScheduleId schedule) {
+        if (schedule >= this->table.Size()) {
+            return false;
+        }
+        this->zones[zone].schedule = schedule;
+        this->Apply(zone);
+        return true;
+    }
+
+    /**
+     * @brief Detaches a thermostat. Its thresholds are left as they are.
+     */
+    void Detach(ZoneId zone) {
+        if (this->transitions.Contains(zone)) {
+            this->transitions.Remove(zone);
+        }
+        this->zones[zone].thermostat = nullptr;
+        this->freeZones.push_back(zone);
+    }
+
+    /**
+     * @brief Moves the time forward, and sets the thresholds of the thermostats whose period changed. A thermostat
+     *        whose period changed several times since the last call only gets the thresholds of the current one.
+     * @param time The current time, not earlier than the previous one.
+     * @ret   The number of thermostats whose thresholds were set.
+     */
+    std::size_t Advance(ScheduleTime time) {
+        this->now = time;
+        std::size_t changed = 0;
+        while (!this->transitions.Empty() && this->nextTransition[this->transitions.Top()] <= time.count()) {
+            this->Apply(this->transitions.Top());
+            ++changed;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Returns the number of attached thermostats.
+     */
+    std::size_t Size() const { return this->zones.size() - this->freeZones.size(); }
+};
+
+using ThermostatScheduler = BasicThermostatScheduler<Thermostat>;
+
+#endif //_SCHEDULE_H_
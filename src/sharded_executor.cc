@@ -0,0 +1,126 @@
+#include "sharded_executor.h"
+
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ShardedExecutor::ShardedExecutor(std::size_t shardCount, unsigned workers, std::size_t capacity, std::size_t batch,
+                                 bool pin):
+        workerCount(workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency())),
+        pinWorkers(pin),
+        running(false),
+        steals(0) {
+    shardCount = std::max<std::size_t>(shardCount, 1);
+    for (std::size_t i = 0; i < shardCount; ++i) {
+        this->shards.push_back(std::make_unique<Shard>(capacity, batch, this->wakeup));
+    }
+}
+
+ShardedExecutor::~ShardedExecutor() {
+    this->Stop();
+}
+
+void ShardedExecutor::Start() {
+    if (this->running.exchange(true)) {
+        return;
+    }
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < this->workerCount; ++i) {
+        this->workers.emplace_back(&ShardedExecutor::Run, this, i);
+#ifdef __linux__
+        if (this->pinWorkers) {
+            // Best effort: a worker that cannot be pinned, e.g. outside the process CPU set, still runs.
+            cpu_set_t cpu;
+            CPU_ZERO(&cpu);
+            CPU_SET(i % cpus, &cpu);
+            pthread_setaffinity_np(this->workers.back().native_handle(), sizeof(cpu), &cpu);
+        }
+#endif
+    }
+}
+
+void ShardedExecutor::Stop() {
+    if (!this->running.exchange(false)) {
+        return;
+    }
+    this->wakeup.NotifyAll();
+    for (std::thread &worker : this->workers) {
+        worker.join();
+    }
+    this->workers.clear();
+
+    // Handle what is left, so no accepted event is lost.
+    for (std::unique_ptr<Shard> &shard : this->shards) {
+        while (shard->loop.RunBatch() > 0) {
+        }
+    }
+}
+
+void ShardedExecutor::WaitIdle() const {
+    for (const std::unique_ptr<Shard> &shard : this->shards) {
+        shard->loop.WaitIdle();
+    }
+}
+
+void ShardedExecutor::Run(unsigned index) {
+    const std::size_t count = this->shards.size();
+    while (this->running.load(std::memory_order_relaxed)) {
+        std::size_t handled = 0;
+        for (std::size_t i = index; i < count; i += this->workerCount) {
+            handled += this->TryDrain(*this->shards[i]);
+        }
+        if (handled == 0) {
+            // Own shards are empty: steal one batch, then look at the own shards again.
+            for (std::size_t offset = 1; offset < count; ++offset) {
+                std::size_t victim = (index + offset) % count;
+                if (victim % this->workerCount == index) {
+                    continue;
+                }
+                handled = this->TryDrain(*this->shards[victim]);
+                if (handled > 0) {
+                    this->steals.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+        if (handled > 0) {
+            continue;
+        }
+
+        // Nothing to do, sleep until an event is posted or the executor is stopped.
+        std::uint32_t ticket = this->wakeup.PrepareWait();
+        if (this->HasPending() || !this->running.load(std::memory_order_relaxed)) {
+            this->wakeup.CancelWait();
+        }
+        else {
+            this->wakeup.Wait(ticket);
+        }
+    }
+}
+
+std::size_t ShardedExecutor::TryDrain(Shard &shard) {
+    if (shard.loop.Pending() == 0 || shard.draining.load(std::memory_order_relaxed) ||
+        shard.draining.exchange(true, std::memory_order_acquire)) {
+        return 0;
+    }
+    std::size_t handled = shard.loop.RunBatch();
+    shard.draining.store(false, std::memory_order_release);
+
+    // A burst larger than a batch: get an idle worker to help.
+    if (shard.loop.Pending() > 0) {
+        this->wakeup.Notify();
+    }
+    return handled;
+}
+
+bool ShardedExecutor::HasPending() const {
+    // A shard being drained is left to its drainer, which looks at it again before sleeping.
+    for (const std::unique_ptr<Shard> &shard : this->shards) {
+        if (shard->loop.Pending() > 0 && !shard->draining.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,112 @@
+#ifndef _SHARDED_EXECUTOR_H_
+#define _SHARDED_EXECUTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "control_loop.h"
+
+/**
+ * @brief ShardedExecutor runs the decisions of many threaded thermostats on a fixed set of worker threads, one per
+ *        core. Zones are partitioned into shards, each a ControlLoop on its own cache lines. The thermostat of a zone
+ *        is constructed with the loop of its shard, so its thermometer callbacks are routed to that shard.
+ *
+ *        Each shard is owned by one worker, and is only ever drained by one worker at a time. Workers drain their own
+ *        shards first and, once these are empty, steal a batch from another worker's pending shard. Thermostat state
+ *        is thus touched by a single thread at a time and needs no lock, wherever the work ends up running.
+ */
+class ShardedExecutor {
+public:
+    using ShardId = std::uint32_t;
+
+private:
+    // Shard of the zones, on its own cache lines.
+    struct alignas(64) Shard {
+        ControlLoop loop;            // Queue of the thermostat events of the shard's zones.
+        std::atomic<bool> draining;  // Set while a worker drains the loop.
+
+        Shard(std::size_t capacity, std::size_t batch, LoopWakeup &wakeup):
+                loop(capacity, batch, &wakeup),
+                draining(false) {}
+    };
+
+    LoopWakeup wakeup;                           // Wakes idle workers when events are posted into any shard.
+    std::vector<std::unique_ptr<Shard>> shards;  // Shard i is owned by worker i % workers.
+    std::vector<std::thread> workers;            // Running while the executor is started.
+    unsigned workerCount;                        // Number of worker threads started by Start.
+    bool pinWorkers;                             // Whether workers are pinned to CPUs.
+    std::atomic<bool> running;                   // Cleared to ask the workers to stop.
+    std::atomic<std::uint64_t> steals;           // Batches drained from a shard owned by another worker.
+
+    // Body of a worker thread.
+    void Run(unsigned index);
+
+    // Drains a batch of the shard unless another worker is draining it, returns the number of events handled.
+    std::size_t TryDrain(Shard &shard);
+
+    // Returns whether any shard has queued events.
+    bool HasPending() const;
+
+public:
+    /**
+     * @brief Creates a stopped executor.
+     * @param shardCount Number of shards, at least one. More shards than workers lets idle workers steal work at a
+     *                   finer grain.
+     * @param workers Number of worker threads, 0 to use one per CPU.
+     * @param capacity Minimum number of events each shard can hold before events are dropped.
+     * @param batch Maximum number of events handled by a worker before looking at the other shards.
+     * @param pin Whether to pin worker i to CPU i, modulo the number of CPUs.
+     */
+    explicit ShardedExecutor(std::size_t shardCount, unsigned workers = 0, std::size_t capacity = 1024,
+                             std::size_t batch = 64, bool pin = true);
+
+    // Stops the workers, handling the events still queued.
+    ~ShardedExecutor();
+
+    ShardedExecutor(const ShardedExecutor &) = delete;
+    ShardedExecutor &operator=(const ShardedExecutor &) = delete;
+
+    /**
+     * @brief Starts the workers. Events posted before the executor is started are kept in the shards.
+     */
+    void Start();
+
+    /**
+     * @brief Stops the workers after handling all queued events.
+     */
+    void Stop();
+
+    /**
+     * @brief Returns the shard owning a zone.
+     */
+    ShardId ShardOf(std::uint32_t zone) const { return static_cast<ShardId>(zone % this->shards.size()); }
+
+    /**
+     * @brief Returns the control loop of the shard owning a zone, to construct the zone's thermostat with. The
+     *        thermostat must be destroyed before the executor, while the executor is idle or stopped.
+     */
+    ControlLoop &LoopFor(std::uint32_t zone) { return this->shards[this->ShardOf(zone)]->loop; }
+
+    /**
+     * @brief Returns the control loop of a shard, e.g. to read its counters with GetStats.
+     */
+    const ControlLoop &Loop(ShardId shard) const { return this->shards[shard]->loop; }
+
+    std::size_t Shards() const { return this->shards.size(); }
+    unsigned Workers() const { return this->workerCount; }
+
+    /**
+     * @brief Waits until every event posted so far has been handled. The executor must be started.
+     */
+    void WaitIdle() const;
+
+    /**
+     * @brief Returns the number of batches a worker drained from a shard owned by another worker.
+     */
+    std::uint64_t Steals() const { return this->steals.load(std::memory_order_relaxed); }
+};
+
+#endif //_SHARDED_EXECUTOR_H_
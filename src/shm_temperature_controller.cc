@@ -0,0 +1,31 @@
+#include "shm_temperature_controller.h"
+
+ShmTemperatureController::ShmTemperatureController(ActuatorChannel &actuatorChannel, std::uint32_t zoneId):
+        channel(actuatorChannel),
+        zone(zoneId),
+        heating(false),
+        cooling(false),
+        rejected(0) {
+}
+
+void ShmTemperatureController::Heat(bool on) {
+    this->heating = on;
+    this->Send();
+}
+
+void ShmTemperatureController::Cool(bool on) {
+    this->cooling = on;
+    this->Send();
+}
+
+void ShmTemperatureController::SetMode(bool heat, bool cool) {
+    this->heating = heat;
+    this->cooling = cool;
+    this->Send();
+}
+
+void ShmTemperatureController::Send() {
+    if (!this->channel.Submit(this->zone, this->heating, this->cooling)) {
+        ++this->rejected;
+    }
+}
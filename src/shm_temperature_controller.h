@@ -0,0 +1,44 @@
+#ifndef _SHM_TEMPERATURE_CONTROLLER_H_
+#define _SHM_TEMPERATURE_CONTROLLER_H_
+
+#include <cstdint>
+#include "actuator_channel.h"
+#include "temperature_controller.h"
+
+/**
+ * @brief Temperature controller of one zone whose relays are driven by an out-of-process daemon. Every write
+ *        submits the full heating and cooling state of the zone to an actuator channel, so a SetMode is a single
+ *        command and the daemon never sees a half applied transition.
+ */
+class ShmTemperatureController: public TemperatureController {
+private:
+    ActuatorChannel &channel; // Channel to the daemon.
+    std::uint32_t zone;       // Zone of the commands.
+    bool heating;             // Heating state of the last command.
+    bool cooling;             // Cooling state of the last command.
+    std::uint64_t rejected;   // Number of commands the channel had no room for.
+
+    void Send();
+
+public:
+    /**
+     * @brief Creates the controller of a zone.
+     * @param actuatorChannel An open channel, shared by the zones served by the same daemon. Must outlive the
+     *        controller.
+     * @param zoneId The zone number known to the daemon.
+     */
+    ShmTemperatureController(ActuatorChannel &actuatorChannel, std::uint32_t zoneId);
+
+    void Heat(bool on) override;
+    void Cool(bool on) override;
+    void SetMode(bool heat, bool cool) override;
+    bool SupportsModeTransition() const override { return true; }
+
+    /**
+     * @brief Returns the number of commands dropped because the channel was full. The next write sends the full
+     *        state again, so a dropped command is made up for by the next decision.
+     */
+    std::uint64_t Rejected() const { return this->rejected; }
+};
+
+#endif //_SHM_TEMPERATURE_CONTROLLER_H_
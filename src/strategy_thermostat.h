@@ -0,0 +1,148 @@
+#ifndef _STRATEGY_THERMOSTAT_H_
+#define _STRATEGY_THERMOSTAT_H_
+
+#include "control_strategy.h"
+#include "thermometer.h"
+#include "temperature_controller.h"
+#include "thermostat.h"
+
+/**
+ * @brief Thermostat whose decisions are made by a control strategy chosen at compile time. With a concrete strategy
+ *        such as DeadbandStrategy every decision is inlined; StrategyThermostat takes any strategy through the
+ *        ControlStrategy interface, e.g. one made by MakeControlStrategy from a configuration.
+ *
+ *        Threshold notifications go to Strategy::OnCrossing. Poll reads the thermometer and goes to Strategy::Decide,
+ *        call it at a fixed rate for sampled strategies such as PiStrategy. After each decision the thresholds the
+ *        strategy wants are armed, and the actuators are only written when the decision changes.
+ *
+ *        Not thread-safe: notifications and calls must come from one thread at a time, e.g. the sensor's.
+ */
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+class BasicStrategyThermostat {
+private:
+    // Callable registered with the thermometer, holding only a pointer to the thermostat.
+    struct ThresholdCallback {
+        BasicStrategyThermostat *thermostat;
+        void operator()(bool isHigh) const { this->thermostat->OnCrossing(isHigh); }
+    };
+
+    Meter &thermometer;          // Thermometer of the room.
+    Controller &tempController;  // Heats or cools the room.
+    Strategy &strategy;          // Makes the decisions.
+    ActuatorState state;         // State the actuators were last put in.
+    ArmedThresholds armed;       // Thresholds last set on the thermometer.
+    bool isOn;                   // Whether the thermostat controls the room.
+    std::uint64_t transitions;   // Number of decisions that changed the actuator state.
+
+    // Handles a threshold notification of the thermometer.
+    void OnCrossing(bool isHigh);
+
+    // Writes a decision to the actuators if it changes their state or if forced, then arms the thresholds.
+    void Apply(ActuatorState next, bool force);
+
+public:
+    /**
+     * @brief Creates an enabled thermostat: arms the strategy's thresholds, registers the thermostat callback, then
+     *        decides on a first reading and writes the actuators.
+     * @param therm The thermometer of the room.
+     * @param tempCon The temperature controller of the room.
+     * @param controlStrategy The strategy. Must outlive the thermostat, and only be used by it.
+     */
+    BasicStrategyThermostat(Meter &therm, Controller &tempCon, Strategy &controlStrategy);
+
+    // The thermometer keeps a pointer to this object in its callback, so it must not be copied or moved.
+    BasicStrategyThermostat(const BasicStrategyThermostat &) = delete;
+    BasicStrategyThermostat &operator=(const BasicStrategyThermostat &) = delete;
+
+    /**
+     * @brief Reads the thermometer and decides on the reading.
+     */
+    void Poll();
+
+    /**
+     * @brief Decides again on a reading and writes the actuators, e.g. after the strategy's settings were changed.
+     */
+    void Reconfigure();
+
+    /**
+     * @brief Controls whether the thermostat is enabled. Enabling it decides on a reading and writes the actuators.
+     * @param on True - enables the thermostat, False - disables the thermostat.
+     */
+    void EnableThermostat(bool on);
+
+    ActuatorState State() const { return this->state; }
+
+    /**
+     * @brief Returns the number of decisions that changed the actuator state, a measure of actuator cycling.
+     */
+    std::uint64_t Transitions() const { return this->transitions; }
+};
+
+/**
+ * @brief Strategy thermostat over the abstract interfaces, with the strategy chosen at runtime.
+ */
+using StrategyThermostat = BasicStrategyThermostat<ControlStrategy, Thermometer, TemperatureController>;
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+BasicStrategyThermostat<Strategy, Meter, Controller>::BasicStrategyThermostat(Meter &therm, Controller &tempCon,
+                                                                              Strategy &controlStrategy):
+        thermometer(therm),
+        tempController(tempCon),
+        strategy(controlStrategy),
+        state{false, false},
+        armed(controlStrategy.Thresholds(ActuatorState{false, false})),
+        isOn(true),
+        transitions(0) {
+    // Set thresholds before registering the callback to ensure no spurious callback is triggered.
+    this->thermometer.SetTemperatureThresholds(this->armed.high, this->armed.low);
+    this->thermometer.RegisterCallback(ThresholdCallback{this});
+    this->Reconfigure();
+}
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+void BasicStrategyThermostat<Strategy, Meter, Controller>::OnCrossing(bool isHigh) {
+    if (this->isOn) {
+        this->Apply(this->strategy.OnCrossing(isHigh, this->state), false);
+    }
+}
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+void BasicStrategyThermostat<Strategy, Meter, Controller>::Poll() {
+    if (this->isOn) {
+        this->Apply(this->strategy.Decide(this->thermometer.GetTemperature(), this->state), false);
+    }
+}
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+void BasicStrategyThermostat<Strategy, Meter, Controller>::Reconfigure() {
+    if (this->isOn) {
+        this->Apply(this->strategy.Decide(this->thermometer.GetTemperature(), this->state), true);
+    }
+}
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+void BasicStrategyThermostat<Strategy, Meter, Controller>::EnableThermostat(bool on) {
+    this->isOn = on;
+    this->Reconfigure();
+}
+
+template <ControlPolicy Strategy, TemperatureSensor Meter, HeatingCoolingActuator Controller>
+void BasicStrategyThermostat<Strategy, Meter, Controller>::Apply(ActuatorState next, bool force) {
+    if (next != this->state) {
+        ++this->transitions;
+        this->state = next;
+        WriteActuators(this->tempController, next);
+    }
+    else if (force) {
+        WriteActuators(this->tempController, next);
+    }
+
+    // Thresholds may notify at once when set, so they are recorded first: the nested decision arms its own.
+    ArmedThresholds thresholds = this->strategy.Thresholds(this->state);
+    if (thresholds != this->armed) {
+        this->armed = thresholds;
+        this->thermometer.SetTemperatureThresholds(thresholds.high, thresholds.low);
+    }
+}
+
+#endif //_STRATEGY_THERMOSTAT_H_
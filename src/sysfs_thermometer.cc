@@ -0,0 +1,255 @@
+#include "sysfs_thermometer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+// Returns the first line of a small attribute file, empty if it cannot be read.
+std::string ReadAttribute(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// Reads a temperature file from the start.
+bool ReadTemperature(int fd, Temperature &temperature) {
+    char buffer[32];
+    ssize_t length = ::pread(fd, buffer, sizeof(buffer), 0);
+    return length > 0 && SysfsThermometer::ParseMillidegrees(buffer, static_cast<std::size_t>(length), temperature);
+}
+
+void CloseDescriptor(int &fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+} // namespace
+
+std::vector<SysfsSensor> DiscoverSysfsSensors(const std::string &root) {
+    namespace fs = std::filesystem;
+    std::vector<SysfsSensor> sensors;
+    std::error_code error;
+
+    fs::path hwmon = fs::path(root) / "class" / "hwmon";
+    for (const fs::directory_entry &device : fs::directory_iterator(hwmon, error)) {
+        std::string chip = ReadAttribute(device.path() / "name");
+        for (const fs::directory_entry &attribute : fs::directory_iterator(device.path(), error)) {
+            std::string file = attribute.path().filename().string();
+            if (file.starts_with("temp") && file.ends_with("_input")) {
+                std::string channel = file.substr(0, file.size() - std::string("_input").size());
+                std::string label = ReadAttribute(device.path() / (channel + "_label"));
+                sensors.push_back(SysfsSensor{attribute.path().string(),
+                                              chip + " " + (label.empty() ? channel : label)});
+            }
+        }
+    }
+
+    fs::path thermal = fs::path(root) / "class" / "thermal";
+    for (const fs::directory_entry &zone : fs::directory_iterator(thermal, error)) {
+        if (zone.path().filename().string().starts_with("thermal_zone") && fs::exists(zone.path() / "temp", error)) {
+            sensors.push_back(SysfsSensor{(zone.path() / "temp").string(), ReadAttribute(zone.path() / "type")});
+        }
+    }
+
+    std::sort(sensors.begin(), sensors.end(),
+              [](const SysfsSensor &a, const SysfsSensor &b) { return a.path < b.path; });
+    return sensors;
+}
+
+SysfsReactor::SysfsReactor(std::chrono::milliseconds samplingInterval):
+        sampling(false),
+        closed(0),
+        interval(samplingInterval.count() > 0 ? samplingInterval : std::chrono::milliseconds(1)),
+        epollFd(-1),
+        timerFd(-1),
+        eventFd(-1),
+        running(false) {
+}
+
+SysfsReactor::~SysfsReactor() {
+    this->Stop();
+}
+
+bool SysfsReactor::Start() {
+    if (this->running.load()) {
+        return true;
+    }
+    this->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    this->timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    this->eventFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    itimerspec period{};
+    period.it_interval.tv_sec = this->interval.count() / 1000;
+    period.it_interval.tv_nsec = (this->interval.count() % 1000) * 1000000;
+    period.it_value = period.it_interval;
+    epoll_event timerEvent{};
+    timerEvent.events = EPOLLIN;
+    timerEvent.data.fd = this->timerFd;
+    epoll_event stopEvent{};
+    stopEvent.events = EPOLLIN;
+    stopEvent.data.fd = this->eventFd;
+    if (this->epollFd < 0 || this->timerFd < 0 || this->eventFd < 0 ||
+            ::timerfd_settime(this->timerFd, 0, &period, nullptr) != 0 ||
+            ::epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->timerFd, &timerEvent) != 0 ||
+            ::epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->eventFd, &stopEvent) != 0) {
+        CloseDescriptor(this->epollFd);
+        CloseDescriptor(this->timerFd);
+        CloseDescriptor(this->eventFd);
+        return false;
+    }
+
+    this->running.store(true);
+    this->thread = std::thread(&SysfsReactor::Run, this);
+    return true;
+}
+
+void SysfsReactor::Stop() {
+    if (this->running.exchange(false)) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(this->eventFd, &one, sizeof(one));
+        (void)written;
+        this->thread.join();
+        CloseDescriptor(this->epollFd);
+        CloseDescriptor(this->timerFd);
+        CloseDescriptor(this->eventFd);
+    }
+}
+
+void SysfsReactor::Sample() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    // A callback may open or close thermometers. Index based, so that an opened thermometer may grow the vector, and
+    // closed thermometers are only nulled, so that no entry shifts into a slot already sampled.
+    bool outermost = !this->sampling;
+    this->sampling = true;
+    for (std::size_t i = 0; i < this->thermometers.size(); ++i) {
+        if (this->thermometers[i] != nullptr) {
+            this->thermometers[i]->Sample();
+        }
+    }
+    if (!outermost) {
+        return;
+    }
+    this->sampling = false;
+    if (this->closed > 0) {
+        this->thermometers.erase(std::remove(this->thermometers.begin(), this->thermometers.end(), nullptr),
+                                 this->thermometers.end());
+        this->closed = 0;
+    }
+}
+
+std::size_t SysfsReactor::Size() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->thermometers.size() - this->closed;
+}
+
+void SysfsReactor::Run() {
+    epoll_event events[2];
+    while (this->running.load()) {
+        int ready = ::epoll_wait(this->epollFd, events, 2, -1);
+        for (int i = 0; i < ready; ++i) {
+            if (events[i].data.fd == this->timerFd) {
+                // Expirations missed while sampling are dropped, sampling late once is enough.
+                std::uint64_t expirations;
+                if (::read(this->timerFd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    this->Sample();
+                }
+            }
+        }
+    }
+}
+
+SysfsThermometer::SysfsThermometer(SysfsReactor &sysfsReactor, Temperature minMeasurable,
+                                   Temperature maxMeasurable):
+        reactor(sysfsReactor),
+        monitor(minMeasurable, maxMeasurable),
+        fd(-1),
+        lastReading() {
+}
+
+SysfsThermometer::~SysfsThermometer() {
+    this->Close();
+}
+
+bool SysfsThermometer::Open(const std::string &path) {
+    this->Close();
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    Temperature reading;
+    if (file < 0) {
+        return false;
+    }
+    if (!ReadTemperature(file, reading)) {
+        ::close(file);
+        return false;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(this->reactor.mutex);
+    this->fd = file;
+    this->lastReading.store(reading, std::memory_order_relaxed);
+    this->monitor.Update(reading);
+    this->reactor.thermometers.push_back(this);
+    return true;
+}
+
+void SysfsThermometer::Close() {
+    std::lock_guard<std::recursive_mutex> lock(this->reactor.mutex);
+    if (this->fd >= 0) {
+        std::vector<SysfsThermometer *> &thermometers = this->reactor.thermometers;
+        if (this->reactor.sampling) {
+            // Called from a callback, leave a null entry for Sample to remove.
+            std::replace(thermometers.begin(), thermometers.end(), this, static_cast<SysfsThermometer *>(nullptr));
+            ++this->reactor.closed;
+        }
+        else {
+            thermometers.erase(std::remove(thermometers.begin(), thermometers.end(), this), thermometers.end());
+        }
+        CloseDescriptor(this->fd);
+    }
+}
+
+Temperature SysfsThermometer::GetTemperature() const {
+    Temperature reading;
+    if (this->fd >= 0 && ReadTemperature(this->fd, reading)) {
+        this->lastReading.store(reading, std::memory_order_relaxed);
+        return reading;
+    }
+    return this->lastReading.load(std::memory_order_relaxed);
+}
+
+bool SysfsThermometer::SetTemperatureThresholds(Temperature high, Temperature low) {
+    std::lock_guard<std::recursive_mutex> lock(this->reactor.mutex);
+    return this->monitor.SetThresholds(high, low);
+}
+
+void SysfsThermometer::RegisterCallback(TemperatureCallback callback) {
+    std::lock_guard<std::recursive_mutex> lock(this->reactor.mutex);
+    this->monitor.RegisterCallback(std::move(callback));
+}
+
+void SysfsThermometer::Sample() {
+    Temperature reading;
+    if (ReadTemperature(this->fd, reading)) {
+        this->lastReading.store(reading, std::memory_order_relaxed);
+        this->monitor.Update(reading);
+    }
+}
+
+bool SysfsThermometer::ParseMillidegrees(const char *text, std::size_t length, Temperature &temperature) {
+    long millidegrees = 0;
+    std::from_chars_result result = std::from_chars(text, text + length, millidegrees);
+    if (result.ec != std::errc() || (result.ptr != text + length && *result.ptr != '\n')) {
+        return false;
+    }
+    temperature = Temperature::FromMilliCelsius(millidegrees);
+    return true;
+}
@@ -0,0 +1,154 @@
+#ifndef _SYSFS_THERMOMETER_H_
+#define _SYSFS_THERMOMETER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "thermometer.h"
+#include "threshold_monitor.h"
+
+class SysfsThermometer;
+
+/**
+ * @brief Temperature sensor file found in sysfs.
+ */
+struct SysfsSensor {
+    std::string path;  // File holding the temperature in millidegrees Celsius.
+    std::string label; // Name of the chip and sensor, or type of the thermal zone.
+};
+
+/**
+ * @brief Lists the temperature files under a sysfs root, sorted by path: the tempN_input files of the
+ *        class/hwmon devices and the temp files of the class/thermal zones.
+ * @param root The sysfs mount point, or a fake tree with the same layout.
+ */
+std::vector<SysfsSensor> DiscoverSysfsSensors(const std::string &root = "/sys");
+
+/**
+ * @brief Samples every open SysfsThermometer from a single thread. The thread sleeps in epoll on a timerfd that
+ *        expires every sampling interval, and on an eventfd used to stop it, so the number of threads does not
+ *        grow with the number of sensors. Temperature attributes do not support poll notifications, so crossings
+ *        are detected by sampling.
+ *
+ *        Samples, and the thermometer callbacks they trigger, run with the reactor lock held.
+ */
+class SysfsReactor {
+private:
+    std::vector<SysfsThermometer *> thermometers; // Open thermometers, sampled in order. Null for a thermometer
+                                                  // closed during the current sample.
+    bool sampling;                                // Set while Sample walks the thermometers.
+    std::size_t closed;                           // Null entries left in the thermometers by the current sample.
+    std::chrono::milliseconds interval;           // Sampling interval.
+    std::recursive_mutex mutex;                   // Protects the thermometers. Recursive, so that callbacks can set
+                                                  // thresholds on the thermometer notifying them.
+    int epollFd;                                  // Epoll instance waiting on the two descriptors below.
+    int timerFd;                                  // Expires every sampling interval.
+    int eventFd;                                  // Signalled to stop the thread.
+    std::thread thread;                           // Reactor thread, running while the reactor is started.
+    std::atomic<bool> running;                    // Cleared to ask the thread to stop.
+
+    // Body of the reactor thread.
+    void Run();
+
+    friend class SysfsThermometer;
+
+public:
+    /**
+     * @brief Creates a stopped reactor.
+     * @param samplingInterval Time between two samples of every sensor.
+     */
+    explicit SysfsReactor(std::chrono::milliseconds samplingInterval = std::chrono::milliseconds(1000));
+
+    // Stops the reactor thread. Every thermometer using the reactor must be destroyed first.
+    ~SysfsReactor();
+
+    SysfsReactor(const SysfsReactor &) = delete;
+    SysfsReactor &operator=(const SysfsReactor &) = delete;
+
+    /**
+     * @brief Starts the reactor thread.
+     * @ret   True if the thread runs, false if the epoll, timer or event descriptors could not be created.
+     */
+    bool Start();
+
+    /**
+     * @brief Stops the reactor thread.
+     */
+    void Stop();
+
+    /**
+     * @brief Samples every sensor once by hand, e.g. from a test.
+     */
+    void Sample();
+
+    /**
+     * @brief Returns the number of open thermometers.
+     */
+    std::size_t Size();
+};
+
+/**
+ * @brief Thermometer reading a Linux hwmon or thermal zone temperature file. The file is opened once and re-read
+ *        with pread, without allocating. Readings are rounded to the nearest tenth of a degree. Threshold crossings are
+ *        detected when the reactor samples the sensor, and notified as documented by the Thermometer interface.
+ */
+class SysfsThermometer: public Thermometer {
+private:
+    SysfsReactor &reactor;        // Reactor sampling the sensor.
+    ThresholdMonitor monitor;     // Keeps the thresholds and notifies crossings.
+    int fd;                       // Temperature file, -1 while closed.
+    mutable std::atomic<Temperature> lastReading; // Last temperature read successfully.
+
+    // Reads the sensor and notifies crossings. Called by the reactor with its lock held.
+    void Sample();
+
+    friend class SysfsReactor;
+
+public:
+    /**
+     * @brief Creates a closed thermometer.
+     * @param sysfsReactor The reactor sampling the sensor. Must outlive the thermometer.
+     * @param minMeasurable Minimum measurable temperature, lower thresholds are clamped to it.
+     * @param maxMeasurable Maximum measurable temperature, higher thresholds are clamped to it.
+     */
+    explicit SysfsThermometer(SysfsReactor &sysfsReactor, Temperature minMeasurable = Temperature::FromCelsius(-40),
+                              Temperature maxMeasurable = Temperature::FromCelsius(125));
+
+    // Closes the file.
+    ~SysfsThermometer() override;
+
+    SysfsThermometer(const SysfsThermometer &) = delete;
+    SysfsThermometer &operator=(const SysfsThermometer &) = delete;
+
+    /**
+     * @brief Opens a temperature file, reads it and adds the sensor to the reactor.
+     * @param path The temperature file, e.g. a path returned by DiscoverSysfsSensors.
+     * @ret   True if the file is open and holds a temperature, false otherwise.
+     */
+    bool Open(const std::string &path);
+
+    /**
+     * @brief Removes the sensor from the reactor and closes the file.
+     */
+    void Close();
+
+    bool IsOpen() const { return this->fd >= 0; }
+
+    // Reads the sensor. Returns the last successful reading if the file cannot be read or parsed.
+    Temperature GetTemperature() const override;
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override;
+    void RegisterCallback(TemperatureCallback callback) override;
+
+    /**
+     * @brief Parses the content of a temperature file, in millidegrees Celsius, rounded to the nearest tenth of a
+     *        degree.
+     * @ret   True if the text holds a temperature, false otherwise.
+     */
+    static bool ParseMillidegrees(const char *text, std::size_t length, Temperature &temperature);
+};
+
+#endif //_SYSFS_THERMOMETER_H_
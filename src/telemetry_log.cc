@@ -0,0 +1,169 @@
+#include "telemetry_log.h"
+
+#include <bit>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool ValidHeader(const TelemetryLogHeader &header, std::size_t fileSize) {
+    return header.magic == TelemetryLogHeader::expectedMagic &&
+           header.version == TelemetryLogHeader::currentVersion &&
+           header.recordSize == sizeof(TelemetryRecord) &&
+           std::has_single_bit(header.capacity) &&
+           fileSize == sizeof(TelemetryLogHeader) + header.capacity * sizeof(TelemetryRecord);
+}
+
+} // namespace
+
+TelemetryLog::TelemetryLog():
+        header(nullptr),
+        records(nullptr),
+        mask(0),
+        mappedSize(0) {
+}
+
+TelemetryLog::~TelemetryLog() {
+    this->Close();
+}
+
+bool TelemetryLog::Open(const std::string &path, std::size_t capacity) {
+    this->Close();
+    std::size_t ringSize = std::bit_ceil(capacity > 0 ? capacity : 1);
+    std::size_t size = sizeof(TelemetryLogHeader) + ringSize * sizeof(TelemetryRecord);
+
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(file, &status) != 0 || (status.st_size == 0 && ::ftruncate(file, size) != 0)) {
+        ::close(file);
+        return false;
+    }
+    bool created = status.st_size == 0;
+    if (!created && static_cast<std::size_t>(status.st_size) != size) {
+        ::close(file);
+        return false;
+    }
+
+    // The mapping stays valid once the descriptor is closed.
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    TelemetryLogHeader *mappedHeader = static_cast<TelemetryLogHeader *>(mapping);
+    if (created) {
+        // The new file reads as zeros, so every record is uncommitted.
+        mappedHeader->magic = TelemetryLogHeader::expectedMagic;
+        mappedHeader->version = TelemetryLogHeader::currentVersion;
+        mappedHeader->recordSize = sizeof(TelemetryRecord);
+        mappedHeader->capacity = ringSize;
+        mappedHeader->nextSequence = 1;
+    }
+    else if (!ValidHeader(*mappedHeader, size)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+
+    this->header = mappedHeader;
+    this->records = reinterpret_cast<TelemetryRecord *>(static_cast<char *>(mapping) + sizeof(TelemetryLogHeader));
+    this->mask = ringSize - 1;
+    this->mappedSize = size;
+    if (!created) {
+        this->SealIncompleteRecords();
+    }
+    return true;
+}
+
+void TelemetryLog::Close() {
+    if (this->header != nullptr) {
+        ::munmap(this->header, this->mappedSize);
+        this->header = nullptr;
+        this->records = nullptr;
+        this->mask = 0;
+        this->mappedSize = 0;
+    }
+}
+
+void TelemetryLog::Flush() {
+    if (this->header != nullptr) {
+        ::msync(this->header, this->mappedSize, MS_ASYNC);
+    }
+}
+
+void TelemetryLog::SealIncompleteRecords() {
+    std::uint64_t next = this->header->nextSequence;
+    std::uint64_t capacity = this->mask + 1;
+    std::uint64_t first = next > capacity ? next - capacity : 1;
+    for (std::uint64_t sequence = first; sequence < next; ++sequence) {
+        TelemetryRecord &slot = this->records[(sequence - 1) & this->mask];
+        if (slot.sequence != sequence) {
+            slot.timestamp = 0;
+            slot.thermostat = 0;
+            slot.event = TelemetryEvent::Lost;
+            slot.reserved = 0;
+            slot.first = 0;
+            slot.second = 0;
+            std::atomic_ref<std::uint64_t>(slot.sequence).store(sequence, std::memory_order_release);
+        }
+    }
+}
+
+TelemetryReader::TelemetryReader():
+        header(nullptr),
+        records(nullptr),
+        mask(0),
+        mappedSize(0),
+        lost(0) {
+}
+
+TelemetryReader::~TelemetryReader() {
+    this->Close();
+}
+
+bool TelemetryReader::Open(const std::string &path) {
+    this->Close();
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(TelemetryLogHeader)) {
+        ::close(file);
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    // The mapping stays valid once the descriptor is closed.
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    const TelemetryLogHeader *mappedHeader = static_cast<const TelemetryLogHeader *>(mapping);
+    if (!ValidHeader(*mappedHeader, size)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+
+    this->header = mappedHeader;
+    this->records = reinterpret_cast<const TelemetryRecord *>(static_cast<const char *>(mapping) +
+                                                               sizeof(TelemetryLogHeader));
+    this->mask = mappedHeader->capacity - 1;
+    this->mappedSize = size;
+    this->lost = 0;
+    return true;
+}
+
+void TelemetryReader::Close() {
+    if (this->header != nullptr) {
+        ::munmap(const_cast<TelemetryLogHeader *>(this->header), this->mappedSize);
+        this->header = nullptr;
+        this->records = nullptr;
+        this->mask = 0;
+        this->mappedSize = 0;
+    }
+}
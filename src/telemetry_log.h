@@ -0,0 +1,214 @@
+#ifndef _TELEMETRY_LOG_H_
+#define _TELEMETRY_LOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Kind of event stored in a telemetry record, and the meaning of its two values.
+ */
+enum class TelemetryEvent: std::uint16_t {
+    Reading = 1,     // Temperature read by the thermostat: first = temperature, in tenths of a degree Celsius.
+    Alarm = 2,       // Threshold notification from the thermometer: first = isHigh, second = thermostat enabled.
+    Thresholds = 3,  // Thresholds sent to the thermometer: first = high, second = low, in tenths of a degree.
+    Enable = 4,      // Thermostat enabled or disabled: first = on.
+    Actuation = 5,   // Decision sent to the temperature controller: first = heat, second = cool.
+    Lost = 6,        // Record left incomplete by a writer that stopped, sealed when the log was reopened.
+};
+
+/**
+ * @brief Fixed size record of the telemetry log.
+ */
+struct TelemetryRecord {
+    std::uint64_t sequence;   // Position in the log, starting at 1. Stored last when the record is committed.
+    std::int64_t timestamp;   // system_clock time of the event, in nanoseconds since the epoch.
+    std::uint32_t thermostat; // Identifier of the thermostat, given to AttachTelemetry.
+    TelemetryEvent event;     // Kind of event.
+    std::uint16_t reserved;   // Zero.
+    std::int32_t first;       // First value, see TelemetryEvent.
+    std::int32_t second;      // Second value, see TelemetryEvent.
+};
+
+static_assert(sizeof(TelemetryRecord) == 32, "telemetry records are 32 bytes on disk");
+
+/**
+ * @brief Header at the start of a telemetry log file, followed by capacity records.
+ */
+struct TelemetryLogHeader {
+    static constexpr std::uint32_t expectedMagic = 0x4d4c5454; // "TTLM"
+    static constexpr std::uint16_t currentVersion = 2; // Version 1 stored whole degrees.
+
+    std::uint32_t magic;         // expectedMagic.
+    std::uint16_t version;       // currentVersion.
+    std::uint16_t recordSize;    // sizeof(TelemetryRecord).
+    std::uint64_t capacity;      // Number of records in the ring, a power of two.
+    std::uint64_t nextSequence;  // Sequence of the next record to claim. Updated atomically by the writers.
+    std::uint64_t reserved[5];   // Zero. Pads the header to a cache line.
+};
+
+static_assert(sizeof(TelemetryLogHeader) == 64, "the telemetry log header is one cache line");
+
+/**
+ * @brief Append-only log of thermostat events, kept in a ring of fixed size records in a memory-mapped file.
+ *
+ *        Appending claims a sequence number with one atomic increment and copies the record into the mapping,
+ *        without system calls. The record's sequence is stored last with release ordering, so a reader never
+ *        takes a partially written record for a committed one. The mapping is shared, so committed records reach
+ *        the file even if the process crashes. A record left incomplete by a crash is sealed as Lost when the log
+ *        is opened again. Once the ring is full, the oldest records are overwritten.
+ */
+class TelemetryLog {
+private:
+    TelemetryLogHeader *header; // Start of the mapping, null while closed.
+    TelemetryRecord *records;   // Records following the header.
+    std::size_t mask;           // capacity - 1.
+    std::size_t mappedSize;     // Size of the mapping, in bytes.
+
+    // Marks every claimed but uncommitted record in the ring as Lost.
+    void SealIncompleteRecords();
+
+public:
+    TelemetryLog();
+    ~TelemetryLog();
+
+    TelemetryLog(const TelemetryLog &) = delete;
+    TelemetryLog &operator=(const TelemetryLog &) = delete;
+
+    /**
+     * @brief Opens the log file, creating it if it does not exist. An existing log continues after its last
+     *        record, and must have the requested capacity.
+     * @param path The log file.
+     * @param capacity Number of records kept before the oldest ones are overwritten, rounded up to a power of two.
+     * @ret   True if the log is open, false if the file could not be created or mapped, or is not a log of the
+     *        requested capacity.
+     */
+    bool Open(const std::string &path, std::size_t capacity);
+
+    /**
+     * @brief Unmaps the file. No record may be appended concurrently.
+     */
+    void Close();
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    /**
+     * @brief Asks the kernel to write the mapped records to disk, to survive a power loss rather than a crash.
+     */
+    void Flush();
+
+    /**
+     * @brief Appends a record. The log must be open. Safe to call from several threads at once.
+     */
+    void Append(std::uint32_t thermostat, TelemetryEvent event, std::int32_t first, std::int32_t second) {
+        std::uint64_t sequence = std::atomic_ref<std::uint64_t>(this->header->nextSequence)
+                .fetch_add(1, std::memory_order_relaxed);
+        TelemetryRecord &slot = this->records[(sequence - 1) & this->mask];
+        std::atomic_ref<std::uint64_t> committed(slot.sequence);
+
+        TelemetryRecord record;
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        record.thermostat = thermostat;
+        record.event = event;
+        record.reserved = 0;
+        record.first = first;
+        record.second = second;
+
+        // Readers seeing the old sequence after the payload changed would accept a torn record, so retire it first.
+        committed.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(reinterpret_cast<char *>(&slot) + sizeof(slot.sequence),
+                    reinterpret_cast<const char *>(&record) + sizeof(record.sequence),
+                    sizeof(record) - sizeof(record.sequence));
+        committed.store(sequence, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief Reads a telemetry log in place through a read-only mapping, while it may still be written by another
+ *        thread or process.
+ */
+class TelemetryReader {
+private:
+    const TelemetryLogHeader *header; // Start of the mapping, null while closed.
+    const TelemetryRecord *records;   // Records following the header.
+    std::size_t mask;                 // capacity - 1.
+    std::size_t mappedSize;           // Size of the mapping, in bytes.
+    std::uint64_t lost;               // Records overwritten before they were read.
+
+    static std::uint64_t Load(const std::uint64_t &value, std::memory_order order) {
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(value)).load(order);
+    }
+
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader &) = delete;
+    TelemetryReader &operator=(const TelemetryReader &) = delete;
+
+    /**
+     * @brief Maps an existing log file.
+     * @ret   True if the file is a telemetry log of a supported version, false otherwise.
+     */
+    bool Open(const std::string &path);
+
+    void Close();
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    std::size_t Capacity() const { return this->mask + 1; }
+
+    /**
+     * @brief Returns the sequence the next appended record will get.
+     */
+    std::uint64_t NextSequence() const { return Load(this->header->nextSequence, std::memory_order_acquire); }
+
+    /**
+     * @brief Returns the number of records overwritten by the writers before they could be read.
+     */
+    std::uint64_t Lost() const { return this->lost; }
+
+    /**
+     * @brief Visits the committed records from the given sequence on, oldest first. Records already overwritten
+     *        are skipped and counted as lost. Stops at the first record still being written.
+     * @param from Sequence of the first record to visit, 1 for the start of the log.
+     * @param visit Callable invoked with each committed record.
+     * @ret   The sequence to pass to the next call to continue after the last visited record.
+     */
+    template <typename Visitor>
+    std::uint64_t ReadFrom(std::uint64_t from, Visitor &&visit) {
+        std::uint64_t next = this->NextSequence();
+        std::uint64_t sequence = from > 0 ? from : 1;
+        if (next > this->Capacity() && sequence < next - this->Capacity()) {
+            this->lost += next - this->Capacity() - sequence;
+            sequence = next - this->Capacity();
+        }
+
+        for (; sequence < next; ++sequence) {
+            const TelemetryRecord &slot = this->records[(sequence - 1) & this->mask];
+            std::uint64_t before = Load(slot.sequence, std::memory_order_acquire);
+            if (before == 0 || before < sequence) {
+                // Claimed but not committed yet.
+                break;
+            }
+            TelemetryRecord record;
+            std::memcpy(&record, &slot, sizeof(record));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before != sequence || Load(slot.sequence, std::memory_order_relaxed) != sequence) {
+                // Overwritten by a newer record before or while it was copied.
+                ++this->lost;
+                continue;
+            }
+            record.sequence = sequence;
+            visit(static_cast<const TelemetryRecord &>(record));
+        }
+        return sequence;
+    }
+};
+
+#endif //_TELEMETRY_LOG_H_
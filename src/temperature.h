@@ -0,0 +1,138 @@
+#ifndef _TEMPERATURE_H_
+#define _TEMPERATURE_H_
+
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace temperature_detail {
+
+// Divides, rounding half away from zero. The divisor is positive.
+constexpr std::int64_t DivideRounded(std::int64_t numerator, std::int64_t divisor) {
+    return numerator >= 0 ? (numerator + divisor / 2) / divisor : (numerator - divisor / 2) / divisor;
+}
+
+} // namespace temperature_detail
+
+/**
+ * @brief Temperature in tenths of a degree Celsius, the resolution of our sensors. Stored as a single 32 bit integer,
+ *        so comparisons and differences compile to integer instructions and arrays of temperatures can be evaluated
+ *        with vector instructions. Build temperatures with the named constructors or the literals of
+ *        temperature_literals; there is no implicit conversion from plain numbers.
+ *
+ *        Conversions that lose precision round half away from zero.
+ */
+class Temperature {
+private:
+    std::int32_t deciCelsius; // Tenths of a degree Celsius.
+
+    constexpr explicit Temperature(std::int32_t tenths): deciCelsius(tenths) {}
+
+public:
+    // Number of steps per degree.
+    static constexpr std::int32_t scale = 10;
+
+    // Zero degrees Celsius.
+    constexpr Temperature(): deciCelsius(0) {}
+
+    static constexpr Temperature FromDeciCelsius(std::int32_t tenths) { return Temperature(tenths); }
+    static constexpr Temperature FromCelsius(std::int32_t degrees) { return Temperature(degrees * scale); }
+    static constexpr Temperature FromMilliCelsius(std::int64_t millidegrees) {
+        return Temperature(static_cast<std::int32_t>(temperature_detail::DivideRounded(millidegrees, 1000 / scale)));
+    }
+    static constexpr Temperature FromFahrenheit(std::int32_t degrees) {
+        return Temperature(static_cast<std::int32_t>(
+                temperature_detail::DivideRounded((std::int64_t(degrees) - 32) * 50, 9)));
+    }
+    static constexpr Temperature FromDeciFahrenheit(std::int32_t tenths) {
+        return Temperature(static_cast<std::int32_t>(
+                temperature_detail::DivideRounded((std::int64_t(tenths) - 320) * 5, 9)));
+    }
+    static constexpr Temperature FromCelsiusRounded(double degrees) {
+        double tenths = degrees * scale;
+        return Temperature(static_cast<std::int32_t>(tenths >= 0 ? tenths + 0.5 : tenths - 0.5));
+    }
+
+    // Lowest and highest representable temperatures, e.g. to disarm a threshold.
+    static constexpr Temperature Lowest() { return Temperature(std::numeric_limits<std::int32_t>::min()); }
+    static constexpr Temperature Highest() { return Temperature(std::numeric_limits<std::int32_t>::max()); }
+
+    constexpr std::int32_t DeciCelsius() const { return this->deciCelsius; }
+    constexpr std::int32_t Celsius() const {
+        return static_cast<std::int32_t>(temperature_detail::DivideRounded(this->deciCelsius, scale));
+    }
+    constexpr std::int32_t MilliCelsius() const { return this->deciCelsius * (1000 / scale); }
+    constexpr std::int32_t Fahrenheit() const {
+        return static_cast<std::int32_t>(
+                temperature_detail::DivideRounded(std::int64_t(this->deciCelsius) * 9 + 1600, 50));
+    }
+    constexpr std::int32_t DeciFahrenheit() const {
+        return static_cast<std::int32_t>(
+                temperature_detail::DivideRounded(std::int64_t(this->deciCelsius) * 9, 5) + 320);
+    }
+    constexpr double ToCelsius() const { return static_cast<double>(this->deciCelsius) / scale; }
+
+    friend constexpr bool operator==(Temperature, Temperature) = default;
+    friend constexpr auto operator<=>(Temperature, Temperature) = default;
+
+    // Temperature differences are temperatures too, e.g. the width of a deadband.
+    friend constexpr Temperature operator+(Temperature a, Temperature b) {
+        return Temperature(a.deciCelsius + b.deciCelsius);
+    }
+    friend constexpr Temperature operator-(Temperature a, Temperature b) {
+        return Temperature(a.deciCelsius - b.deciCelsius);
+    }
+    friend constexpr Temperature operator-(Temperature a) { return Temperature(-a.deciCelsius); }
+    constexpr Temperature &operator+=(Temperature other) { this->deciCelsius += other.deciCelsius; return *this; }
+    constexpr Temperature &operator-=(Temperature other) { this->deciCelsius -= other.deciCelsius; return *this; }
+};
+
+static_assert(sizeof(Temperature) == sizeof(std::int32_t) && alignof(Temperature) == alignof(std::int32_t),
+              "temperatures are laid out as plain 32 bit integers");
+static_assert(std::is_trivially_copyable_v<Temperature> && std::is_standard_layout_v<Temperature>,
+              "temperatures can be copied as raw memory");
+
+/**
+ * @brief Linear calibration of an analog sensor: raw ADC counts at 0 °C and counts per degree Celsius.
+ */
+struct AdcCalibration {
+    std::int32_t zeroCounts;      // Counts read at 0 °C.
+    std::int32_t countsPerDegree; // Counts per degree Celsius, positive.
+
+    constexpr Temperature ToTemperature(std::int32_t counts) const {
+        return Temperature::FromDeciCelsius(static_cast<std::int32_t>(temperature_detail::DivideRounded(
+                (std::int64_t(counts) - this->zeroCounts) * Temperature::scale, this->countsPerDegree)));
+    }
+
+    constexpr std::int32_t ToCounts(Temperature temperature) const {
+        return this->zeroCounts + static_cast<std::int32_t>(temperature_detail::DivideRounded(
+                std::int64_t(temperature.DeciCelsius()) * this->countsPerDegree, Temperature::scale));
+    }
+};
+
+/**
+ * @brief Temperature literals: 21_degC, 20.5_degC, 70_degF.
+ */
+namespace temperature_literals {
+
+consteval Temperature operator""_degC(unsigned long long degrees) {
+    return Temperature::FromCelsius(static_cast<std::int32_t>(degrees));
+}
+
+consteval Temperature operator""_degC(long double degrees) {
+    return Temperature::FromCelsiusRounded(static_cast<double>(degrees));
+}
+
+consteval Temperature operator""_degF(unsigned long long degrees) {
+    return Temperature::FromFahrenheit(static_cast<std::int32_t>(degrees));
+}
+
+consteval Temperature operator""_degF(long double degrees) {
+    long double tenths = degrees * 10;
+    return Temperature::FromDeciFahrenheit(static_cast<std::int32_t>(tenths >= 0 ? tenths + 0.5L : tenths - 0.5L));
+}
+
+} // namespace temperature_literals
+
+#endif //_TEMPERATURE_H_
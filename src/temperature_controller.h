@@ -19,6 +19,28 @@ public:
      * @param: on True to start cooling, false to stop. 
      */
     virtual void Cool(bool on) = 0;
+    /**
+     * Puts the controller in the given heating and cooling state. The default implementation issues one Heat and
+     * one Cool write, switching on before switching off. Controllers that can change both in a single transition
+     * should override it together with SupportsModeTransition.
+     * @param: heat True to heat the room, false to stop heating.
+     * @param: cool True to cool the room, false to stop cooling.
+     */
+    virtual void SetMode(bool heat, bool cool) {
+        if (cool) {
+            this->Cool(true);
+            this->Heat(heat);
+        }
+        else {
+            this->Heat(heat);
+            this->Cool(false);
+        }
+    }
+    /**
+     * Tells whether SetMode changes both heating and cooling in a single transition.
+     * @return: True if SetMode is a single write to the hardware, false if it is a Heat and a Cool write.
+     */
+    virtual bool SupportsModeTransition() const { return false; }
 };
 
 #endif //_TEMPERATURE_CONTROLLER_H_
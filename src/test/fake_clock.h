@@ -0,0 +1,22 @@
+#ifndef _FAKE_CLOCK_H_
+#define _FAKE_CLOCK_H_
+
+#include <chrono>
+
+/**
+ * @brief Clock that only moves when the test advances it.
+ */
+struct FakeClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static inline time_point current{};
+
+    static time_point now() { return current; }
+    static void Advance(duration step) { current += step; }
+};
+
+#endif //_FAKE_CLOCK_H_
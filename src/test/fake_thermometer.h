@@ -0,0 +1,48 @@
+#ifndef _FAKE_THERMOMETER_H_
+#define _FAKE_THERMOMETER_H_
+
+#include "../thermometer.h"
+
+/**
+ * @brief Thermometer whose temperature is set by the test. Notifies the registered callback when the temperature
+ *        crosses either threshold, as described by the Thermometer interface.
+ */
+class FakeThermometer: public Thermometer {
+public:
+    Temperature temperature = Temperature::FromCelsius(20);
+    Temperature high;
+    Temperature low;
+    TemperatureCallback callback;
+
+    Temperature GetTemperature() const override { return this->temperature; }
+
+    bool SetTemperatureThresholds(Temperature newHigh, Temperature newLow) override {
+        if (newLow >= newHigh) {
+            return false;
+        }
+        this->high = newHigh;
+        this->low = newLow;
+        this->Notify(this->temperature);
+        return true;
+    }
+
+    void RegisterCallback(TemperatureCallback cb) override { this->callback = cb; }
+
+    // Changes the temperature, firing the callback if a threshold is crossed.
+    void SetTemperature(Temperature temp) {
+        Temperature previous = this->temperature;
+        this->temperature = temp;
+        if ((temp > this->high && previous <= this->high) || (temp < this->low && previous >= this->low)) {
+            this->Notify(temp);
+        }
+    }
+
+private:
+    void Notify(Temperature temp) {
+        if (this->callback && (temp > this->high || temp < this->low)) {
+            this->callback(temp > this->high);
+        }
+    }
+};
+
+#endif //_FAKE_THERMOMETER_H_
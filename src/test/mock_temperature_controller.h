@@ -5,3 +5,11 @@ public:
     MOCK_METHOD(void, Heat, (bool on), (override));
     MOCK_METHOD(void, Cool, (bool on), (override));
 };
+
+class MockModeTemperatureController: public TemperatureController {
+public:
+    MOCK_METHOD(void, Heat, (bool on), (override));
+    MOCK_METHOD(void, Cool, (bool on), (override));
+    MOCK_METHOD(void, SetMode, (bool heat, bool cool), (override));
+    bool SupportsModeTransition() const override { return true; }
+};
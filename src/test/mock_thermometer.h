@@ -3,7 +3,7 @@
 class MockThermometer: public Thermometer {
 public:
 
-    MOCK_METHOD(int, GetTemperature, (), (const, override));
-    MOCK_METHOD(bool, SetTemperatureThresholds, (int high, int low), (override));
-    MOCK_METHOD(void, RegisterCallback, (std::function<void (bool)> callback), (override));
+    MOCK_METHOD(Temperature, GetTemperature, (), (const, override));
+    MOCK_METHOD(bool, SetTemperatureThresholds, (Temperature high, Temperature low), (override));
+    MOCK_METHOD(void, RegisterCallback, (TemperatureCallback callback), (override));
 };
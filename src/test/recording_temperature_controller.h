@@ -0,0 +1,19 @@
+#ifndef _RECORDING_TEMPERATURE_CONTROLLER_H_
+#define _RECORDING_TEMPERATURE_CONTROLLER_H_
+
+#include "../temperature_controller.h"
+
+/**
+ * @brief Temperature controller that records the state it was last put in and how many writes it received.
+ */
+class RecordingTemperatureController: public TemperatureController {
+public:
+    bool heating = false;
+    bool cooling = false;
+    int writes = 0;
+
+    void Heat(bool on) override { this->heating = on; ++this->writes; }
+    void Cool(bool on) override { this->cooling = on; ++this->writes; }
+};
+
+#endif //_RECORDING_TEMPERATURE_CONTROLLER_H_
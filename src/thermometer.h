@@ -1,7 +1,14 @@
 #ifndef _THERMOMETER_H_
 #define _THERMOMETER_H_
 
-#include <functional>
+#include "inplace_function.h"
+#include "temperature.h"
+
+/**
+ * @brief Callback notified by a thermometer when a threshold is crossed, with true for the high threshold. Stored in
+ *        place, so registering and calling it never allocates.
+ */
+using TemperatureCallback = InplaceFunction<void (bool)>;
 
 /**
  * @brief Thermometer class that represents a thermometer component. Just as a basis to build a thermostat.
@@ -16,7 +23,7 @@ public:
      * @brief Reads the currentn temperature and returns the value read.
      * @return The value of the current temperature. 
      */
-    virtual int GetTemperature() const = 0;
+    virtual Temperature GetTemperature() const = 0;
 
     /**
      * @brief Configures new values for high and low temperature thresholds. If the current temperature
@@ -25,14 +32,14 @@ public:
      * @param low the new low temperature threshold. If lower than the min measurable temperature, the min is used.
      * @ret   True if the setting is accepted (low < high), false otherwise
      */
-    virtual bool SetTemperatureThresholds(int high, int low) = 0;
+    virtual bool SetTemperatureThresholds(Temperature high, Temperature low) = 0;
 
     /**
      * @brief Configures a callback to be called when the temperature raises above the high threshold or below the low
      *        threshold.
      * @param callback A function that will be called whenever the temperature exceeds either threshold.
      */
-    virtual void RegisterCallback(std::function<void (bool)> callback) = 0;
+    virtual void RegisterCallback(TemperatureCallback callback) = 0;
 };
 
 #endif //_THERMOMETER_H_
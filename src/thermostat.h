@@ -1,16 +1,76 @@
 #ifndef _THERMOSTAT_H_
 #define _THERMOSTAT_H_
 
-#include <functional>
+#include <atomic>
+#include <chrono>
+#include <concepts>
 #include <gtest/gtest_prod.h>
+#include "control_loop.h"
+#include "control_strategy.h"
 #include "thermometer.h"
+#include "telemetry_log.h"
+#include "temperature.h"
 #include "temperature_controller.h"
+#include "thermostat_metrics.h"
+#include "thermostat_snapshot.h"
+
+/**
+ * @brief Archetype of the callable a thermostat registers with its thermometer. Only used to state the
+ *        TemperatureSensor requirements; thermometers must accept any small copyable callable invocable with a bool.
+ */
+struct ThresholdCallbackArchetype {
+    void *context;
+    void operator()(bool isHigh) const;
+};
+
+/**
+ * @brief Requirements on the thermometer used by BasicThermostat. Thermometer satisfies it through virtual calls,
+ *        concrete drivers satisfy it with plain member functions so that calls can be inlined.
+ */
+template <typename T>
+concept TemperatureSensor = requires(T &meter, const T &constMeter, Temperature temperature,
+                                     ThresholdCallbackArchetype cb) {
+    { constMeter.GetTemperature() } -> std::convertible_to<Temperature>;
+    { meter.SetTemperatureThresholds(temperature, temperature) } -> std::convertible_to<bool>;
+    meter.RegisterCallback(cb);
+};
+
+/**
+ * @brief Requirements on the temperature controller used by BasicThermostat.
+ */
+template <typename T>
+concept HeatingCoolingActuator = requires(T &controller, bool on) {
+    controller.Heat(on);
+    controller.Cool(on);
+};
+
+/**
+ * @brief How the thermostat decides to heat or cool the room.
+ */
+enum class ControlMode {
+    Threshold, // Heat below the low threshold and cool above the high threshold, until the opposite alarm fires.
+    Deadband,  // Heat or cool once the temperature leaves a band around a setpoint, and stop at the setpoint.
+};
+
+/**
+ * @brief Tag selecting the thermostat constructors that leave the thermometer untouched. The thermostat is then
+ *        started in two steps, ConfigureThermometer and Activate, e.g. to overlap the startup of many zones.
+ */
+struct DeferredStart {};
+inline constexpr DeferredStart deferredStart{};
 
 /**
  * @brief Thermostat class receives temperature updates from the thermometer, and controls the temperature controller
  *        in order to adjust the temperature of the room.
+ *
+ *        The thermometer and controller types are template parameters so that concrete drivers are called
+ *        directly. Thermostat is the instantiation over the abstract Thermometer and TemperatureController
+ *        interfaces. The clock is used to enforce the minimum dwell time of the deadband mode. The metrics record
+ *        the hot path counters and latencies returned by GetMetrics; NullThermostatMetrics compiles them away.
  */
-class Thermostat {
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock = std::chrono::steady_clock,
+          typename Metrics = DefaultThermostatMetrics>
+class BasicThermostat {
 private:
 
     //TODO: Not a good practice to add test classes as friend. Design another way to allow test cases to simulate thermometer callbacks.
@@ -20,42 +80,551 @@ private:
     FRIEND_TEST(ThermostatUnit, ReenableThermostat);
     FRIEND_TEST(ThermostatUnit, HeatAndCoolSequence);
 
-    Thermometer &thermometer; // Stores a reference to the thermometer that provides the room temperature info.
-    TemperatureController &tempController; // Stores a reference to the temperature controller, that allows the 
-                                          // room to be heated or cooled.
-    int highTemperatureThreshold; // Stores the maximum desired temperature within the room.
-    int lowTemperatureThreshold;  // Stores the minimum desired temperature within the room.
-    bool isOn; // Store whether the thermostat should be on and controlling the room temperature. 
+    // Callable registered with the thermometer. Holds only a pointer to the thermostat, so it needs no storage
+    // beyond the callable itself and the call to ThermometerCallback can be inlined.
+    struct ThresholdCallback {
+        BasicThermostat *thermostat;
+        void operator()(bool isHigh) const { this->thermostat->ThermometerCallback(isHigh); }
+    };
+
+    // Callable registered with the thermometer in threaded mode. Only queues the notification for the control loop.
+    struct QueuedThresholdCallback {
+        BasicThermostat *thermostat;
+        void operator()(bool isHigh) const {
+            this->thermostat->controlLoop->Post(&BasicThermostat::HandleThermometerEvent, this->thermostat, isHigh);
+        }
+    };
+
+    Meter &thermometer; // Stores a reference to the thermometer that provides the room temperature info.
+    Controller &tempController; // Stores a reference to the temperature controller, that allows the
+                                // room to be heated or cooled.
+    std::atomic<Temperature> highTemperatureThreshold; // Stores the maximum desired temperature within the room.
+    std::atomic<Temperature> lowTemperatureThreshold;  // Stores the minimum desired temperature within the room.
+    std::atomic<bool> isOn; // Store whether the thermostat should be on and controlling the room temperature.
+    ControlLoop *controlLoop; // Control loop running the decisions in threaded mode, null otherwise.
+    std::atomic<ControlMode> mode; // Stores how the thermostat decides to heat or cool the room.
+    Temperature setpoint; // Stores the desired temperature in deadband mode.
+    Temperature deadband; // Stores how far the temperature may drift from the setpoint before acting, in deadband mode.
+    typename Clock::duration minimumDwell; // Stores the minimum time between two actuator transitions, in deadband mode.
+    typename Clock::time_point lastTransition; // Stores when the actuators last changed state, in deadband mode.
+    bool transitionDeferred; // Set when a deadband transition was held back by the minimum dwell time.
+    bool heating; // Stores whether the temperature controller was last asked to heat.
+    bool cooling; // Stores whether the temperature controller was last asked to cool.
+    [[no_unique_address]] Metrics metrics; // Counters and latencies of the hot paths, empty when metrics are disabled.
+    TelemetryLog *telemetry; // Log receiving every event of the thermostat, null if none is attached.
+    std::uint32_t telemetryId; // Identifies the thermostat in the telemetry log.
+    Temperature lastReading; // Stores the last temperature read from the thermometer.
+    bool restoring; // Set while a restored thermostat re-arms its thermometer.
 
     // Callback used to receive notification from the thermometer class when the temperature thresholds are breached.
     void ThermometerCallback(bool isHigh);
 
-    // Assistant function to facilitate code reuse. Checks the temperature from the thermometer and activates the 
+    // Decision logic of each mode, over the current settings.
+    OnOffStrategy OnOff() const { return OnOffStrategy{this->highTemperatureThreshold, this->lowTemperatureThreshold}; }
+    DeadbandStrategy Deadband() const { return DeadbandStrategy{this->setpoint, this->deadband}; }
+    ActuatorState CurrentState() const { return ActuatorState{this->heating, this->cooling}; }
+
+    // Sends a heating and cooling decision to the temperature controller, as a single mode transition if the
+    // controller offers one.
+    void Actuate(bool heat, bool cool);
+
+    // Assistant function to facilitate code reuse. Checks the temperature from the thermometer and activates the
     // temperature controller if the temperature is outside the high-low threshold boundary conditions.
     void CheckTemperatureAndActManually();
+
+    // Same as CheckTemperatureAndActManually, with a temperature already read from the thermometer.
+    void ActOnTemperature(Temperature temp);
+
+    // Deadband mode counterparts of ThermometerCallback and ActOnTemperature. The manual check writes the
+    // actuators even if their state is unchanged when force is set.
+    void DeadbandCallback(bool isHigh);
+    void CheckDeadbandManually(Temperature temp, bool force);
+
+    // Moves to the given deadband state unless the minimum dwell time forbids it, and arms the thermometer
+    // thresholds for that state.
+    void DeadbandTransition(bool heat, bool cool, bool force);
+
+    // Appends an event to the telemetry log, if one is attached. Temperatures are recorded in tenths of a degree.
+    void Record(TelemetryEvent event, int first, int second);
+
+    // Sends thresholds to the thermometer.
+    bool ApplyThresholds(Temperature high, Temperature low);
+
+    // Configures the thermometer so that it only notifies the thermostat when the deadband state must change.
+    void ArmDeadbandThresholds();
+
+    // Applies a deadband transition deferred by the minimum dwell time, once the dwell time has elapsed.
+    void ApplyDeferredTransition();
+
+    // Control loop handlers, run on the control thread in threaded mode.
+    static void HandleThermometerEvent(void *context, bool isHigh);
+    static void HandleEnableEvent(void *context, bool on);
+    static void HandlePollEvent(void *context, bool unused);
+
+    // Common part of the constructors: initializes the members without touching the thermometer.
+    BasicThermostat(Meter &therm, Controller &tempCon, ControlLoop *loop, DeferredStart);
 public:
     /**
      * @brief Creates a Thermostat object with references to a thermometer and a temperature controller.
-              This constructor attributes default values for the temperature thresholds and enables the 
+              This constructor attributes default values for the temperature thresholds and enables the
               thermostat.
      * @param therm the Thermometer to use when reading or receiving information on the temperature of the room.
      * @param tempCon the TemperatureController to use when heating or cooling a room.
      */
-    Thermostat(Thermometer &therm, TemperatureController &tempCon); 
+    BasicThermostat(Meter &therm, Controller &tempCon);
+
+    /**
+     * @brief Creates a Thermostat object in threaded mode. Thermometer callbacks only queue an event in the control
+     *        loop, and the temperature controller is driven from the control loop thread. The control loop must
+     *        outlive the thermostat, and must be idle or stopped before the thermostat is destroyed.
+     * @param therm the Thermometer to use when reading or receiving information on the temperature of the room.
+     * @param tempCon the TemperatureController to use when heating or cooling a room.
+     * @param loop the ControlLoop that runs the thermostat decisions.
+     */
+    BasicThermostat(Meter &therm, Controller &tempCon, ControlLoop &loop);
+
+    /**
+     * @brief Creates a disabled Thermostat object without configuring or reading the thermometer. Start it by
+     *        calling ConfigureThermometer, then Activate with a first reading of the thermometer.
+     * @param therm the Thermometer to use when reading or receiving information on the temperature of the room.
+     * @param tempCon the TemperatureController to use when heating or cooling a room.
+     */
+    BasicThermostat(Meter &therm, Controller &tempCon, DeferredStart);
 
     /**
-     * @brief Configures a new threshold for the maximum and minimum desired temperatures in the room.
-     * @param high The new high temperature threshold. 
+     * @brief Threaded mode counterpart of the deferred start constructor.
+     * @param therm the Thermometer to use when reading or receiving information on the temperature of the room.
+     * @param tempCon the TemperatureController to use when heating or cooling a room.
+     * @param loop the ControlLoop that runs the thermostat decisions.
+     */
+    BasicThermostat(Meter &therm, Controller &tempCon, ControlLoop &loop, DeferredStart);
+
+    /**
+     * @brief Restores a Thermostat object from a state saved by SaveState, e.g. after a process restart. The
+     *        thermometer is not read: the callback is registered first, then the saved thresholds are set, so only a
+     *        threshold already exceeded notifies the thermostat. The temperature controller is assumed to still be in
+     *        the saved state, and is only written if a notification calls for a different state.
+     * @param therm the Thermometer to use when reading or receiving information on the temperature of the room.
+     * @param tempCon the TemperatureController to use when heating or cooling a room.
+     * @param state The saved state.
+     */
+    BasicThermostat(Meter &therm, Controller &tempCon, const ThermostatState &state);
+
+    // The thermometer keeps a pointer to this object in its callback, so it must not be copied or moved.
+    BasicThermostat(const BasicThermostat &) = delete;
+    BasicThermostat &operator=(const BasicThermostat &) = delete;
+
+    /**
+     * @brief Configures a new threshold for the maximum and minimum desired temperatures in the room, and returns
+     *        to threshold mode. May be called from any thread. In threaded mode, leave deadband mode while the control
+     *        loop is idle: a deadband notification still queued would re-arm the deadband thresholds.
+     * @param high The new high temperature threshold.
      * @param low  The new low temperature threshold.
      * @ret   True if the thresholds are valid (low < high), false otherwise.
      */
-    bool SetTemperatureThresholds(int high, int low);
+    bool SetTemperatureThresholds(Temperature high, Temperature low);
+
+    /**
+     * @brief First step of a deferred start: sends the default thresholds to the thermometer and registers the
+     *        thermostat callback. Notifications received before Activate are ignored.
+     */
+    void ConfigureThermometer();
+
+    /**
+     * @brief Second step of a deferred start: acts on the first reading of the thermometer and enables the
+     *        thermostat. The reading must have been taken after ConfigureThermometer, so that no crossing is missed.
+     * @param firstReading The temperature read from the thermometer.
+     */
+    void Activate(Temperature firstReading);
+
+    /**
+     * @brief Switches the thermostat to deadband mode. The thermostat heats when the temperature falls below
+     *        setpoint - band and cools when it rises above setpoint + band, and in both cases stops once the
+     *        setpoint is reached. The thermometer thresholds are re-armed around the current state so the
+     *        thermometer only notifies the thermostat when the state must change. Calling SetTemperatureThresholds
+     *        returns to threshold mode.
+     *        In threaded mode, change the mode while the control loop is idle.
+     * @param target The desired temperature.
+     * @param band   How far the temperature may drift from the setpoint before heating or cooling.
+     * @param minDwell The minimum time between two actuator transitions. A transition requested earlier is
+     *                 deferred until Poll is called after the dwell time has elapsed.
+     * @ret   True if the band is valid (band > 0), false otherwise.
+     */
+    bool SetDeadbandMode(Temperature target, Temperature band, typename Clock::duration minDwell = {});
+
+    /**
+     * @brief Applies a deadband transition that was deferred by the minimum dwell time, if the dwell time has
+     *        elapsed. Call periodically when a minimum dwell time is configured.
+     */
+    void Poll();
 
     /**
      * @brief Controls whether the thermostat is enabled and controlling the room temperature.
      * @param on True - enables the thermostat, False - disables the thermostat.
      */
     void EnableThermostat(bool on);
+
+    /**
+     * @brief Returns the thermostat metrics: callback, actuator and threshold update counts and latency histograms.
+     *        Lock-free, may be called from any thread. All values are zero when metrics are disabled.
+     */
+    ThermostatMetricsSnapshot GetMetrics() const;
+
+    /**
+     * @brief Records every reading, thermometer notification, threshold change, enable toggle and actuator
+     *        decision of the thermostat in a telemetry log. Attach before the thermometer starts notifying, or
+     *        while the control loop is idle in threaded mode.
+     * @param log The open log to append to, or null to stop recording. Must outlive the thermostat or be detached.
+     * @param id Identifies the thermostat in the log records.
+     */
+    void AttachTelemetry(TelemetryLog *log, std::uint32_t id);
+
+    /**
+     * @brief Returns the runtime state of the thermostat, to be restored after a restart. In threaded mode, call
+     *        while the control loop is idle.
+     */
+    ThermostatState SaveState() const;
 };
 
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller, ControlLoop *loop, DeferredStart):
+        thermometer(meter),
+        tempController(controller),
+        highTemperatureThreshold(Temperature::FromCelsius(40)),
+        lowTemperatureThreshold(Temperature::FromCelsius(10)),
+        isOn(false),
+        controlLoop(loop),
+        mode(ControlMode::Threshold),
+        setpoint(),
+        deadband(),
+        minimumDwell(),
+        lastTransition(),
+        transitionDeferred(false),
+        heating(false),
+        cooling(false),
+        telemetry(nullptr),
+        telemetryId(0),
+        lastReading(),
+        restoring(false) {
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller):
+        BasicThermostat(meter, controller, nullptr, deferredStart) {
+    this->ConfigureThermometer();
+    // First check of temperature needs to be manual, as the callback wasn't registered when the thresholds were set.
+    this->Activate(this->thermometer.GetTemperature());
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller, ControlLoop &loop):
+        BasicThermostat(meter, controller, &loop, deferredStart) {
+    this->ConfigureThermometer();
+    // Events queued before the thermostat is enabled are ignored by the control thread, so the first check can
+    // still run here.
+    this->Activate(this->thermometer.GetTemperature());
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller, DeferredStart):
+        BasicThermostat(meter, controller, nullptr, deferredStart) {
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller, ControlLoop &loop, DeferredStart):
+        BasicThermostat(meter, controller, &loop, deferredStart) {
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+BasicThermostat<Meter, Controller, Clock, Metrics>::BasicThermostat(Meter &meter, Controller &controller, const ThermostatState &state):
+        BasicThermostat(meter, controller, nullptr, deferredStart) {
+    this->highTemperatureThreshold.store(state.highTemperatureThreshold, std::memory_order_relaxed);
+    this->lowTemperatureThreshold.store(state.lowTemperatureThreshold, std::memory_order_relaxed);
+    this->mode.store(state.mode == 1 ? ControlMode::Deadband : ControlMode::Threshold, std::memory_order_relaxed);
+    this->setpoint = state.setpoint;
+    this->deadband = state.deadband;
+    this->minimumDwell = std::chrono::duration_cast<typename Clock::duration>(
+            std::chrono::nanoseconds(state.minimumDwell));
+    this->lastTransition = Clock::now() - this->minimumDwell;
+    this->heating = state.heating != 0;
+    this->cooling = state.cooling != 0;
+    this->lastReading = state.lastReading;
+    this->isOn.store(state.on != 0, std::memory_order_release);
+
+    // Register the callback before setting the thresholds, so that a threshold exceeded while the thermostat was
+    // down corrects the restored state.
+    this->restoring = true;
+    this->thermometer.RegisterCallback(ThresholdCallback{this});
+    if (this->mode.load(std::memory_order_acquire) == ControlMode::Deadband) {
+        this->ArmDeadbandThresholds();
+    }
+    else {
+        this->ApplyThresholds(state.highTemperatureThreshold, state.lowTemperatureThreshold);
+    }
+    this->restoring = false;
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::ConfigureThermometer() {
+    // Set thresholds before registering the callback to ensure no spurious callback is triggered.
+    this->ApplyThresholds(this->highTemperatureThreshold, this->lowTemperatureThreshold);
+    if (this->controlLoop != nullptr) {
+        this->thermometer.RegisterCallback(QueuedThresholdCallback{this});
+    }
+    else {
+        this->thermometer.RegisterCallback(ThresholdCallback{this});
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::Activate(Temperature firstReading) {
+    this->ActOnTemperature(firstReading);
+    this->isOn.store(true, std::memory_order_release);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::ThermometerCallback(bool isHigh) {
+    // Only take action if the thermostat is enabled
+    // TODO: Check if thermometer allows callback to be de-registered
+    bool on = this->isOn.load(std::memory_order_acquire);
+    this->Record(TelemetryEvent::Alarm, isHigh, on);
+    if (on) {
+        typename Metrics::TimePoint start = this->metrics.StartCallback();
+        if (this->mode.load(std::memory_order_acquire) == ControlMode::Deadband) {
+            this->DeadbandCallback(isHigh);
+        }
+        else {
+            ActuatorState next = this->OnOff().OnCrossing(isHigh, this->CurrentState());
+            // A restored thermostat only writes the actuators when the restored state is wrong.
+            if (!this->restoring || next != this->CurrentState()) {
+                this->Actuate(next.heat, next.cool);
+            }
+        }
+        this->metrics.OnCallback(start);
+    }
+    else {
+        this->metrics.OnIgnoredCallback();
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+bool BasicThermostat<Meter, Controller, Clock, Metrics>::SetTemperatureThresholds(Temperature high, Temperature low) {
+    bool ret = false;
+    // Only take action if the thresholds are valid
+    if (high > low) {
+        // Switch modes before arming the thermometer: it may notify at once if the reading is already outside the
+        // new thresholds, and that notification must be handled in threshold mode.
+        this->highTemperatureThreshold = high;
+        this->lowTemperatureThreshold = low;
+        this->mode.store(ControlMode::Threshold, std::memory_order_release);
+        this->ApplyThresholds(high, low);
+        ret = true;
+    }
+    return ret;
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+bool BasicThermostat<Meter, Controller, Clock, Metrics>::SetDeadbandMode(Temperature target, Temperature band,
+                                                                         typename Clock::duration minDwell) {
+    bool ret = false;
+    // Only take action if the band is valid
+    if (band > Temperature()) {
+        this->setpoint = target;
+        this->deadband = band;
+        this->minimumDwell = minDwell;
+        // Allow the first transition straight away.
+        this->lastTransition = Clock::now() - minDwell;
+        this->transitionDeferred = false;
+        this->mode.store(ControlMode::Deadband, std::memory_order_release);
+        if (this->isOn.load(std::memory_order_acquire)) {
+            if (this->controlLoop != nullptr) {
+                this->controlLoop->Send(&BasicThermostat::HandleEnableEvent, this, true);
+            }
+            else {
+                this->CheckTemperatureAndActManually();
+            }
+        }
+        ret = true;
+    }
+    return ret;
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::Poll() {
+    if (this->controlLoop != nullptr) {
+        this->controlLoop->Send(&BasicThermostat::HandlePollEvent, this, true);
+    }
+    else {
+        this->ApplyDeferredTransition();
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::EnableThermostat(bool on) {
+    this->Record(TelemetryEvent::Enable, on, 0);
+    this->isOn.store(on, std::memory_order_release);
+    if (on) {
+        if (this->controlLoop != nullptr) {
+            // Keep every actuator call on the control thread.
+            this->controlLoop->Send(&BasicThermostat::HandleEnableEvent, this, on);
+        }
+        else {
+            this->CheckTemperatureAndActManually();
+        }
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::HandleThermometerEvent(void *context, bool isHigh) {
+    static_cast<BasicThermostat *>(context)->ThermometerCallback(isHigh);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::HandleEnableEvent(void *context, bool on) {
+    BasicThermostat *thermostat = static_cast<BasicThermostat *>(context);
+    // The thermostat may have been disabled again while the event was queued.
+    if (on && thermostat->isOn.load(std::memory_order_acquire)) {
+        thermostat->CheckTemperatureAndActManually();
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::HandlePollEvent(void *context, bool) {
+    static_cast<BasicThermostat *>(context)->ApplyDeferredTransition();
+}
+
+// In threshold mode, when the temperature in the room surpasses either threshold, the temperature controller is invoked and stays active until a new temperature alarm is triggered, causing then the reverse operation to be triggered from the temperature controller, in an unending cycle. Deadband mode stops heating and cooling at the setpoint instead.
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::CheckTemperatureAndActManually() {
+    this->ActOnTemperature(this->thermometer.GetTemperature());
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::ActOnTemperature(Temperature temp) {
+    this->metrics.OnManualCheck();
+    if (this->mode.load(std::memory_order_acquire) == ControlMode::Deadband) {
+        this->CheckDeadbandManually(temp, true);
+        return;
+    }
+
+    this->lastReading = temp;
+    this->Record(TelemetryEvent::Reading, temp.DeciCelsius(), 0);
+    // A manual check decides afresh: between the thresholds both actuators are switched off.
+    ActuatorState next = this->OnOff().Decide(temp, ActuatorState{false, false});
+    this->Actuate(next.heat, next.cool);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::Actuate(bool heat, bool cool) {
+    typename Metrics::TimePoint start = this->metrics.StartActuation();
+    this->Record(TelemetryEvent::Actuation, heat, cool);
+    this->heating = heat;
+    this->cooling = cool;
+    WriteActuators(this->tempController, ActuatorState{heat, cool});
+    this->metrics.OnActuation(start);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::DeadbandCallback(bool isHigh) {
+    ActuatorState next = this->Deadband().OnCrossing(isHigh, this->CurrentState());
+    // A notification of a threshold that is not armed in the current state changes nothing.
+    if (next != this->CurrentState()) {
+        this->DeadbandTransition(next.heat, next.cool, false);
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::CheckDeadbandManually(Temperature temp, bool force) {
+    this->lastReading = temp;
+    this->Record(TelemetryEvent::Reading, temp.DeciCelsius(), 0);
+    ActuatorState next = this->Deadband().Decide(temp, this->CurrentState());
+    this->DeadbandTransition(next.heat, next.cool, force);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::DeadbandTransition(bool heat, bool cool, bool force) {
+    typename Clock::time_point now = Clock::now();
+    bool changed = heat != this->heating || cool != this->cooling;
+    if (changed && !force && now - this->lastTransition < this->minimumDwell) {
+        // Too early, keep the current state until Poll is called after the dwell time.
+        this->transitionDeferred = true;
+        return;
+    }
+
+    this->transitionDeferred = false;
+    if (changed) {
+        this->lastTransition = now;
+    }
+    if (changed || force) {
+        this->Actuate(heat, cool);
+    }
+    this->ArmDeadbandThresholds();
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::ArmDeadbandThresholds() {
+    ArmedThresholds thresholds = this->Deadband().Thresholds(this->CurrentState());
+    this->ApplyThresholds(thresholds.high, thresholds.low);
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+bool BasicThermostat<Meter, Controller, Clock, Metrics>::ApplyThresholds(Temperature high, Temperature low) {
+    typename Metrics::TimePoint start = this->metrics.StartThresholdUpdate();
+    this->Record(TelemetryEvent::Thresholds, high.DeciCelsius(), low.DeciCelsius());
+    bool ret = this->thermometer.SetTemperatureThresholds(high, low);
+    this->metrics.OnThresholdUpdate(start);
+    return ret;
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::ApplyDeferredTransition() {
+    if (this->isOn.load(std::memory_order_acquire) &&
+            this->mode.load(std::memory_order_acquire) == ControlMode::Deadband && this->transitionDeferred &&
+            Clock::now() - this->lastTransition >= this->minimumDwell) {
+        this->CheckDeadbandManually(this->thermometer.GetTemperature(), false);
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::Record(TelemetryEvent event, int first, int second) {
+    if (this->telemetry != nullptr) {
+        this->telemetry->Append(this->telemetryId, event, first, second);
+    }
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+void BasicThermostat<Meter, Controller, Clock, Metrics>::AttachTelemetry(TelemetryLog *log, std::uint32_t id) {
+    this->telemetry = log;
+    this->telemetryId = id;
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+ThermostatMetricsSnapshot BasicThermostat<Meter, Controller, Clock, Metrics>::GetMetrics() const {
+    return this->metrics.Snapshot();
+}
+
+template <TemperatureSensor Meter, HeatingCoolingActuator Controller, typename Clock, typename Metrics>
+ThermostatState BasicThermostat<Meter, Controller, Clock, Metrics>::SaveState() const {
+    ThermostatState state{};
+    state.highTemperatureThreshold = this->highTemperatureThreshold.load(std::memory_order_relaxed);
+    state.lowTemperatureThreshold = this->lowTemperatureThreshold.load(std::memory_order_relaxed);
+    state.setpoint = this->setpoint;
+    state.deadband = this->deadband;
+    state.lastReading = this->lastReading;
+    state.mode = this->mode.load(std::memory_order_acquire) == ControlMode::Deadband ? 1 : 0;
+    state.on = this->isOn.load(std::memory_order_acquire) ? 1 : 0;
+    state.heating = this->heating ? 1 : 0;
+    state.cooling = this->cooling ? 1 : 0;
+    state.minimumDwell = std::chrono::duration_cast<std::chrono::nanoseconds>(this->minimumDwell).count();
+    return state;
+}
+
+// Thermostat over the abstract interfaces is instantiated once, in thermostat.cc.
+extern template class BasicThermostat<Thermometer, TemperatureController>;
+
+/**
+ * @brief Thermostat over the abstract Thermometer and TemperatureController interfaces.
+ */
+using Thermostat = BasicThermostat<Thermometer, TemperatureController>;
+
 #endif //_THERMOSTAT_H_
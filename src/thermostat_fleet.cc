@@ -0,0 +1,106 @@
+#include "thermostat_fleet.h"
+
+ThermostatFleet::ZoneId ThermostatFleet::AddZone(Temperature initialTemperature) {
+    const ZoneId zone = static_cast<ZoneId>(this->Size());
+    this->highTemperatureThreshold.push_back(Temperature::FromCelsius(40));
+    this->lowTemperatureThreshold.push_back(Temperature::FromCelsius(10));
+    this->lastReading.push_back(initialTemperature);
+    this->isOn.push_back(1);
+    this->heating.push_back(0);
+    this->cooling.push_back(0);
+    // The constructor of Thermostat always checks the temperature and writes both actuators.
+    this->readingPending.push_back(1);
+    this->writePending.push_back(1);
+    this->changed.push_back(0);
+    return zone;
+}
+
+void ThermostatFleet::Reserve(std::size_t zones) {
+    this->highTemperatureThreshold.reserve(zones);
+    this->lowTemperatureThreshold.reserve(zones);
+    this->lastReading.reserve(zones);
+    this->isOn.reserve(zones);
+    this->heating.reserve(zones);
+    this->cooling.reserve(zones);
+    this->readingPending.reserve(zones);
+    this->writePending.reserve(zones);
+    this->changed.reserve(zones);
+}
+
+bool ThermostatFleet::SetTemperatureThresholds(ZoneId zone, Temperature high, Temperature low) {
+    bool ret = false;
+    // Only take action if the thresholds are valid
+    if (high > low) {
+        this->highTemperatureThreshold[zone] = high;
+        this->lowTemperatureThreshold[zone] = low;
+        ret = true;
+    }
+    return ret;
+}
+
+void ThermostatFleet::EnableZone(ZoneId zone, bool on) {
+    this->isOn[zone] = on;
+    if (on) {
+        this->readingPending[zone] = 1;
+        this->writePending[zone] = 1;
+    }
+}
+
+void ThermostatFleet::SetReading(ZoneId zone, Temperature temperature) {
+    this->lastReading[zone] = temperature;
+    this->readingPending[zone] = 1;
+}
+
+void ThermostatFleet::SetReadings(const Temperature *temperatures, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        this->lastReading[i] = temperatures[i];
+        this->readingPending[i] = 1;
+    }
+}
+
+void ThermostatFleet::ThermometerCallback(ZoneId zone, bool isHigh) {
+    // Only take action if the zone is enabled
+    if (this->isOn[zone]) {
+        this->heating[zone] = !isHigh;
+        this->cooling[zone] = isHigh;
+        // The notification supersedes any reading that was not evaluated yet.
+        this->readingPending[zone] = 0;
+        this->writePending[zone] = 1;
+    }
+}
+
+void ThermostatFleet::Evaluate(std::vector<ActuatorChange> &changes) {
+    const std::size_t count = this->Size();
+    const Temperature *__restrict high = this->highTemperatureThreshold.data();
+    const Temperature *__restrict low = this->lowTemperatureThreshold.data();
+    const Temperature *__restrict temp = this->lastReading.data();
+    const std::uint8_t *__restrict on = this->isOn.data();
+    std::uint8_t *__restrict heat = this->heating.data();
+    std::uint8_t *__restrict cool = this->cooling.data();
+    std::uint8_t *__restrict readPending = this->readingPending.data();
+    std::uint8_t *__restrict forced = this->writePending.data();
+    std::uint8_t *__restrict out = this->changed.data();
+
+    // Decision kernel. Same logic as Thermostat::CheckTemperatureAndActManually, expressed as masks so the loop has
+    // no data dependent branches: zones that are disabled or have no new reading keep their previous state.
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint8_t isLow = temp[i] < low[i];
+        const std::uint8_t isHigh = (temp[i] > high[i]) & (isLow ^ 1);
+        const std::uint8_t act = static_cast<std::uint8_t>(0 - (on[i] & readPending[i]));
+        const std::uint8_t newHeat = (isLow & act) | (heat[i] & ~act);
+        const std::uint8_t newCool = (isHigh & act) | (cool[i] & ~act);
+        out[i] = forced[i] | (newHeat ^ heat[i]) | (newCool ^ cool[i]);
+        heat[i] = newHeat;
+        cool[i] = newCool;
+        readPending[i] = 0;
+        forced[i] = 0;
+    }
+
+    // Compaction of the zones that need their actuators written.
+    changes.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (out[i]) {
+            changes.push_back(ActuatorChange{static_cast<ZoneId>(i), heat[i] != 0, cool[i] != 0});
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef _THERMOSTAT_FLEET_H_
+#define _THERMOSTAT_FLEET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "temperature.h"
+
+/**
+ * @brief Actuator command produced by a ThermostatFleet evaluation for a single zone. Holds the complete state that
+ *        the zone's temperature controller should be put in.
+ */
+struct ActuatorChange {
+    std::uint32_t zone; // Index of the zone, as returned by ThermostatFleet::AddZone.
+    bool heat;          // True if the zone should be heated.
+    bool cool;          // True if the zone should be cooled.
+};
+
+/**
+ * @brief ThermostatFleet evaluates the Thermostat decision logic for a large number of zones at once. Zone state is
+ *        kept in contiguous arrays (structure of arrays) so that a whole tick is a single linear pass over memory,
+ *        and the decision kernel is written with compare/select operations only so the compiler can vectorize it.
+ *
+ *        Each zone behaves like one Thermostat object: zones start enabled with 40/10 thresholds, a reading is
+ *        checked against the thresholds the same way CheckTemperatureAndActManually does, and threshold
+ *        notifications are handled the same way ThermometerCallback does. Instead of calling a
+ *        TemperatureController, Evaluate outputs the zones whose actuators must be written.
+ */
+class ThermostatFleet {
+private:
+    std::vector<Temperature> highTemperatureThreshold; // Maximum desired temperature of each zone.
+    std::vector<Temperature> lowTemperatureThreshold;  // Minimum desired temperature of each zone.
+    std::vector<Temperature> lastReading;              // Last temperature reading provided for each zone.
+    std::vector<std::uint8_t> isOn;                    // Whether each zone is enabled and controlling its temperature.
+    std::vector<std::uint8_t> heating;                 // Last heat state decided for each zone.
+    std::vector<std::uint8_t> cooling;                 // Last cool state decided for each zone.
+    std::vector<std::uint8_t> readingPending;          // Set when a reading must be checked against the thresholds.
+    std::vector<std::uint8_t> writePending;            // Set when the actuators must be written even if unchanged.
+    std::vector<std::uint8_t> changed;                 // Scratch output of the decision kernel.
+
+public:
+    using ZoneId = std::uint32_t;
+
+    /**
+     * @brief Adds a zone to the fleet. Mirrors the Thermostat constructor: the zone is enabled, uses the default
+     *        thresholds and its initial reading is checked on the next call to Evaluate.
+     * @param initialTemperature The first temperature reading of the zone.
+     * @ret   The identifier of the new zone.
+     */
+    ZoneId AddZone(Temperature initialTemperature);
+
+    /**
+     * @brief Returns the number of zones in the fleet.
+     */
+    std::size_t Size() const { return this->isOn.size(); }
+
+    /**
+     * @brief Reserves storage for the given number of zones, to avoid reallocations while adding zones.
+     */
+    void Reserve(std::size_t zones);
+
+    /**
+     * @brief Configures a new threshold for the maximum and minimum desired temperatures of a zone.
+     * @param zone The zone to configure.
+     * @param high The new high temperature threshold.
+     * @param low  The new low temperature threshold.
+     * @ret   True if the thresholds are valid (low < high), false otherwise.
+     */
+    bool SetTemperatureThresholds(ZoneId zone, Temperature high, Temperature low);
+
+    /**
+     * @brief Controls whether a zone is enabled. Enabling a zone checks its last reading on the next call to Evaluate
+     *        and writes its actuators, as Thermostat::EnableThermostat does.
+     * @param zone The zone to enable or disable.
+     * @param on True - enables the zone, False - disables the zone.
+     */
+    void EnableZone(ZoneId zone, bool on);
+
+    /**
+     * @brief Provides a new temperature reading for a zone. The reading is checked against the zone thresholds on
+     *        the next call to Evaluate, provided the zone is enabled.
+     */
+    void SetReading(ZoneId zone, Temperature temperature);
+
+    /**
+     * @brief Provides new temperature readings for the zones [0, count).
+     */
+    void SetReadings(const Temperature *temperatures, std::size_t count);
+
+    /**
+     * @brief Notifies a zone that its thermometer threshold was breached, as Thermostat::ThermometerCallback.
+     *        The resulting actuator state is output on the next call to Evaluate.
+     * @param zone The zone whose thermometer fired.
+     * @param isHigh True if the high threshold was breached, false if the low threshold was breached.
+     */
+    void ThermometerCallback(ZoneId zone, bool isHigh);
+
+    /**
+     * @brief Runs the decision logic over all zones in a single pass.
+     * @param changes Cleared, then filled with the zones whose actuators must be written, in zone order.
+     */
+    void Evaluate(std::vector<ActuatorChange> &changes);
+
+    /**
+     * @brief Returns whether the zone is currently heating, according to the last evaluation.
+     */
+    bool IsHeating(ZoneId zone) const { return this->heating[zone] != 0; }
+
+    /**
+     * @brief Returns whether the zone is currently cooling, according to the last evaluation.
+     */
+    bool IsCooling(ZoneId zone) const { return this->cooling[zone] != 0; }
+};
+
+#endif //_THERMOSTAT_FLEET_H_
@@ -0,0 +1,209 @@
+#ifndef _THERMOSTAT_METRICS_H_
+#define _THERMOSTAT_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Copy of a LatencyHistogram taken at one point in time.
+ */
+struct LatencyHistogramSnapshot {
+    static constexpr std::size_t bucketCount = 32; // Bucket i counts latencies in [2^i, 2^(i+1)) nanoseconds, the last
+                                                   // one also counts every longer latency.
+
+    std::array<std::uint64_t, bucketCount> buckets{};
+
+    /**
+     * @brief Returns the number of recorded latencies.
+     */
+    std::uint64_t Count() const {
+        std::uint64_t total = 0;
+        for (std::uint64_t bucket : this->buckets) {
+            total += bucket;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Returns the upper bound of the bucket holding the given fraction of the recorded latencies, or zero
+     *        when nothing was recorded.
+     */
+    std::chrono::nanoseconds Percentile(double fraction) const {
+        std::uint64_t rank = static_cast<std::uint64_t>(fraction * static_cast<double>(this->Count()));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucketCount; ++i) {
+            seen += this->buckets[i];
+            if (seen > rank) {
+                return std::chrono::nanoseconds(std::int64_t(1) << (i + 1));
+            }
+        }
+        return std::chrono::nanoseconds(0);
+    }
+};
+
+/**
+ * @brief Latency histogram with fixed power of two buckets. Recording is a single relaxed atomic increment, and
+ *        snapshots can be taken from any thread without locking.
+ */
+class LatencyHistogram {
+private:
+    std::array<std::atomic<std::uint64_t>, LatencyHistogramSnapshot::bucketCount> buckets{};
+
+public:
+    void Record(std::chrono::nanoseconds latency) {
+        std::uint64_t value = latency.count() > 0 ? static_cast<std::uint64_t>(latency.count()) : 1;
+        std::size_t bucket = std::bit_width(value) - 1;
+        if (bucket >= LatencyHistogramSnapshot::bucketCount) {
+            bucket = LatencyHistogramSnapshot::bucketCount - 1;
+        }
+        this->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LatencyHistogramSnapshot Snapshot() const {
+        LatencyHistogramSnapshot snapshot;
+        for (std::size_t i = 0; i < LatencyHistogramSnapshot::bucketCount; ++i) {
+            snapshot.buckets[i] = this->buckets[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+};
+
+/**
+ * @brief Values of the thermostat metrics at one point in time.
+ */
+struct ThermostatMetricsSnapshot {
+    std::uint64_t callbacks = 0;        // Thermometer notifications received.
+    std::uint64_t ignoredCallbacks = 0; // Thermometer notifications received while the thermostat was disabled.
+    std::uint64_t manualChecks = 0;     // Temperature checks made outside of notifications (start, enable, poll).
+    std::uint64_t actuatorCalls = 0;    // Decisions sent to the temperature controller.
+    std::uint64_t thresholdUpdates = 0; // Threshold changes sent to the thermometer.
+    LatencyHistogramSnapshot callbackLatency;  // Sampled time spent handling thermometer notifications.
+    LatencyHistogramSnapshot actuatorLatency;  // Sampled time spent in the temperature controller.
+    LatencyHistogramSnapshot thresholdLatency; // Sampled time spent in the thermometer setting thresholds.
+};
+
+/**
+ * @brief Per thermostat metrics: relaxed atomic counters and latency histograms, updated on the thermostat hot
+ *        paths and read with Snapshot from any thread. Counters are exact; reading the clock costs more than the
+ *        rest of a callback, so only one event in SamplePeriod of each kind is timed.
+ */
+template <std::uint64_t SamplePeriod>
+class BasicThermostatMetrics {
+    static_assert(SamplePeriod > 0, "sample period must be positive");
+
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    static constexpr bool enabled = true;
+
+private:
+    std::atomic<std::uint64_t> callbacks{0};
+    std::atomic<std::uint64_t> ignoredCallbacks{0};
+    std::atomic<std::uint64_t> manualChecks{0};
+    std::atomic<std::uint64_t> actuatorCalls{0};
+    std::atomic<std::uint64_t> thresholdUpdates{0};
+    LatencyHistogram callbackLatency;
+    LatencyHistogram actuatorLatency;
+    LatencyHistogram thresholdLatency;
+
+    // Returns the current time if the next event counted by the counter is sampled, the epoch otherwise. The last
+    // event of each period is sampled, so thermostats that rarely see an event do not time every first one.
+    static TimePoint Sample(const std::atomic<std::uint64_t> &counter) {
+        if ((counter.load(std::memory_order_relaxed) + 1) % SamplePeriod == 0) {
+            return std::chrono::steady_clock::now();
+        }
+        return TimePoint();
+    }
+
+    // Callback counters are only written by the thread delivering the notifications (the control thread in threaded
+    // mode), so a plain relaxed load and store is enough and avoids a locked read-modify-write on every event.
+    static void Increment(std::atomic<std::uint64_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Manual checks, actuator calls and threshold updates also run on the caller's thread (EnableThermostat,
+    // SetDeadbandMode and SetTemperatureThresholds without a control loop), concurrently with notifications, so their
+    // counters need an atomic increment.
+    static void IncrementShared(std::atomic<std::uint64_t> &counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void Record(LatencyHistogram &histogram, TimePoint start) {
+        if (start != TimePoint()) {
+            histogram.Record(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+public:
+    TimePoint StartCallback() const { return Sample(this->callbacks); }
+    TimePoint StartActuation() const { return Sample(this->actuatorCalls); }
+    TimePoint StartThresholdUpdate() const { return Sample(this->thresholdUpdates); }
+
+    void OnCallback(TimePoint start) {
+        Record(this->callbackLatency, start);
+        Increment(this->callbacks);
+    }
+    void OnIgnoredCallback() {
+        Increment(this->callbacks);
+        Increment(this->ignoredCallbacks);
+    }
+    void OnManualCheck() { IncrementShared(this->manualChecks); }
+    void OnActuation(TimePoint start) {
+        Record(this->actuatorLatency, start);
+        IncrementShared(this->actuatorCalls);
+    }
+    void OnThresholdUpdate(TimePoint start) {
+        Record(this->thresholdLatency, start);
+        IncrementShared(this->thresholdUpdates);
+    }
+
+    ThermostatMetricsSnapshot Snapshot() const {
+        ThermostatMetricsSnapshot snapshot;
+        snapshot.callbacks = this->callbacks.load(std::memory_order_relaxed);
+        snapshot.ignoredCallbacks = this->ignoredCallbacks.load(std::memory_order_relaxed);
+        snapshot.manualChecks = this->manualChecks.load(std::memory_order_relaxed);
+        snapshot.actuatorCalls = this->actuatorCalls.load(std::memory_order_relaxed);
+        snapshot.thresholdUpdates = this->thresholdUpdates.load(std::memory_order_relaxed);
+        snapshot.callbackLatency = this->callbackLatency.Snapshot();
+        snapshot.actuatorLatency = this->actuatorLatency.Snapshot();
+        snapshot.thresholdLatency = this->thresholdLatency.Snapshot();
+        return snapshot;
+    }
+};
+
+// Metrics timing one event in 16 of each kind.
+using ThermostatMetrics = BasicThermostatMetrics<16>;
+
+/**
+ * @brief Metrics that record nothing. Every call is an empty inline function and the object has no state, so
+ *        the instrumentation compiles away.
+ */
+class NullThermostatMetrics {
+public:
+    struct TimePoint {};
+    static constexpr bool enabled = false;
+
+    TimePoint StartCallback() const { return {}; }
+    TimePoint StartActuation() const { return {}; }
+    TimePoint StartThresholdUpdate() const { return {}; }
+
+    void OnCallback(TimePoint) {}
+    void OnIgnoredCallback() {}
+    void OnManualCheck() {}
+    void OnActuation(TimePoint) {}
+    void OnThresholdUpdate(TimePoint) {}
+
+    ThermostatMetricsSnapshot Snapshot() const { return {}; }
+};
+
+// Metrics used by Thermostat. Selected by the THERMOSTAT_ENABLE_METRICS build option.
+#ifdef THERMOSTAT_ENABLE_METRICS
+using DefaultThermostatMetrics = ThermostatMetrics;
+#else
+using DefaultThermostatMetrics = NullThermostatMetrics;
+#endif
+
+#endif //_THERMOSTAT_METRICS_H_
@@ -0,0 +1,139 @@
+#include "thermostat_snapshot.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string TemporaryPath(const std::string &path) {
+    return path + ".tmp";
+}
+
+} // namespace
+
+ThermostatSnapshotWriter::ThermostatSnapshotWriter():
+        header(nullptr),
+        states(nullptr),
+        mappedSize(0) {
+}
+
+ThermostatSnapshotWriter::~ThermostatSnapshotWriter() {
+    this->Abort();
+}
+
+bool ThermostatSnapshotWriter::Create(const std::string &snapshotPath, std::size_t count) {
+    this->Abort();
+    std::size_t size = sizeof(ThermostatSnapshotHeader) + count * sizeof(ThermostatState);
+    std::string temporary = TemporaryPath(snapshotPath);
+
+    int file = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) {
+        return false;
+    }
+    if (::ftruncate(file, size) != 0) {
+        ::close(file);
+        ::unlink(temporary.c_str());
+        return false;
+    }
+    // The mapping stays valid once the descriptor is closed.
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    this->header = static_cast<ThermostatSnapshotHeader *>(mapping);
+    this->header->magic = ThermostatSnapshotHeader::expectedMagic;
+    this->header->version = ThermostatSnapshotHeader::currentVersion;
+    this->header->stateSize = sizeof(ThermostatState);
+    this->header->count = count;
+    this->states = reinterpret_cast<ThermostatState *>(static_cast<char *>(mapping) + sizeof(ThermostatSnapshotHeader));
+    this->mappedSize = size;
+    this->path = snapshotPath;
+    return true;
+}
+
+bool ThermostatSnapshotWriter::Commit() {
+    if (this->header == nullptr) {
+        return false;
+    }
+    // The new snapshot must be on disk before it replaces the previous one.
+    bool ret = ::msync(this->header, this->mappedSize, MS_SYNC) == 0 &&
+               std::rename(TemporaryPath(this->path).c_str(), this->path.c_str()) == 0;
+    this->Release(ret);
+    return ret;
+}
+
+void ThermostatSnapshotWriter::Abort() {
+    if (this->header != nullptr) {
+        this->Release(false);
+    }
+}
+
+void ThermostatSnapshotWriter::Release(bool committed) {
+    ::munmap(this->header, this->mappedSize);
+    if (!committed) {
+        ::unlink(TemporaryPath(this->path).c_str());
+    }
+    this->header = nullptr;
+    this->states = nullptr;
+    this->mappedSize = 0;
+    this->path.clear();
+}
+
+ThermostatSnapshot::ThermostatSnapshot():
+        header(nullptr),
+        states(nullptr),
+        mappedSize(0) {
+}
+
+ThermostatSnapshot::~ThermostatSnapshot() {
+    this->Close();
+}
+
+bool ThermostatSnapshot::Open(const std::string &path) {
+    this->Close();
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (::fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(ThermostatSnapshotHeader)) {
+        ::close(file);
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    // The mapping stays valid once the descriptor is closed.
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    const ThermostatSnapshotHeader *mappedHeader = static_cast<const ThermostatSnapshotHeader *>(mapping);
+    if (mappedHeader->magic != ThermostatSnapshotHeader::expectedMagic ||
+            mappedHeader->version != ThermostatSnapshotHeader::currentVersion ||
+            mappedHeader->stateSize != sizeof(ThermostatState) ||
+            size != sizeof(ThermostatSnapshotHeader) + mappedHeader->count * sizeof(ThermostatState)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+
+    this->header = mappedHeader;
+    this->states = reinterpret_cast<const ThermostatState *>(static_cast<const char *>(mapping) +
+                                                              sizeof(ThermostatSnapshotHeader));
+    this->mappedSize = size;
+    return true;
+}
+
+void ThermostatSnapshot::Close() {
+    if (this->header != nullptr) {
+        ::munmap(const_cast<ThermostatSnapshotHeader *>(this->header), this->mappedSize);
+        this->header = nullptr;
+        this->states = nullptr;
+        this->mappedSize = 0;
+    }
+}
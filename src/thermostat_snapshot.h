@@ -0,0 +1,120 @@
+#ifndef _THERMOSTAT_SNAPSHOT_H_
+#define _THERMOSTAT_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "temperature.h"
+
+/**
+ * @brief Runtime state of a thermostat, as saved by BasicThermostat::SaveState and restored by its restore
+ *        constructor. Fixed size, so that a snapshot file can be used in place through a mapping.
+ */
+struct ThermostatState {
+    Temperature highTemperatureThreshold;  // Threshold mode thresholds.
+    Temperature lowTemperatureThreshold;
+    Temperature setpoint;                  // Deadband mode settings.
+    Temperature deadband;
+    Temperature lastReading;               // Last temperature read by the thermostat.
+    std::uint8_t mode;                     // ControlMode, 0 for Threshold and 1 for Deadband.
+    std::uint8_t on;                       // Whether the thermostat is enabled.
+    std::uint8_t heating;                  // Last actuator state.
+    std::uint8_t cooling;
+    std::int64_t minimumDwell;             // Deadband mode minimum dwell time, in nanoseconds.
+};
+
+static_assert(sizeof(ThermostatState) == 32, "thermostat states are 32 bytes on disk");
+
+/**
+ * @brief Header at the start of a snapshot file, followed by count states.
+ */
+struct ThermostatSnapshotHeader {
+    static constexpr std::uint32_t expectedMagic = 0x504e5354; // "TSNP"
+    static constexpr std::uint16_t currentVersion = 2; // Version 1 stored whole degrees.
+
+    std::uint32_t magic;       // expectedMagic.
+    std::uint16_t version;     // currentVersion.
+    std::uint16_t stateSize;   // sizeof(ThermostatState).
+    std::uint64_t count;       // Number of states.
+    std::uint64_t reserved[6]; // Zero. Pads the header to a cache line.
+};
+
+static_assert(sizeof(ThermostatSnapshotHeader) == 64, "the snapshot header is one cache line");
+
+/**
+ * @brief Writes a snapshot file. The states are written in place in a mapping of a temporary file, which replaces
+ *        the snapshot on Commit, so a crash while saving leaves the previous snapshot intact.
+ */
+class ThermostatSnapshotWriter {
+private:
+    ThermostatSnapshotHeader *header; // Start of the mapping, null while closed.
+    ThermostatState *states;          // States following the header.
+    std::size_t mappedSize;           // Size of the mapping, in bytes.
+    std::string path;                 // Snapshot file replaced on Commit.
+
+    // Unmaps the temporary file and deletes it unless it was committed.
+    void Release(bool committed);
+
+public:
+    ThermostatSnapshotWriter();
+    ~ThermostatSnapshotWriter();
+
+    ThermostatSnapshotWriter(const ThermostatSnapshotWriter &) = delete;
+    ThermostatSnapshotWriter &operator=(const ThermostatSnapshotWriter &) = delete;
+
+    /**
+     * @brief Creates the temporary file of a new snapshot, with every state zeroed.
+     * @param snapshotPath The snapshot file to replace on Commit.
+     * @param count Number of thermostat states.
+     * @ret   True if the file was created and mapped, false otherwise.
+     */
+    bool Create(const std::string &snapshotPath, std::size_t count);
+
+    /**
+     * @brief Writes the new snapshot to disk and replaces the previous one.
+     * @ret   True if the snapshot was replaced, false otherwise.
+     */
+    bool Commit();
+
+    /**
+     * @brief Discards the new snapshot.
+     */
+    void Abort();
+
+    std::size_t Size() const { return this->header != nullptr ? this->header->count : 0; }
+
+    ThermostatState &operator[](std::size_t index) { return this->states[index]; }
+};
+
+/**
+ * @brief Reads a snapshot file in place through a read-only mapping.
+ */
+class ThermostatSnapshot {
+private:
+    const ThermostatSnapshotHeader *header; // Start of the mapping, null while closed.
+    const ThermostatState *states;          // States following the header.
+    std::size_t mappedSize;                 // Size of the mapping, in bytes.
+
+public:
+    ThermostatSnapshot();
+    ~ThermostatSnapshot();
+
+    ThermostatSnapshot(const ThermostatSnapshot &) = delete;
+    ThermostatSnapshot &operator=(const ThermostatSnapshot &) = delete;
+
+    /**
+     * @brief Maps an existing snapshot file.
+     * @ret   True if the file is a snapshot of a supported version, false otherwise.
+     */
+    bool Open(const std::string &path);
+
+    void Close();
+
+    bool IsOpen() const { return this->header != nullptr; }
+
+    std::size_t Size() const { return this->header != nullptr ? this->header->count : 0; }
+
+    const ThermostatState &operator[](std::size_t index) const { return this->states[index]; }
+};
+
+#endif //_THERMOSTAT_SNAPSHOT_H_
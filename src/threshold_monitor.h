@@ -0,0 +1,101 @@
+#ifndef _THRESHOLD_MONITOR_H_
+#define _THRESHOLD_MONITOR_H_
+
+#include "thermometer.h"
+
+/**
+ * @brief Implements the threshold part of the Thermometer contract on top of a stream of readings, for thermometer
+ *        implementations that only know how to read a temperature.
+ *
+ *        The callback is called with true when a reading rises above the high threshold and with false when a
+ *        reading falls below the low threshold, and immediately when new thresholds are set while the last reading
+ *        exceeds either of them.
+ */
+class ThresholdMonitor {
+private:
+    Temperature minTemperature; // Minimum measurable temperature, lower thresholds are clamped to it.
+    Temperature maxTemperature; // Maximum measurable temperature, higher thresholds are clamped to it.
+    Temperature highThreshold;  // Current high threshold.
+    Temperature lowThreshold;   // Current low threshold.
+    Temperature lastReading;    // Last reading received.
+    bool hasReading;            // Whether a reading was received.
+    TemperatureCallback callback; // Callback registered by the thermometer user.
+
+    // Calls the callback if the given reading exceeds either threshold.
+    void NotifyIfExceeding(Temperature reading);
+
+public:
+    /**
+     * @brief Creates a monitor for a thermometer with the given measurable range. The thresholds start at the
+     *        limits of the range.
+     */
+    ThresholdMonitor(Temperature minMeasurable, Temperature maxMeasurable);
+
+    /**
+     * @brief Configures new thresholds, as Thermometer::SetTemperatureThresholds.
+     * @ret   True if the setting is accepted (low < high), false otherwise.
+     */
+    bool SetThresholds(Temperature high, Temperature low);
+
+    /**
+     * @brief Configures the callback, as Thermometer::RegisterCallback.
+     */
+    void RegisterCallback(TemperatureCallback cb);
+
+    /**
+     * @brief Processes a new reading, calling the callback if it crosses either threshold.
+     */
+    void Update(Temperature reading);
+
+    Temperature HighThreshold() const { return this->highThreshold; }
+    Temperature LowThreshold() const { return this->lowThreshold; }
+};
+
+inline ThresholdMonitor::ThresholdMonitor(Temperature minMeasurable, Temperature maxMeasurable):
+        minTemperature(minMeasurable),
+        maxTemperature(maxMeasurable),
+        highThreshold(maxMeasurable),
+        lowThreshold(minMeasurable),
+        lastReading(),
+        hasReading(false) {
+}
+
+inline bool ThresholdMonitor::SetThresholds(Temperature high, Temperature low) {
+    bool ret = false;
+    if (low < high) {
+        this->highThreshold = high > this->maxTemperature ? this->maxTemperature : high;
+        this->lowThreshold = low < this->minTemperature ? this->minTemperature : low;
+        if (this->hasReading) {
+            this->NotifyIfExceeding(this->lastReading);
+        }
+        ret = true;
+    }
+    return ret;
+}
+
+inline void ThresholdMonitor::RegisterCallback(TemperatureCallback cb) {
+    this->callback = std::move(cb);
+}
+
+inline void ThresholdMonitor::Update(Temperature reading) {
+    bool crossedHigh = reading > this->highThreshold && (!this->hasReading || this->lastReading <= this->highThreshold);
+    bool crossedLow = reading < this->lowThreshold && (!this->hasReading || this->lastReading >= this->lowThreshold);
+    this->lastReading = reading;
+    this->hasReading = true;
+    if (crossedHigh || crossedLow) {
+        this->NotifyIfExceeding(reading);
+    }
+}
+
+inline void ThresholdMonitor::NotifyIfExceeding(Temperature reading) {
+    if (this->callback) {
+        if (reading > this->highThreshold) {
+            this->callback(true);
+        }
+        else if (reading < this->lowThreshold) {
+            this->callback(false);
+        }
+    }
+}
+
+#endif //_THRESHOLD_MONITOR_H_
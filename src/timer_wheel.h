@@ -0,0 +1,162 @@
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Timer scheduled on a TimerWheel. Embedded in the object that owns the timer, so scheduling never
+ *        allocates. A node must be cancelled or expired before it is destroyed.
+ */
+struct TimerNode {
+    // Function called on expiry with the context of the node. May schedule the node again.
+    using Callback = void (*)(void *context);
+
+    TimerNode *prev = nullptr;   // Neighbours in the slot list, null while not scheduled.
+    TimerNode *next = nullptr;
+    std::uint64_t expiry = 0;    // Tick at which the timer fires.
+    Callback callback = nullptr; // Called on expiry.
+    void *context = nullptr;     // Passed to the callback, usually the object owning the node.
+
+    bool Scheduled() const { return this->next != nullptr; }
+};
+
+/**
+ * @brief Hierarchical timer wheel: four levels of 64 slots, each level 64 times coarser than the one below.
+ *        Scheduling and cancelling are O(1), and each tick only visits the expiring slot plus, once every 64
+ *        ticks, one slot of a coarser level whose timers move down a level. Delays are limited to 2^24 - 1
+ *        ticks, longer delays are shortened to that. Not thread-safe.
+ */
+class TimerWheel {
+public:
+    static constexpr unsigned levelBits = 6;
+    static constexpr std::size_t slotsPerLevel = std::size_t(1) << levelBits;
+    static constexpr std::size_t levels = 4;
+    static constexpr std::uint64_t maxDelay = (std::uint64_t(1) << (levelBits * levels)) - 1;
+
+private:
+    // Sentinel of a circular slot list.
+    struct Slot {
+        TimerNode head;
+    };
+
+    std::array<std::array<Slot, slotsPerLevel>, levels> slots;
+    std::uint64_t now; // Current tick.
+    std::size_t size;  // Scheduled timers.
+
+    void Insert(TimerNode &node) {
+        std::uint64_t delta = node.expiry - this->now;
+        std::size_t level = 0;
+        while (level + 1 < levels && delta >= (std::uint64_t(1) << (levelBits * (level + 1)))) {
+            ++level;
+        }
+        Slot &slot = this->slots[level][(node.expiry >> (levelBits * level)) & (slotsPerLevel - 1)];
+        node.prev = slot.head.prev;
+        node.next = &slot.head;
+        slot.head.prev->next = &node;
+        slot.head.prev = &node;
+    }
+
+    static void Unlink(TimerNode &node) {
+        node.prev->next = node.next;
+        node.next->prev = node.prev;
+        node.prev = nullptr;
+        node.next = nullptr;
+    }
+
+    // Moves the content of a slot to a detached list with the given sentinel.
+    static void Detach(Slot &slot, TimerNode &list) {
+        if (slot.head.next == &slot.head) {
+            list.next = &list;
+            list.prev = &list;
+            return;
+        }
+        list.next = slot.head.next;
+        list.prev = slot.head.prev;
+        list.next->prev = &list;
+        list.prev->next = &list;
+        slot.head.next = &slot.head;
+        slot.head.prev = &slot.head;
+    }
+
+public:
+    TimerWheel(): now(0), size(0) {
+        for (std::array<Slot, slotsPerLevel> &level : this->slots) {
+            for (Slot &slot : level) {
+                slot.head.next = &slot.head;
+                slot.head.prev = &slot.head;
+            }
+        }
+    }
+
+    // Slots point to themselves, so the wheel must stay in place.
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    std::uint64_t Now() const { return this->now; }
+    std::size_t Size() const { return this->size; }
+
+    /**
+     * @brief Schedules a timer, replacing its previous schedule if it has one.
+     * @param node The timer, with its callback set.
+     * @param delay Number of ticks until the timer fires, at least 1.
+     */
+    void Schedule(TimerNode &node, std::uint64_t delay) {
+        this->Cancel(node);
+        delay = delay < 1 ? 1 : (delay > maxDelay ? maxDelay : delay);
+        node.expiry = this->now + delay;
+        this->Insert(node);
+        ++this->size;
+    }
+
+    /**
+     * @brief Removes a timer from the wheel if it is scheduled.
+     */
+    void Cancel(TimerNode &node) {
+        if (node.Scheduled()) {
+            Unlink(node);
+            --this->size;
+        }
+    }
+
+    /**
+     * @brief Moves time forward by one tick and fires the timers expiring at the new tick.
+     */
+    void Tick() {
+        ++this->now;
+        // Every 64 ticks of a level, bring the timers of the next coarser slot down.
+        for (std::size_t level = 1; level < levels; ++level) {
+            if ((this->now & ((std::uint64_t(1) << (levelBits * level)) - 1)) != 0) {
+                break;
+            }
+            TimerNode list;
+            Detach(this->slots[level][(this->now >> (levelBits * level)) & (slotsPerLevel - 1)], list);
+            while (list.next != &list) {
+                TimerNode &node = *list.next;
+                Unlink(node);
+                this->Insert(node);
+            }
+        }
+
+        TimerNode expired;
+        Detach(this->slots[0][this->now & (slotsPerLevel - 1)], expired);
+        while (expired.next != &expired) {
+            TimerNode &node = *expired.next;
+            Unlink(node);
+            --this->size;
+            node.callback(node.context);
+        }
+    }
+
+    /**
+     * @brief Moves time forward by the given number of ticks, firing the timers in expiry order.
+     */
+    void Advance(std::uint64_t ticks) {
+        for (std::uint64_t i = 0; i < ticks; ++i) {
+            this->Tick();
+        }
+    }
+};
+
+#endif //_TIMER_WHEEL_H_
@@ -0,0 +1,168 @@
+#include "trace_replay.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+TraceThermometer::TraceThermometer(Temperature initialReading):
+        monitor(Temperature::Lowest(), Temperature::Highest()),
+        reading(initialReading) {
+    this->monitor.Update(initialReading);
+}
+
+void TraceThermometer::RegisterCallback(TemperatureCallback callback) {
+    this->monitor.RegisterCallback(std::move(callback));
+}
+
+void CommandRecorder::Heat(bool on) {
+    this->commands.push_back(ActuatorCommand{SimulationClock::now().time_since_epoch(), Actuator::Heat, on});
+}
+
+void CommandRecorder::Cool(bool on) {
+    this->commands.push_back(ActuatorCommand{SimulationClock::now().time_since_epoch(), Actuator::Cool, on});
+}
+
+double ReplayResult::SamplesPerSecond() const {
+    double seconds = std::chrono::duration<double>(this->elapsed).count();
+    return seconds > 0.0 ? static_cast<double>(this->samples) / seconds : 0.0;
+}
+
+CommandStream ReplayTrace(const Trace &trace, const ReplayConfiguration &configure, const FilterSettings *filter) {
+    CommandStream commands;
+    if (trace.empty()) {
+        return commands;
+    }
+
+    SimulationClock::current = SimulationClock::time_point(trace.front().time);
+    TraceThermometer meter(trace.front().temperature);
+    std::unique_ptr<BasicFilteredThermometer<SimulationClock>> filtered;
+    if (filter != nullptr) {
+        filtered = std::make_unique<BasicFilteredThermometer<SimulationClock>>(meter, *filter, Temperature::Lowest(),
+                                                                               Temperature::Highest());
+    }
+    CommandRecorder recorder(commands);
+    ReplayThermostat stat(filtered ? static_cast<Thermometer &>(*filtered) : meter, recorder);
+    if (configure) {
+        configure(stat);
+    }
+
+    for (std::size_t i = 1; i < trace.size(); ++i) {
+        SimulationClock::current = SimulationClock::time_point(trace[i].time);
+        meter.Feed(trace[i].temperature);
+        if (filtered) {
+            filtered->Poll();
+        }
+        stat.Poll();
+    }
+    return commands;
+}
+
+ReplayResult ReplayTraces(const std::vector<Trace> &traces, const ReplayConfiguration &configure,
+                          WorkStealingPool &pool, const FilterSettings *filter) {
+    ReplayResult result;
+    result.commands.resize(traces.size());
+    result.samples = 0;
+    for (const Trace &trace : traces) {
+        result.samples += trace.size();
+    }
+
+    std::uint64_t stealsBefore = pool.Steals();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        // Each task writes its own stream, so the results need no locking.
+        pool.Submit([&traces, &configure, &result, filter, i]() {
+            result.commands[i] = ReplayTrace(traces[i], configure, filter);
+        });
+    }
+    pool.Wait();
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    result.steals = pool.Steals() - stealsBefore;
+    return result;
+}
+
+std::vector<ReplayDivergence> CompareCommandStreams(const std::vector<CommandStream> &baseline,
+                                                    const std::vector<CommandStream> &candidate) {
+    std::vector<ReplayDivergence> divergences;
+    std::size_t traces = std::max(baseline.size(), candidate.size());
+    for (std::size_t trace = 0; trace < traces; ++trace) {
+        if (trace >= baseline.size() || trace >= candidate.size()) {
+            divergences.push_back(ReplayDivergence{trace, 0});
+            continue;
+        }
+        const CommandStream &expected = baseline[trace];
+        const CommandStream &actual = candidate[trace];
+        std::size_t common = std::min(expected.size(), actual.size());
+        std::size_t command = 0;
+        while (command < common && expected[command] == actual[command]) {
+            ++command;
+        }
+        if (command < common || expected.size() != actual.size()) {
+            divergences.push_back(ReplayDivergence{trace, command});
+        }
+    }
+    return divergences;
+}
+
+bool LoadTrace(const std::string &path, Trace &trace) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    trace.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::int64_t milliseconds;
+        char separator;
+        double temperature;
+        if (!(fields >> milliseconds >> separator >> temperature) || separator != ',') {
+            return false;
+        }
+        trace.push_back(TraceSample{std::chrono::milliseconds(milliseconds),
+                                    Temperature::FromCelsiusRounded(temperature)});
+    }
+    return true;
+}
+
+// Format: a "streams <count>" line, then one "<stream> <milliseconds> <H|C> <0|1>" line per command.
+bool SaveCommandStreams(const std::string &path, const std::vector<CommandStream> &streams) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "streams " << streams.size() << '\n';
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+        for (const ActuatorCommand &command : streams[i]) {
+            file << i << ' ' << command.time.count() << ' ' << (command.actuator == Actuator::Heat ? 'H' : 'C') << ' '
+                 << (command.on ? 1 : 0) << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool LoadCommandStreams(const std::string &path, std::vector<CommandStream> &streams) {
+    std::ifstream file(path);
+    std::string keyword;
+    std::size_t count;
+    if (!(file >> keyword >> count) || keyword != "streams") {
+        return false;
+    }
+    streams.assign(count, CommandStream());
+
+    std::size_t stream;
+    std::int64_t milliseconds;
+    char actuator;
+    int on;
+    while (file >> stream >> milliseconds >> actuator >> on) {
+        if (stream >= count || (actuator != 'H' && actuator != 'C') || (on != 0 && on != 1)) {
+            return false;
+        }
+        streams[stream].push_back(ActuatorCommand{std::chrono::milliseconds(milliseconds),
+                                                  actuator == 'H' ? Actuator::Heat : Actuator::Cool, on == 1});
+    }
+    return file.eof();
+}
@@ -0,0 +1,169 @@
+#ifndef _TRACE_REPLAY_H_
+#define _TRACE_REPLAY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "filtered_thermometer.h"
+#include "room_simulator.h"
+#include "temperature_controller.h"
+#include "thermometer.h"
+#include "thermostat.h"
+#include "threshold_monitor.h"
+#include "work_stealing_pool.h"
+
+/**
+ * @brief One reading of a recorded sensor trace.
+ */
+struct TraceSample {
+    std::chrono::milliseconds time; // Time of the reading since the start of the recording.
+    Temperature temperature;        // Temperature read.
+};
+
+using Trace = std::vector<TraceSample>;
+
+/**
+ * @brief Actuator addressed by a command.
+ */
+enum class Actuator: std::uint8_t {
+    Heat,
+    Cool,
+};
+
+/**
+ * @brief Heat or Cool call made by the thermostat during a replay.
+ */
+struct ActuatorCommand {
+    std::chrono::milliseconds time; // Time of the sample being replayed when the command was issued.
+    Actuator actuator;              // Actuator written.
+    bool on;                        // Value written.
+
+    bool operator==(const ActuatorCommand &) const = default;
+};
+
+using CommandStream = std::vector<ActuatorCommand>;
+
+/**
+ * @brief Thermometer fed from a recorded trace. Notifies threshold crossings as documented by
+ *        Thermometer::SetTemperatureThresholds, including the immediate notification when new thresholds are
+ *        exceeded by the current reading.
+ */
+class TraceThermometer final: public Thermometer {
+private:
+    ThresholdMonitor monitor; // Keeps the thresholds and notifies crossings.
+    Temperature reading;      // Last temperature fed.
+
+public:
+    /**
+     * @brief Creates a thermometer reading the first temperature of the trace.
+     */
+    explicit TraceThermometer(Temperature initialReading);
+
+    Temperature GetTemperature() const override { return this->reading; }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override {
+        return this->monitor.SetThresholds(high, low);
+    }
+    void RegisterCallback(TemperatureCallback callback) override;
+
+    /**
+     * @brief Makes the next temperature of the trace the current reading.
+     */
+    void Feed(Temperature temperature) {
+        this->reading = temperature;
+        this->monitor.Update(temperature);
+    }
+};
+
+/**
+ * @brief Temperature controller appending every Heat and Cool call to a command stream, stamped with the
+ *        SimulationClock time.
+ */
+class CommandRecorder final: public TemperatureController {
+private:
+    CommandStream &commands; // Stream receiving the commands.
+
+public:
+    explicit CommandRecorder(CommandStream &stream): commands(stream) {}
+
+    void Heat(bool on) override;
+    void Cool(bool on) override;
+};
+
+/**
+ * @brief Thermostat used by replays. Time comes from the trace, so dwell times behave as they did when the trace
+ *        was recorded. The thermometer is the TraceThermometer, or a FilteredThermometer over it.
+ */
+using ReplayThermostat = BasicThermostat<Thermometer, CommandRecorder, SimulationClock, NullThermostatMetrics>;
+
+/**
+ * @brief Configures the thermostat before a trace is replayed, e.g. by setting thresholds or the deadband mode.
+ */
+using ReplayConfiguration = std::function<void (ReplayThermostat &)>;
+
+/**
+ * @brief Command streams produced by replaying a set of traces.
+ */
+struct ReplayResult {
+    std::vector<CommandStream> commands; // Command stream of each trace, in the order of the traces.
+    std::uint64_t samples;               // Number of samples replayed.
+    std::chrono::nanoseconds elapsed;    // Wall clock time of the replay.
+    std::uint64_t steals;                // Traces moved between workers.
+
+    double SamplesPerSecond() const;
+};
+
+/**
+ * @brief First difference between the command streams of a trace.
+ */
+struct ReplayDivergence {
+    std::size_t trace;   // Index of the trace.
+    std::size_t command; // Index of the first command that differs, or that only one stream has.
+};
+
+/**
+ * @brief Replays one trace through a thermostat, polling it after every sample.
+ * @param trace The readings to replay.
+ * @param configure Applied to the thermostat before the second sample, may be empty.
+ * @param filter If not null, the samples go through a FilteredThermometer with these settings, polled after every
+ *               sample, before reaching the thermostat.
+ * @ret   The Heat and Cool calls of the thermostat, including the ones made when it starts.
+ */
+CommandStream ReplayTrace(const Trace &trace, const ReplayConfiguration &configure,
+                          const FilterSettings *filter = nullptr);
+
+/**
+ * @brief Replays every trace on the pool, one task per trace.
+ */
+ReplayResult ReplayTraces(const std::vector<Trace> &traces, const ReplayConfiguration &configure,
+                          WorkStealingPool &pool, const FilterSettings *filter = nullptr);
+
+/**
+ * @brief Lists the traces whose command streams differ, with the first differing command. Traces missing from
+ *        either side are reported at command 0.
+ */
+std::vector<ReplayDivergence> CompareCommandStreams(const std::vector<CommandStream> &baseline,
+                                                    const std::vector<CommandStream> &candidate);
+
+/**
+ * @brief Reads a trace from a text file with one "milliseconds,temperature" line per sample, the temperature in
+ *        degrees Celsius, e.g. "1000,21.5". Temperatures are rounded to the nearest tenth of a degree.
+ * @ret   True if the file was read, false if it could not be opened or a line is malformed.
+ */
+bool LoadTrace(const std::string &path, Trace &trace);
+
+/**
+ * @brief Writes command streams to a text file, to compare later builds against.
+ * @ret   True if the file was written.
+ */
+bool SaveCommandStreams(const std::string &path, const std::vector<CommandStream> &streams);
+
+/**
+ * @brief Reads command streams written by SaveCommandStreams.
+ * @ret   True if the file was read, false if it could not be opened or is malformed.
+ */
+bool LoadCommandStreams(const std::string &path, std::vector<CommandStream> &streams);
+
+#endif //_TRACE_REPLAY_H_
@@ -0,0 +1,111 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// Pool and deque index of the worker running on this thread, if any.
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local std::size_t currentQueue = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads):
+        nextQueue(0),
+        pending(0),
+        signals(0),
+        stopping(false),
+        steals(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        this->workers.emplace_back(&WorkStealingPool::Run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    this->Wait();
+    this->stopping.store(true);
+    this->signals.fetch_add(1);
+    this->signals.notify_all();
+    for (std::thread &worker : this->workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    std::size_t index;
+    if (currentPool == this) {
+        index = currentQueue;
+    }
+    else {
+        index = this->nextQueue.fetch_add(1, std::memory_order_relaxed) % this->queues.size();
+    }
+
+    this->pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+        this->queues[index]->tasks.push_back(std::move(task));
+    }
+    this->signals.fetch_add(1);
+    this->signals.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    std::size_t remaining = this->pending.load();
+    while (remaining != 0) {
+        this->pending.wait(remaining);
+        remaining = this->pending.load();
+    }
+}
+
+bool WorkStealingPool::TakeTask(std::size_t index, Task &task) {
+    {
+        Queue &own = *this->queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t offset = 1; offset < this->queues.size(); ++offset) {
+        Queue &victim = *this->queues[(index + offset) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            this->steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(std::size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    Task task;
+    while (true) {
+        // Read the signal before looking for work, so a task submitted after the search changes it and the
+        // wait below returns straight away.
+        std::uint32_t observed = this->signals.load();
+        if (this->TakeTask(index, task)) {
+            task();
+            task = nullptr;
+            if (this->pending.fetch_sub(1) == 1) {
+                this->pending.notify_all();
+            }
+            continue;
+        }
+        if (this->stopping.load()) {
+            break;
+        }
+        this->signals.wait(observed);
+    }
+    currentPool = nullptr;
+}
@@ -0,0 +1,76 @@
+#ifndef _WORK_STEALING_POOL_H_
+#define _WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads, each with its own task deque. A worker runs the newest task of its own
+ *        deque and, once it is empty, steals the oldest task of another worker, so that uneven tasks keep every
+ *        thread busy.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void ()>;
+
+private:
+    // Deque of one worker, on its own cache line.
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // One deque per worker.
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextQueue;  // Deque receiving the next task submitted from outside the pool.
+    std::atomic<std::size_t> pending;    // Tasks submitted and not finished yet.
+    std::atomic<std::uint32_t> signals;  // Bumped when tasks are submitted or the pool stops, to wake the workers.
+    std::atomic<bool> stopping;          // Set to ask the workers to exit.
+    std::atomic<std::uint64_t> steals;   // Tasks run by another worker than the one they were queued on.
+
+    // Body of a worker thread.
+    void Run(std::size_t index);
+
+    // Takes the newest task of the worker's own deque, or steals the oldest task of another deque.
+    bool TakeTask(std::size_t index, Task &task);
+
+public:
+    /**
+     * @brief Starts the workers.
+     * @param threads Number of worker threads, 0 to use one per CPU.
+     */
+    explicit WorkStealingPool(unsigned threads = 0);
+
+    // Finishes the queued tasks and joins the workers.
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Queues a task. A task submitted from a worker goes to that worker's deque, other tasks are spread
+     *        over the deques in turn.
+     */
+    void Submit(Task task);
+
+    /**
+     * @brief Waits until every submitted task has finished. Must not be called from a task.
+     */
+    void Wait();
+
+    std::size_t Size() const { return this->workers.size(); }
+
+    /**
+     * @brief Returns the number of tasks stolen by a worker from another worker's deque.
+     */
+    std::uint64_t Steals() const { return this->steals.load(std::memory_order_relaxed); }
+};
+
+#endif //_WORK_STEALING_POOL_H_
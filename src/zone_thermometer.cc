@@ -0,0 +1,155 @@
+#include "zone_thermometer.h"
+
+#include <algorithm>
+
+namespace {
+
+// Divides a sum of tenths of a degree, rounding halves away from zero.
+Temperature RoundedDivide(std::int64_t sum, std::int64_t count) {
+    return Temperature::FromDeciCelsius(static_cast<std::int32_t>(temperature_detail::DivideRounded(sum, count)));
+}
+
+} // namespace
+
+SensorAggregate::SensorAggregate(Aggregation kind, std::size_t sensors):
+        aggregation(kind),
+        readings(sensors, Temperature()),
+        sum(0),
+        lower(sensors, this->readings.data()),
+        upper(sensors, this->readings.data()) {
+    for (std::uint32_t sensor = 0; sensor < sensors; ++sensor) {
+        if (kind == Aggregation::Min) {
+            this->upper.Push(sensor);
+        }
+        else if (kind != Aggregation::Mean) {
+            this->lower.Push(sensor);
+        }
+    }
+    if (kind == Aggregation::Median) {
+        // The lower half keeps the extra reading of an odd count.
+        while (this->lower.Size() > this->upper.Size() + 1) {
+            this->upper.Push(this->lower.Pop());
+        }
+    }
+}
+
+void SensorAggregate::Update(std::size_t sensor, Temperature reading) {
+    std::uint32_t item = static_cast<std::uint32_t>(sensor);
+    this->sum += static_cast<std::int64_t>(reading.DeciCelsius()) - this->readings[sensor].DeciCelsius();
+    this->readings[sensor] = reading;
+    switch (this->aggregation) {
+    case Aggregation::Mean:
+        break;
+    case Aggregation::Min:
+        this->upper.Update(item);
+        break;
+    case Aggregation::Max:
+        this->lower.Update(item);
+        break;
+    case Aggregation::Median:
+        if (this->lower.Contains(item)) {
+            this->lower.Update(item);
+        }
+        else {
+            this->upper.Update(item);
+        }
+        // Only the changed reading can be on the wrong side, swapping the two middle readings restores the halves.
+        if (!this->upper.Empty() && this->readings[this->lower.Top()] > this->readings[this->upper.Top()]) {
+            std::uint32_t fromLower = this->lower.Pop();
+            std::uint32_t fromUpper = this->upper.Pop();
+            this->lower.Push(fromUpper);
+            this->upper.Push(fromLower);
+        }
+        break;
+    }
+}
+
+Temperature SensorAggregate::Value() const {
+    if (this->readings.empty()) {
+        return Temperature();
+    }
+    switch (this->aggregation) {
+    case Aggregation::Min:
+        return this->readings[this->upper.Top()];
+    case Aggregation::Max:
+        return this->readings[this->lower.Top()];
+    case Aggregation::Median:
+        if (this->lower.Size() > this->upper.Size()) {
+            return this->readings[this->lower.Top()];
+        }
+        return RoundedDivide(static_cast<std::int64_t>(this->readings[this->lower.Top()].DeciCelsius()) +
+                             this->readings[this->upper.Top()].DeciCelsius(), 2);
+    case Aggregation::Mean:
+    default:
+        return RoundedDivide(this->sum, static_cast<std::int64_t>(this->readings.size()));
+    }
+}
+
+ZoneThermometer::ZoneThermometer(const std::vector<Thermometer *> &sensors, Aggregation kind,
+                                 Temperature sensorResolution, Temperature minMeasurable, Temperature maxMeasurable):
+        resolution(std::max(sensorResolution, minimumResolution)),
+        aggregate(kind, sensors.size()),
+        monitor(minMeasurable, maxMeasurable) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->subscriptions.reserve(sensors.size());
+    for (Thermometer *sensor : sensors) {
+        this->subscriptions.push_back(Subscription{sensor, false, false});
+    }
+    for (std::size_t i = 0; i < this->subscriptions.size(); ++i) {
+        this->subscriptions[i].sensor->RegisterCallback([this, i](bool) { this->OnSensor(i); });
+        this->Refresh(i);
+    }
+    this->monitor.Update(this->aggregate.Value());
+}
+
+ZoneThermometer::~ZoneThermometer() {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    for (Subscription &subscription : this->subscriptions) {
+        subscription.sensor->RegisterCallback(nullptr);
+    }
+}
+
+Temperature ZoneThermometer::GetTemperature() const {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->aggregate.Value();
+}
+
+bool ZoneThermometer::SetTemperatureThresholds(Temperature high, Temperature low) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->monitor.SetThresholds(high, low);
+}
+
+void ZoneThermometer::RegisterCallback(TemperatureCallback callback) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->monitor.RegisterCallback(std::move(callback));
+}
+
+Temperature ZoneThermometer::SensorReading(std::size_t sensor) const {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    return this->aggregate.Reading(sensor);
+}
+
+void ZoneThermometer::Refresh(std::size_t sensor) {
+    Subscription &subscription = this->subscriptions[sensor];
+    do {
+        subscription.pending = false;
+        Temperature reading = subscription.sensor->GetTemperature();
+        this->aggregate.Update(sensor, reading);
+        // Setting thresholds the reading already exceeds notifies at once, loop instead of recursing.
+        subscription.arming = true;
+        // Thresholds only notify once exceeded, arm a tenth inside the band so that a move of resolution notifies.
+        Temperature inside = this->resolution - Temperature::FromDeciCelsius(1);
+        subscription.sensor->SetTemperatureThresholds(reading + inside, reading - inside);
+        subscription.arming = false;
+    } while (subscription.pending);
+}
+
+void ZoneThermometer::OnSensor(std::size_t sensor) {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    if (this->subscriptions[sensor].arming) {
+        this->subscriptions[sensor].pending = true;
+        return;
+    }
+    this->Refresh(sensor);
+    this->monitor.Update(this->aggregate.Value());
+}
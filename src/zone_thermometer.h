@@ -0,0 +1,129 @@
+#ifndef _ZONE_THERMOMETER_H_
+#define _ZONE_THERMOMETER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "indexed_heap.h"
+#include "thermometer.h"
+#include "threshold_monitor.h"
+
+/**
+ * @brief How the readings of the sensors of a zone are combined into one temperature.
+ */
+enum class Aggregation {
+    Mean,   // Mean of the readings, rounded to the nearest tenth of a degree.
+    Median, // Middle reading, or the rounded mean of the two middle readings for an even number of sensors.
+    Min,    // Lowest reading.
+    Max,    // Highest reading.
+};
+
+/**
+ * @brief Aggregate of a fixed number of readings, kept up to date as readings change. The mean is updated in O(1)
+ *        from a running sum, the median, min and max in O(log n) through indexed heaps. Storage is allocated on
+ *        construction, updates never allocate. Not thread-safe.
+ */
+class SensorAggregate {
+private:
+    Aggregation aggregation;
+    std::vector<Temperature> readings; // Last reading of each sensor.
+    std::int64_t sum;                  // Sum of the readings, in tenths of a degree.
+    IndexedHeap<std::greater<Temperature>, Temperature> lower; // Lower half of the readings for the median, every
+                                                               // reading for the max.
+    IndexedHeap<std::less<Temperature>, Temperature> upper;    // Upper half of the readings for the median, every
+                                                               // reading for the min.
+
+public:
+    /**
+     * @brief Creates an aggregate of the given number of readings, all 0 °C to start with.
+     */
+    SensorAggregate(Aggregation kind, std::size_t sensors);
+
+    // The heaps point to the readings, so the aggregate must stay in place.
+    SensorAggregate(const SensorAggregate &) = delete;
+    SensorAggregate &operator=(const SensorAggregate &) = delete;
+
+    /**
+     * @brief Changes the reading of a sensor.
+     */
+    void Update(std::size_t sensor, Temperature reading);
+
+    /**
+     * @brief Returns the aggregate of the current readings, 0 °C if there are none.
+     */
+    Temperature Value() const;
+
+    Temperature Reading(std::size_t sensor) const { return this->readings[sensor]; }
+    std::size_t Size() const { return this->readings.size(); }
+};
+
+/**
+ * @brief Thermometer of a zone measured by several sensors. Subscribes to every sensor and presents the aggregate
+ *        of their readings as a single Thermometer, with the threshold contract of the Thermometer interface.
+ *
+ *        Each sensor's thresholds are armed around its last reading, so a sensor only notifies the zone when its
+ *        reading moves by resolution or more. The zone then reads that sensor alone and updates
+ *        the aggregate incrementally. The zone's own thresholds are checked against each new aggregate.
+ *        Notifications may come from any thread, they run with the zone lock held.
+ */
+class ZoneThermometer: public Thermometer {
+public:
+    // Finest sensor resolution: thresholds must be a tenth apart, so the sensor band cannot be narrower.
+    static constexpr Temperature minimumResolution = Temperature::FromDeciCelsius(2);
+
+private:
+    // Subscription to one sensor.
+    struct Subscription {
+        Thermometer *sensor;
+        bool arming;   // Set while the sensor thresholds are being set.
+        bool pending;  // Set when the sensor notified while its thresholds were being set.
+    };
+
+    std::vector<Subscription> subscriptions;
+    Temperature resolution;             // Change of a sensor reading that triggers an update.
+    SensorAggregate aggregate;          // Aggregate of the last sensor readings.
+    ThresholdMonitor monitor;           // Keeps the zone thresholds and notifies crossings of the aggregate.
+    mutable std::recursive_mutex mutex; // Protects the members above. Recursive, so that the zone callback can set
+                                        // the zone thresholds.
+
+    // Reads a sensor, updates the aggregate and re-arms the sensor thresholds around the new reading.
+    void Refresh(std::size_t sensor);
+
+    // Called when a sensor reading left its band.
+    void OnSensor(std::size_t sensor);
+
+public:
+    /**
+     * @brief Creates a zone thermometer reading every sensor once and subscribing to them. The sensor callbacks and
+     *        thresholds are taken over by the zone.
+     * @param sensors The sensors of the zone. Must outlive the zone thermometer.
+     * @param kind How the readings are combined.
+     * @param sensorResolution Change of a sensor reading that triggers an update, at least minimumResolution.
+     * @param minMeasurable Minimum measurable temperature, lower thresholds are clamped to it.
+     * @param maxMeasurable Maximum measurable temperature, higher thresholds are clamped to it.
+     */
+    ZoneThermometer(const std::vector<Thermometer *> &sensors, Aggregation kind,
+                    Temperature sensorResolution = minimumResolution,
+                    Temperature minMeasurable = Temperature::FromCelsius(-40),
+                    Temperature maxMeasurable = Temperature::FromCelsius(125));
+
+    // Unsubscribes from the sensors.
+    ~ZoneThermometer() override;
+
+    ZoneThermometer(const ZoneThermometer &) = delete;
+    ZoneThermometer &operator=(const ZoneThermometer &) = delete;
+
+    // Returns the aggregate of the last sensor readings, without reading the sensors.
+    Temperature GetTemperature() const override;
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override;
+    void RegisterCallback(TemperatureCallback callback) override;
+
+    /**
+     * @brief Returns the last reading of a sensor, as used in the aggregate.
+     */
+    Temperature SensorReading(std::size_t sensor) const;
+};
+
+#endif //_ZONE_THERMOMETER_H_
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../src/actuator_channel.h"
+#include "../src/shm_temperature_controller.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Shared memory object name unique to the test process.
+std::string ChannelName(const std::string &test) {
+    return "/thermostat_" + test + "_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+// Producers only open channels created by a consumer, and commands come out in order with their sequence numbers.
+TEST(ActuatorChannelUnit, SubmitDrainAcknowledge) {
+    std::string name = ChannelName("submit");
+    ActuatorChannel channel;
+    EXPECT_FALSE(channel.Open(name));
+    EXPECT_FALSE(channel.Submit(1, true, false));
+
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 6));
+    ASSERT_TRUE(channel.Open(name));
+    EXPECT_TRUE(channel.Submit(1, true, false));
+    EXPECT_TRUE(channel.Submit(2, false, true));
+    EXPECT_EQ(channel.PublishedSequence(), 2u);
+    EXPECT_EQ(channel.Acknowledged(), 0u);
+    EXPECT_FALSE(channel.WaitForAcknowledgement(1, 1ms));
+
+    std::vector<ActuatorCommandRecord> commands;
+    EXPECT_EQ(daemon.Drain([&commands](const ActuatorCommandRecord &command) { commands.push_back(command); }), 2u);
+    ASSERT_EQ(commands.size(), 2u);
+    EXPECT_EQ(commands[0].sequence, 1u);
+    EXPECT_EQ(commands[0].zone, 1u);
+    EXPECT_EQ(commands[0].heat, 1);
+    EXPECT_EQ(commands[0].cool, 0);
+    EXPECT_EQ(commands[1].sequence, 2u);
+    EXPECT_EQ(commands[1].cool, 1);
+    EXPECT_LE(commands[0].timestamp, commands[1].timestamp);
+    EXPECT_EQ(channel.Acknowledged(), 2u);
+    EXPECT_TRUE(channel.WaitForAcknowledgement(2, 0ns));
+    EXPECT_EQ(daemon.Drain([](const ActuatorCommandRecord &) {}), 0u);
+}
+
+// Batched commands are published together on Flush, or once the batch is full.
+TEST(ActuatorChannelUnit, Batching) {
+    std::string name = ChannelName("batching");
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 16));
+    ActuatorChannel channel;
+    ASSERT_TRUE(channel.Open(name, 4));
+
+    auto ignore = [](const ActuatorCommandRecord &) {};
+    for (std::uint32_t zone = 0; zone < 3; ++zone) {
+        EXPECT_TRUE(channel.Submit(zone, true, false));
+    }
+    EXPECT_EQ(daemon.Drain(ignore), 0u);
+    EXPECT_TRUE(channel.Flush());
+    EXPECT_EQ(channel.PublishedSequence(), 3u);
+    EXPECT_EQ(daemon.Drain(ignore), 3u);
+
+    for (std::uint32_t zone = 0; zone < 4; ++zone) {
+        EXPECT_TRUE(channel.Submit(zone, false, false));
+    }
+    EXPECT_EQ(channel.PublishedSequence(), 7u);
+    EXPECT_EQ(daemon.Drain(ignore, 2), 2u);
+    EXPECT_EQ(channel.Acknowledged(), 5u);
+    EXPECT_EQ(daemon.Drain(ignore), 2u);
+}
+
+// A full ring rejects commands until the consumer catches up, and wraps around after it did.
+TEST(ActuatorChannelUnit, FullRing) {
+    std::string name = ChannelName("full");
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 4));
+    ActuatorChannel channel;
+    ASSERT_TRUE(channel.Open(name));
+
+    auto ignore = [](const ActuatorCommandRecord &) {};
+    for (int round = 0; round < 3; ++round) {
+        for (std::uint32_t zone = 0; zone < 4; ++zone) {
+            EXPECT_TRUE(channel.Submit(zone, true, false));
+        }
+        // The fifth command waits in the batch, the sixth has no room at all.
+        EXPECT_TRUE(channel.Submit(4, true, false));
+        EXPECT_FALSE(channel.Submit(5, true, false));
+        EXPECT_FALSE(channel.Flush());
+        EXPECT_EQ(daemon.Drain(ignore), 4u);
+        EXPECT_TRUE(channel.Flush());
+        EXPECT_EQ(daemon.Drain(ignore), 1u);
+    }
+    EXPECT_EQ(channel.Acknowledged(), 15u);
+}
+
+// Producers on several threads share the ring, and every command is delivered once, in sequence order.
+TEST(ActuatorChannelUnit, ConcurrentProducers) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+    std::string name = ChannelName("concurrent");
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 64));
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&name, p]() {
+            ActuatorChannel channel;
+            ASSERT_TRUE(channel.Open(name, 8));
+            for (int i = 0; i < perProducer; ++i) {
+                while (!channel.Submit(p, i % 2 == 0, false)) {
+                    std::this_thread::yield();
+                }
+            }
+            while (!channel.Flush()) {
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> received(producers, 0);
+    std::uint64_t expected = 1;
+    bool ordered = true;
+    while (expected <= producers * perProducer) {
+        daemon.Drain([&](const ActuatorCommandRecord &command) {
+            ordered = ordered && command.sequence == expected;
+            ++expected;
+            ++received[command.zone];
+        });
+        std::this_thread::yield();
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received, std::vector<int>(producers, perProducer));
+}
+
+// A thermostat drives the relays of a daemon through the channel, one command per mode transition.
+TEST(ActuatorChannelUnit, ThermostatThroughChannel) {
+    std::string name = ChannelName("thermostat");
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 8));
+    ActuatorChannel channel;
+    ASSERT_TRUE(channel.Open(name));
+
+    FakeThermometer meter;
+    meter.temperature = 20_degC;
+    ShmTemperatureController controller(channel, 7);
+    Thermostat stat(meter, controller);
+    stat.SetTemperatureThresholds(25_degC, 15_degC);
+    std::uint64_t published = channel.PublishedSequence();
+    meter.SetTemperature(30_degC);
+    EXPECT_EQ(channel.PublishedSequence(), published + 1);
+
+    RecordingTemperatureController relays;
+    std::thread thread([&daemon, &relays]() {
+        for (int i = 0; i < 1000 && daemon.Drain([&relays](const ActuatorCommandRecord &command) {
+                 EXPECT_EQ(command.zone, 7u);
+                 relays.SetMode(command.heat != 0, command.cool != 0);
+             }) == 0; ++i) {
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    EXPECT_TRUE(channel.WaitForAcknowledgement(channel.PublishedSequence(), 10s));
+    thread.join();
+    EXPECT_TRUE(relays.cooling);
+    EXPECT_FALSE(relays.heating);
+    EXPECT_EQ(controller.Rejected(), 0u);
+}
+
+// The producer may live in another process.
+TEST(ActuatorChannelUnit, ProducerProcess) {
+    std::string name = ChannelName("process");
+    ActuatorChannelConsumer daemon;
+    ASSERT_TRUE(daemon.Create(name, 16));
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ActuatorChannel channel;
+        bool sent = channel.Open(name, 4);
+        for (std::uint32_t zone = 0; sent && zone < 10; ++zone) {
+            sent = channel.Submit(zone, false, true);
+        }
+        sent = sent && channel.Flush() && channel.WaitForAcknowledgement(10, 10s);
+        ::_exit(sent ? 0 : 1);
+    }
+
+    std::vector<std::uint32_t> zones;
+    for (int i = 0; i < 10000 && zones.size() < 10; ++i) {
+        if (daemon.Drain([&zones](const ActuatorCommandRecord &command) { zones.push_back(command.zone); }) == 0) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(zones, (std::vector<std::uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
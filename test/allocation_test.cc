@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "../src/filtered_thermometer.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_clock.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+// Replaces the global allocation functions of this executable to count the allocations made while a
+// CountAllocations object is alive on the current thread.
+namespace {
+
+thread_local bool counting = false;
+std::atomic<int> allocations(0);
+
+class CountAllocations {
+public:
+    CountAllocations() { allocations.store(0); counting = true; }
+    ~CountAllocations() { counting = false; }
+    int Count() const { return allocations.load(); }
+};
+
+void *Allocate(std::size_t size) {
+    if (counting) {
+        allocations.fetch_add(1);
+    }
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+} // namespace
+
+void *operator new(std::size_t size) { return Allocate(size); }
+void *operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+
+// The replaced operator new sees the allocations, so the tests below cannot pass by accident.
+TEST(AllocationUnit, CountsAllocations) {
+    CountAllocations scope;
+    int *volatile value = new int(1);
+    delete value;
+    EXPECT_EQ(scope.Count(), 1);
+}
+
+// Constructing a thermostat, registering its callback and dispatching notifications never allocate.
+TEST(AllocationUnit, ThermostatCallbackPath) {
+    FakeThermometer meter;
+    meter.temperature = 5_degC;
+    RecordingTemperatureController controller;
+    alignas(Thermostat) unsigned char storage[sizeof(Thermostat)];
+
+    CountAllocations scope;
+    Thermostat *stat = new (storage) Thermostat(meter, controller);
+    stat->SetTemperatureThresholds(25_degC, 15_degC);
+    meter.SetTemperature(30_degC);
+    meter.SetTemperature(20_degC);
+    meter.SetTemperature(10_degC);
+    stat->EnableThermostat(false);
+    meter.SetTemperature(30_degC);
+    stat->EnableThermostat(true);
+    stat->~Thermostat();
+    EXPECT_EQ(scope.Count(), 0);
+    EXPECT_TRUE(controller.cooling);
+}
+
+// The deadband mode and its dwell time handling never allocate either.
+TEST(AllocationUnit, DeadbandPath) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    BasicThermostat<Thermometer, TemperatureController, FakeClock> stat(meter, controller);
+
+    CountAllocations scope;
+    stat.SetDeadbandMode(21_degC, 2_degC, std::chrono::minutes(1));
+    meter.SetTemperature(17_degC);
+    FakeClock::Advance(std::chrono::minutes(2));
+    meter.SetTemperature(22_degC);
+    FakeClock::Advance(std::chrono::minutes(2));
+    stat.Poll();
+    EXPECT_EQ(scope.Count(), 0);
+}
+
+// Copying and calling an inplace function never allocate.
+TEST(AllocationUnit, InplaceFunction) {
+    int calls = 0;
+    CountAllocations scope;
+    TemperatureCallback callback = [&calls](bool) { ++calls; };
+    TemperatureCallback copy = callback;
+    copy(true);
+    callback = nullptr;
+    EXPECT_EQ(scope.Count(), 0);
+    EXPECT_EQ(calls, 1);
+}
+
+// Smoothing, debouncing and forwarding the notifications of a filtered thermometer never allocate.
+TEST(AllocationUnit, FilteredPath) {
+    FakeThermometer sensor;
+    sensor.temperature = 20_degC;
+    FilterSettings settings;
+    settings.smoothing = Smoothing::MovingAverage;
+    settings.debounce = std::chrono::seconds(10);
+    BasicFilteredThermometer<FakeClock> meter(sensor, settings);
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+
+    CountAllocations scope;
+    stat.SetTemperatureThresholds(25_degC, 15_degC);
+    for (Temperature reading : {30_degC, 30_degC, 30_degC, 30_degC, 30_degC, 10_degC, 10_degC, 10_degC}) {
+        sensor.temperature = reading;
+        meter.Poll();
+        FakeClock::Advance(std::chrono::seconds(5));
+    }
+    EXPECT_EQ(scope.Count(), 0);
+    EXPECT_GT(meter.Forwarded(), 0u);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <functional>
+#include <type_traits>
+#include "../src/thermostat.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+// Thermometer driver without virtual functions, called directly by BasicThermostat.
+struct DirectThermometer {
+    Temperature temperature = 20_degC;
+    Temperature high;
+    Temperature low;
+    std::function<void (bool)> callback;
+
+    Temperature GetTemperature() const { return this->temperature; }
+    bool SetTemperatureThresholds(Temperature newHigh, Temperature newLow) {
+        this->high = newHigh;
+        this->low = newLow;
+        return newLow < newHigh;
+    }
+    template <typename Callback>
+    void RegisterCallback(Callback cb) { this->callback = cb; }
+};
+
+// Temperature controller driver without virtual functions.
+struct DirectTemperatureController {
+    bool heating = false;
+    bool cooling = false;
+    int writes = 0;
+
+    void Heat(bool on) { this->heating = on; ++this->writes; }
+    void Cool(bool on) { this->cooling = on; ++this->writes; }
+};
+
+struct NotAThermometer {
+    int GetTemperature() const { return 0; }
+};
+
+using DirectThermostat = BasicThermostat<DirectThermometer, DirectTemperatureController>;
+
+} // namespace
+
+static_assert(TemperatureSensor<Thermometer>);
+static_assert(TemperatureSensor<DirectThermometer>);
+static_assert(!TemperatureSensor<NotAThermometer>);
+static_assert(HeatingCoolingActuator<TemperatureController>);
+static_assert(HeatingCoolingActuator<DirectTemperatureController>);
+static_assert(!std::is_polymorphic_v<DirectThermostat>);
+
+// Thermostat configures the concrete thermometer and acts on its first reading.
+TEST(BasicThermostatUnit, StartWithLowTemp) {
+    DirectThermometer meter;
+    DirectTemperatureController controller;
+    meter.temperature = -10_degC;
+
+    DirectThermostat stat(meter, controller);
+
+    EXPECT_EQ(meter.high, 40_degC);
+    EXPECT_EQ(meter.low, 10_degC);
+    EXPECT_TRUE(static_cast<bool>(meter.callback));
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+    EXPECT_EQ(controller.writes, 2);
+}
+
+// Notifications from the concrete thermometer reach the thermostat.
+TEST(BasicThermostatUnit, HeatAndCoolSequence) {
+    DirectThermometer meter;
+    DirectTemperatureController controller;
+    DirectThermostat stat(meter, controller);
+
+    meter.callback(true);
+    EXPECT_FALSE(controller.heating);
+    EXPECT_TRUE(controller.cooling);
+
+    meter.callback(false);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+
+    stat.EnableThermostat(false);
+    meter.callback(true);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+
+    meter.temperature = 50_degC;
+    stat.EnableThermostat(true);
+    EXPECT_FALSE(controller.heating);
+    EXPECT_TRUE(controller.cooling);
+}
+
+// Thresholds are validated and forwarded to the concrete thermometer.
+TEST(BasicThermostatUnit, AdjustThresholds) {
+    DirectThermometer meter;
+    DirectTemperatureController controller;
+    DirectThermostat stat(meter, controller);
+
+    EXPECT_TRUE(stat.SetTemperatureThresholds(25_degC, 18_degC));
+    EXPECT_EQ(meter.high, 25_degC);
+    EXPECT_EQ(meter.low, 18_degC);
+    EXPECT_FALSE(stat.SetTemperatureThresholds(18_degC, 25_degC));
+    EXPECT_EQ(meter.high, 25_degC);
+
+    // The new thresholds are used when the thermostat is reenabled.
+    meter.temperature = 20_degC;
+    stat.EnableThermostat(true);
+    EXPECT_FALSE(controller.heating);
+    meter.temperature = 17_degC;
+    stat.EnableThermostat(true);
+    EXPECT_TRUE(controller.heating);
+}
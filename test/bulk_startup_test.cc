@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../src/bulk_startup.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Thermometer taking a while to answer a read, counting the reads in flight.
+class SlowThermometer: public Thermometer {
+public:
+    Temperature temperature;
+    TemperatureCallback callback;
+    static inline std::atomic<int> inFlight{0};
+    static inline std::atomic<int> maxInFlight{0};
+
+    explicit SlowThermometer(Temperature temp): temperature(temp) {}
+
+    Temperature GetTemperature() const override {
+        int current = inFlight.fetch_add(1) + 1;
+        int seen = maxInFlight.load();
+        while (current > seen && !maxInFlight.compare_exchange_weak(seen, current)) {
+        }
+        std::this_thread::sleep_for(10ms);
+        inFlight.fetch_sub(1);
+        return this->temperature;
+    }
+    bool SetTemperatureThresholds(Temperature high, Temperature low) override { return low < high; }
+    void RegisterCallback(TemperatureCallback cb) override { this->callback = std::move(cb); }
+};
+
+} // namespace
+
+// A deferred thermostat leaves the thermometer alone until started, ignores notifications until activated, and
+// acts on the reading it is activated with.
+TEST(BulkStartupUnit, DeferredStart) {
+    FakeThermometer meter;
+    meter.temperature = 5_degC;
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller, deferredStart);
+    EXPECT_FALSE(meter.callback);
+    EXPECT_EQ(controller.writes, 0);
+
+    // The thresholds are already exceeded when configured, the notification is ignored.
+    stat.ConfigureThermometer();
+    EXPECT_EQ(meter.high, 40_degC);
+    EXPECT_EQ(meter.low, 10_degC);
+    EXPECT_EQ(controller.writes, 0);
+
+    stat.Activate(5_degC);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+
+    meter.SetTemperature(45_degC);
+    EXPECT_TRUE(controller.cooling);
+}
+
+// Zones start concurrently, with no more reads in flight than allowed, and each zone is timed.
+TEST(BulkStartupUnit, StartThermostats) {
+    constexpr int zones = 32;
+    std::vector<std::unique_ptr<SlowThermometer>> meters;
+    std::vector<std::unique_ptr<RecordingTemperatureController>> controllers;
+    std::vector<std::unique_ptr<Thermostat>> stats;
+    std::vector<StartupZone<Thermostat, SlowThermometer>> startup;
+    for (int i = 0; i < zones; ++i) {
+        meters.push_back(std::make_unique<SlowThermometer>(i % 2 == 0 ? 0_degC : 20_degC));
+        controllers.push_back(std::make_unique<RecordingTemperatureController>());
+        stats.push_back(std::make_unique<Thermostat>(*meters.back(), *controllers.back(), deferredStart));
+        startup.push_back({stats.back().get(), meters.back().get()});
+    }
+
+    std::future<BulkStartupReport> future = StartThermostats(startup, 8);
+    BulkStartupReport report = future.get();
+
+    EXPECT_LE(SlowThermometer::maxInFlight.load(), 8);
+    EXPECT_GT(SlowThermometer::maxInFlight.load(), 1);
+    // One read after the other would take at least zones * 10ms.
+    EXPECT_LT(report.total, zones * 10ms);
+    ASSERT_EQ(report.latencies.size(), static_cast<std::size_t>(zones));
+    EXPECT_GE(report.Percentile(0.5), 10ms);
+    EXPECT_GE(report.Max(), report.Percentile(0.5));
+    for (int i = 0; i < zones; ++i) {
+        ASSERT_EQ(controllers[i]->heating, i % 2 == 0) << "zone " << i;
+        ASSERT_TRUE(meters[i]->callback) << "zone " << i;
+    }
+}
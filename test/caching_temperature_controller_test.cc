@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "../src/caching_temperature_controller.h"
+#include "../src/thermostat.h"
+#include "../src/test/mock_temperature_controller.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using ::testing::InSequence;
+using ::testing::_;
+
+// Writes that would not change the state of the controller are dropped.
+TEST(CachingTemperatureControllerUnit, DropsRedundantWrites) {
+    MockTemperatureController backend;
+    CachingTemperatureController cache(backend);
+
+    {
+        InSequence seq;
+
+        EXPECT_CALL(backend, Heat(false));
+        EXPECT_CALL(backend, Cool(false));
+        EXPECT_CALL(backend, Cool(true));
+        EXPECT_CALL(backend, Heat(true));
+        EXPECT_CALL(backend, Cool(false));
+    }
+
+    cache.Heat(false);
+    cache.Cool(false);
+    cache.Heat(false);
+    cache.Cool(true);
+    cache.Cool(true);
+    cache.Heat(true);
+    cache.Cool(false);
+    cache.Heat(true);
+
+    EXPECT_EQ(cache.RequestedWrites(), 8u);
+    EXPECT_EQ(cache.IssuedWrites(), 5u);
+    EXPECT_EQ(cache.SavedWrites(), 3u);
+}
+
+// Mode changes keep the order of the thermostat writes and only forward the channel that changed.
+TEST(CachingTemperatureControllerUnit, SplitsModeForSimpleBackend) {
+    MockTemperatureController backend;
+    CachingTemperatureController cache(backend);
+
+    {
+        InSequence seq;
+
+        EXPECT_CALL(backend, Heat(false));
+        EXPECT_CALL(backend, Cool(false));
+        EXPECT_CALL(backend, Cool(true));
+        EXPECT_CALL(backend, Heat(true));
+        EXPECT_CALL(backend, Cool(false));
+    }
+
+    cache.SetMode(false, false);
+    cache.SetMode(false, true);
+    cache.SetMode(false, true);
+    cache.SetMode(true, false);
+
+    EXPECT_EQ(cache.RequestedWrites(), 8u);
+    EXPECT_EQ(cache.SavedWrites(), 3u);
+}
+
+// A backend with mode transitions receives one write per change of state.
+TEST(CachingTemperatureControllerUnit, MergesModeTransitions) {
+    MockModeTemperatureController backend;
+    CachingTemperatureController cache(backend);
+
+    EXPECT_CALL(backend, Heat(_)).Times(0);
+    EXPECT_CALL(backend, Cool(_)).Times(0);
+    {
+        InSequence seq;
+
+        EXPECT_CALL(backend, SetMode(false, false));
+        EXPECT_CALL(backend, SetMode(true, false));
+        EXPECT_CALL(backend, SetMode(false, true));
+    }
+
+    cache.SetMode(false, false);
+    cache.SetMode(true, false);
+    cache.SetMode(true, false);
+    cache.SetMode(false, true);
+    cache.SetMode(false, true);
+
+    EXPECT_EQ(cache.RequestedWrites(), 10u);
+    EXPECT_EQ(cache.IssuedWrites(), 3u);
+}
+
+// Forgetting the cached state forwards the next write again.
+TEST(CachingTemperatureControllerUnit, Invalidate) {
+    MockTemperatureController backend;
+    CachingTemperatureController cache(backend);
+
+    EXPECT_CALL(backend, Heat(true)).Times(2);
+
+    cache.Heat(true);
+    cache.Heat(true);
+    cache.Invalidate();
+    cache.Heat(true);
+}
+
+// Placed between a thermostat and its controller, only the state changes reach the controller.
+TEST(CachingTemperatureControllerUnit, BehindThermostat) {
+    FakeThermometer meter;
+    RecordingTemperatureController backend;
+    CachingTemperatureController cache(backend);
+
+    Thermostat stat(meter, cache);
+    for (bool isHigh : {true, true, false, true, false, false, false, true}) {
+        meter.callback(isHigh);
+        EXPECT_EQ(backend.heating, !isHigh);
+        EXPECT_EQ(backend.cooling, isHigh);
+    }
+
+    // 2 writes from the constructor, then only the channels that changed: 1 for the first notification, 2 for each
+    // of the 4 changes between heating and cooling.
+    EXPECT_EQ(cache.RequestedWrites(), 18u);
+    EXPECT_EQ(backend.writes, 11);
+}
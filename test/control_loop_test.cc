@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "../src/control_loop.h"
+#include "../src/event_ring.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+void CountEvent(void *context, bool value) {
+    static_cast<std::vector<int> *>(context)->push_back(value ? 1 : 0);
+}
+
+} // namespace
+
+// Events come out of the ring in the order they were pushed, and a full ring rejects new events.
+TEST(EventRingUnit, FifoAndBounded) {
+    EventRing<int> ring(4);
+    EXPECT_EQ(ring.Capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(4));
+    EXPECT_EQ(ring.Size(), 4u);
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.TryPop(value));
+}
+
+// Events pushed concurrently by several producers are all delivered exactly once.
+TEST(EventRingUnit, ConcurrentProducers) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    EventRing<int> ring(256);
+    std::vector<int> seen(producers * perProducer, 0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                while (!ring.TryPush(p * perProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int value;
+    for (int received = 0; received < producers * perProducer;) {
+        if (ring.TryPop(value)) {
+            ++seen[value];
+            ++received;
+        }
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (int count : seen) {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+// Events are handled in order on the control thread, and counted.
+TEST(ControlLoopUnit, HandlesPostedEvents) {
+    ControlLoop loop(64);
+    std::vector<int> handled;
+
+    loop.Start();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(loop.Post(&CountEvent, &handled, i % 2 == 0));
+    }
+    loop.WaitIdle();
+
+    ASSERT_EQ(handled.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(handled[i], i % 2 == 0 ? 1 : 0);
+    }
+    ControlLoopStats stats = loop.GetStats();
+    EXPECT_EQ(stats.posted, 10u);
+    EXPECT_EQ(stats.processed, 10u);
+    EXPECT_EQ(stats.dropped, 0u);
+    EXPECT_GT(stats.p99Latency.count(), 0);
+    EXPECT_GE(stats.maxLatency, stats.p50Latency / 2);
+}
+
+// Events posted into a full queue are dropped and counted, the queued ones are handled once the loop starts.
+TEST(ControlLoopUnit, DropsWhenFull) {
+    ControlLoop loop(8);
+    std::vector<int> handled;
+
+    int accepted = 0;
+    for (int i = 0; i < 20; ++i) {
+        accepted += loop.Post(&CountEvent, &handled, true);
+    }
+    EXPECT_EQ(accepted, 8);
+
+    loop.Start();
+    loop.WaitIdle();
+
+    ControlLoopStats stats = loop.GetStats();
+    EXPECT_EQ(handled.size(), 8u);
+    EXPECT_EQ(stats.dropped, 12u);
+    EXPECT_EQ(stats.maxQueueDepth, 8u);
+}
+
+// In threaded mode the thermometer callback only queues the notification, the control thread acts on it.
+TEST(ControlLoopUnit, ThreadedThermostat) {
+    ControlLoop loop(1024);
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+
+    Thermostat stat(meter, controller, loop);
+    EXPECT_EQ(controller.writes, 2);
+
+    // Not started yet: the notification waits in the queue.
+    meter.SetTemperature(50_degC);
+    EXPECT_FALSE(controller.cooling);
+
+    loop.Start();
+    loop.WaitIdle();
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_FALSE(controller.heating);
+
+    // Notifications fired from several sensor threads are all handled by the control thread.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&meter]() {
+            for (int i = 0; i < 1000; ++i) {
+                meter.callback(i % 2 == 0);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    loop.WaitIdle();
+    ControlLoopStats stats = loop.GetStats();
+    EXPECT_EQ(stats.processed + stats.dropped, 4001u);
+    EXPECT_EQ(controller.writes, 2 + 2 * static_cast<int>(stats.processed));
+
+    // Reenabling checks the temperature on the control thread.
+    meter.temperature = 0_degC;
+    stat.EnableThermostat(false);
+    stat.EnableThermostat(true);
+    loop.WaitIdle();
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "../src/control_strategy.h"
+#include "../src/room_simulator.h"
+#include "../src/strategy_thermostat.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+constexpr ActuatorState idle{false, false};
+constexpr ActuatorState heating{true, false};
+constexpr ActuatorState cooling{false, true};
+
+PiSettings Pi(double proportionalGain, double integralGain, std::uint32_t cycleSamples) {
+    PiSettings settings;
+    settings.setpoint = 21_degC;
+    settings.proportionalGain = proportionalGain;
+    settings.integralGain = integralGain;
+    settings.cycleSamples = cycleSamples;
+    return settings;
+}
+
+// Number of heating samples in the next duty cycle of a PI strategy reading a constant temperature.
+int HeatingSamples(PiStrategy &strategy, Temperature temperature, std::uint32_t cycleSamples) {
+    int samples = 0;
+    for (std::uint32_t i = 0; i < cycleSamples; ++i) {
+        samples += strategy.Decide(temperature, idle).heat;
+    }
+    return samples;
+}
+
+} // namespace
+
+// On/off control acts outside the thresholds and keeps both thresholds armed.
+TEST(ControlStrategyUnit, OnOff) {
+    OnOffStrategy strategy{25_degC, 15_degC};
+    EXPECT_EQ(strategy.Decide(14_degC, idle), heating);
+    EXPECT_EQ(strategy.Decide(20_degC, heating), heating);
+    EXPECT_EQ(strategy.Decide(20_degC, idle), idle);
+    EXPECT_EQ(strategy.Decide(26_degC, heating), cooling);
+    EXPECT_EQ(strategy.OnCrossing(true, heating), cooling);
+    EXPECT_EQ(strategy.OnCrossing(false, idle), heating);
+    EXPECT_EQ(strategy.Thresholds(cooling), (ArmedThresholds{25_degC, 15_degC}));
+}
+
+// The deadband keeps heating or cooling until the setpoint, and only arms the threshold ending the current state.
+TEST(ControlStrategyUnit, Deadband) {
+    DeadbandStrategy strategy{21_degC, 2_degC};
+    EXPECT_EQ(strategy.Decide(20_degC, idle), idle);
+    EXPECT_EQ(strategy.Decide(18_degC, idle), heating);
+    EXPECT_EQ(strategy.Decide(20_degC, heating), heating);
+    EXPECT_EQ(strategy.Decide(21.1_degC, heating), idle);
+    EXPECT_EQ(strategy.Decide(21_degC, cooling), cooling);
+
+    EXPECT_EQ(strategy.OnCrossing(false, heating), heating);
+    EXPECT_EQ(strategy.OnCrossing(true, heating), idle);
+    EXPECT_EQ(strategy.OnCrossing(true, cooling), cooling);
+    EXPECT_EQ(strategy.OnCrossing(false, cooling), idle);
+    EXPECT_EQ(strategy.OnCrossing(true, idle), cooling);
+
+    EXPECT_EQ(strategy.Thresholds(idle), (ArmedThresholds{23_degC, 19_degC}));
+    EXPECT_EQ(strategy.Thresholds(heating), (ArmedThresholds{21_degC, Temperature::Lowest()}));
+    EXPECT_EQ(strategy.Thresholds(cooling), (ArmedThresholds{Temperature::Highest(), 21_degC}));
+}
+
+// The proportional term sets the share of a cycle spent heating or cooling, at the start of the cycle.
+TEST(ControlStrategyUnit, PiDutyCycle) {
+    PiStrategy strategy(Pi(0.5, 0.0, 10));
+    std::vector<ActuatorState> cycle;
+    for (int i = 0; i < 10; ++i) {
+        // Readings within a cycle do not change its duty.
+        cycle.push_back(strategy.Decide(i == 0 ? 20_degC : 15_degC, idle));
+    }
+    EXPECT_DOUBLE_EQ(strategy.Duty(), 0.5);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(cycle[i], i < 5 ? heating : idle) << i;
+    }
+
+    // Far above the setpoint the output saturates at full cooling.
+    EXPECT_EQ(strategy.Decide(25_degC, idle), cooling);
+    EXPECT_DOUBLE_EQ(strategy.Duty(), -1.0);
+    EXPECT_EQ(strategy.OnCrossing(true, heating), heating);
+    EXPECT_EQ(strategy.Thresholds(idle), (ArmedThresholds{Temperature::Highest(), Temperature::Lowest()}));
+}
+
+// The integral term grows the duty cycle while an error persists, and is clamped so it recovers quickly.
+TEST(ControlStrategyUnit, PiIntegral) {
+    PiStrategy strategy(Pi(0.0, 0.1, 10));
+    EXPECT_EQ(HeatingSamples(strategy, 20_degC, 10), 1);
+    EXPECT_EQ(HeatingSamples(strategy, 20_degC, 10), 2);
+    EXPECT_EQ(HeatingSamples(strategy, 20_degC, 10), 3);
+    for (int i = 0; i < 100; ++i) {
+        HeatingSamples(strategy, 11_degC, 10);
+    }
+    EXPECT_DOUBLE_EQ(strategy.Duty(), 1.0);
+    // Windup would keep heating for many cycles above the setpoint, the clamped integral stops within a few.
+    HeatingSamples(strategy, 26_degC, 10);
+    HeatingSamples(strategy, 26_degC, 10);
+    EXPECT_EQ(HeatingSamples(strategy, 26_degC, 10), 0);
+}
+
+// Strategies made from a configuration are validated, and decide like the concrete strategy.
+TEST(ControlStrategyUnit, MakeFromSettings) {
+    std::unique_ptr<ControlStrategy> strategy;
+    StrategySettings settings;
+    settings.onOff = OnOffStrategy{15_degC, 25_degC};
+    EXPECT_FALSE(MakeControlStrategy(settings, strategy));
+    settings.kind = StrategyKind::Deadband;
+    settings.deadband.band = 0_degC;
+    EXPECT_FALSE(MakeControlStrategy(settings, strategy));
+    settings.kind = StrategyKind::Pi;
+    settings.pi.cycleSamples = 0;
+    EXPECT_FALSE(MakeControlStrategy(settings, strategy));
+    EXPECT_EQ(strategy, nullptr);
+
+    settings.kind = StrategyKind::Deadband;
+    settings.deadband = DeadbandStrategy{21_degC, 2_degC};
+    ASSERT_TRUE(MakeControlStrategy(settings, strategy));
+    EXPECT_EQ(strategy->Decide(18_degC, idle), heating);
+    EXPECT_EQ(strategy->Thresholds(heating), settings.deadband.Thresholds(heating));
+}
+
+// A strategy thermostat with the deadband strategy makes the same decisions as Thermostat in deadband mode.
+TEST(StrategyThermostatUnit, DeadbandMatchesThermostat) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+    stat.SetDeadbandMode(21_degC, 2_degC);
+
+    FakeThermometer strategyMeter;
+    RecordingTemperatureController strategyController;
+    DeadbandStrategy strategy{21_degC, 2_degC};
+    BasicStrategyThermostat<DeadbandStrategy, FakeThermometer, RecordingTemperatureController> strategyStat(
+            strategyMeter, strategyController, strategy);
+
+    for (Temperature reading : {20_degC, 18_degC, 20_degC, 21.5_degC, 24_degC, 22_degC, 20.5_degC, 16_degC}) {
+        meter.SetTemperature(reading);
+        strategyMeter.SetTemperature(reading);
+        EXPECT_EQ(strategyController.heating, controller.heating) << reading.ToCelsius();
+        EXPECT_EQ(strategyController.cooling, controller.cooling) << reading.ToCelsius();
+        EXPECT_EQ(strategyMeter.high, meter.high);
+        EXPECT_EQ(strategyMeter.low, meter.low);
+    }
+    EXPECT_EQ(strategyStat.Transitions(), 5u);
+
+    // Disabled, notifications are ignored. Enabling decides on the current reading.
+    strategyStat.EnableThermostat(false);
+    strategyMeter.SetTemperature(30_degC);
+    EXPECT_TRUE(strategyController.heating);
+    strategyStat.EnableThermostat(true);
+    EXPECT_TRUE(strategyController.cooling);
+}
+
+// A PI thermostat polled every minute holds a simulated room closer to its setpoint than the deadband, at the cost
+// of more actuator cycles.
+TEST(StrategyThermostatUnit, PiHoldsRoom) {
+    double error[2] = {};
+    std::uint64_t transitions[2] = {};
+    for (int i = 0; i < 2; ++i) {
+        StrategySettings settings;
+        settings.kind = i == 0 ? StrategyKind::Deadband : StrategyKind::Pi;
+        settings.deadband = DeadbandStrategy{21_degC, 1_degC};
+        std::unique_ptr<ControlStrategy> strategy;
+        ASSERT_TRUE(MakeControlStrategy(settings, strategy));
+
+        RoomSimulation simulation;
+        SimulatedRoom &room = simulation.AddRoom();
+        StrategyThermostat stat(room.GetThermometer(), room.GetController(), *strategy);
+        std::int64_t samples = 0;
+        simulation.SetStepHook([&](std::size_t) {
+            stat.Poll();
+            // Skip the first day, while the room reaches the setpoint.
+            if (++samples > 24 * 60) {
+                error[i] += std::abs(room.Temperature() - 21.0);
+            }
+        });
+        simulation.Run(std::chrono::hours(24 * 7), std::chrono::minutes(1), 1);
+        error[i] /= static_cast<double>(samples - 24 * 60);
+        transitions[i] = room.GetController().Transitions();
+    }
+    EXPECT_LT(error[1], error[0]);
+    EXPECT_LT(error[1], 0.3);
+    EXPECT_GT(transitions[1], transitions[0]);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "../src/thermostat.h"
+#include "../src/test/fake_clock.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+using ClockedThermostat = BasicThermostat<Thermometer, TemperatureController, FakeClock>;
+
+// Counts the notifications a thermometer delivers to the thermostat registered with it.
+void CountCallbacks(FakeThermometer &meter, int &callbacks) {
+    // Thermometer callbacks are stored in place, keep the wrapped one on the heap to fit the wrapper.
+    std::shared_ptr<TemperatureCallback> callback = std::make_shared<TemperatureCallback>(meter.callback);
+    meter.callback = [callback, &callbacks](bool isHigh) {
+        ++callbacks;
+        (*callback)(isHigh);
+    };
+}
+
+struct RoomRun {
+    int callbacks = 0;
+    int transitions = 0;
+};
+
+// Simple room: heating raises the temperature by 1 per step, cooling lowers it by 1 per step, otherwise the room
+// drifts by 1 towards the outside temperature every 16 steps. The thermometer reads the room temperature with a
+// noise of +/-1.
+template <typename Configure>
+RoomRun RunRoom(int outside, int steps, Configure configure) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    ClockedThermostat stat(meter, controller);
+    RoomRun run;
+    CountCallbacks(meter, run.callbacks);
+    configure(stat);
+
+    bool heating = controller.heating;
+    bool cooling = controller.cooling;
+    int temp = meter.temperature.Celsius();
+    unsigned noise = 1;
+    for (int step = 0; step < steps; ++step) {
+        if (controller.heating) {
+            ++temp;
+        }
+        else if (controller.cooling) {
+            --temp;
+        }
+        else if (step % 16 == 0) {
+            temp += temp < outside ? 1 : (temp > outside ? -1 : 0);
+        }
+        noise = noise * 1103515245u + 12345u;
+        meter.SetTemperature(Temperature::FromCelsius(temp + static_cast<int>((noise >> 16) % 3) - 1));
+        FakeClock::Advance(1min);
+        stat.Poll();
+
+        if (controller.heating != heating || controller.cooling != cooling) {
+            ++run.transitions;
+            heating = controller.heating;
+            cooling = controller.cooling;
+        }
+    }
+    return run;
+}
+
+} // namespace
+
+// Heat below the band, stop at the setpoint, stay idle inside the band, cool above the band.
+TEST(DeadbandThermostatUnit, HeatsAndCoolsToSetpoint) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    ClockedThermostat stat(meter, controller);
+
+    EXPECT_TRUE(stat.SetDeadbandMode(22_degC, 2_degC));
+    EXPECT_EQ(meter.high, 24_degC);
+    EXPECT_EQ(meter.low, 20_degC);
+    EXPECT_FALSE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+
+    meter.SetTemperature(19_degC);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_EQ(meter.high, 22_degC);
+    EXPECT_EQ(meter.low, Temperature::Lowest());
+
+    meter.SetTemperature(22_degC);
+    EXPECT_TRUE(controller.heating);
+    meter.SetTemperature(23_degC);
+    EXPECT_FALSE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+    EXPECT_EQ(meter.high, 24_degC);
+    EXPECT_EQ(meter.low, 20_degC);
+
+    meter.SetTemperature(25_degC);
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_EQ(meter.high, Temperature::Highest());
+    EXPECT_EQ(meter.low, 22_degC);
+    meter.SetTemperature(21_degC);
+    EXPECT_FALSE(controller.cooling);
+    EXPECT_FALSE(controller.heating);
+}
+
+// Invalid bands are rejected, and setting thresholds returns to threshold mode.
+TEST(DeadbandThermostatUnit, ModeSelection) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    ClockedThermostat stat(meter, controller);
+
+    EXPECT_FALSE(stat.SetDeadbandMode(22_degC, 0_degC));
+    EXPECT_FALSE(stat.SetDeadbandMode(22_degC, -1_degC));
+    EXPECT_TRUE(stat.SetDeadbandMode(22_degC, 1_degC));
+
+    EXPECT_TRUE(stat.SetTemperatureThresholds(30_degC, 15_degC));
+    meter.SetTemperature(14_degC);
+    EXPECT_TRUE(controller.heating);
+    // Threshold mode keeps heating past the low threshold.
+    meter.SetTemperature(25_degC);
+    EXPECT_TRUE(controller.heating);
+
+    // Switching to thresholds the reading already exceeds handles the immediate notification in threshold mode.
+    meter.SetTemperature(22.5_degC);
+    EXPECT_TRUE(stat.SetDeadbandMode(22_degC, 1_degC));
+    EXPECT_FALSE(controller.cooling);
+    EXPECT_TRUE(stat.SetTemperatureThresholds(21_degC, 15_degC));
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_EQ(meter.high, 21_degC);
+    EXPECT_EQ(meter.low, 15_degC);
+    meter.SetTemperature(14_degC);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+}
+
+// A transition requested before the minimum dwell time is deferred until Poll is called after it elapsed.
+TEST(DeadbandThermostatUnit, MinimumDwell) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    ClockedThermostat stat(meter, controller);
+
+    EXPECT_TRUE(stat.SetDeadbandMode(22_degC, 2_degC, 5min));
+    meter.SetTemperature(19_degC);
+    EXPECT_TRUE(controller.heating);
+
+    FakeClock::Advance(2min);
+    meter.SetTemperature(23_degC);
+    EXPECT_TRUE(controller.heating);
+    stat.Poll();
+    EXPECT_TRUE(controller.heating);
+
+    FakeClock::Advance(3min);
+    stat.Poll();
+    EXPECT_FALSE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+}
+
+// Disabled thermostats ignore notifications, and reenabling acts on the current temperature.
+TEST(DeadbandThermostatUnit, Reenable) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    ClockedThermostat stat(meter, controller);
+    EXPECT_TRUE(stat.SetDeadbandMode(22_degC, 2_degC));
+
+    stat.EnableThermostat(false);
+    meter.SetTemperature(30_degC);
+    EXPECT_FALSE(controller.cooling);
+
+    int writes = controller.writes;
+    stat.EnableThermostat(true);
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_GT(controller.writes, writes);
+}
+
+// Compared to threshold mode on the same band, deadband mode lets the room rest inside the band instead of
+// swinging from one threshold to the other, and disarms the threshold it is moving away from, so noise around
+// that threshold no longer produces notifications.
+TEST(DeadbandThermostatUnit, FewerCallbacksAndTransitions) {
+    RoomRun threshold = RunRoom(35, 10000, [](ClockedThermostat &stat) {
+        stat.SetTemperatureThresholds(24_degC, 20_degC);
+    });
+    RoomRun deadband = RunRoom(35, 10000, [](ClockedThermostat &stat) {
+        stat.SetDeadbandMode(22_degC, 2_degC);
+    });
+
+    RecordProperty("ThresholdCallbacks", threshold.callbacks);
+    RecordProperty("ThresholdTransitions", threshold.transitions);
+    RecordProperty("DeadbandCallbacks", deadband.callbacks);
+    RecordProperty("DeadbandTransitions", deadband.transitions);
+    EXPECT_LT(deadband.callbacks * 2, threshold.callbacks);
+    EXPECT_LT(deadband.transitions * 2, threshold.transitions);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../src/filtered_thermometer.h"
+#include "../src/thermostat.h"
+#include "../src/trace_replay.h"
+#include "../src/test/fake_clock.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+using ClockedFilteredThermometer = BasicFilteredThermometer<FakeClock>;
+
+FilterSettings Settings(Smoothing smoothing, std::chrono::milliseconds debounce = 0ms) {
+    FilterSettings settings;
+    settings.smoothing = smoothing;
+    settings.debounce = debounce;
+    return settings;
+}
+
+// Readings alternating around the given temperature, as a noisy sensor sitting on a threshold.
+Temperature Noisy(Temperature center, int sample) {
+    return sample % 2 == 0 ? center + 0.3_degC : center - 0.3_degC;
+}
+
+} // namespace
+
+// Each smoothing converges on a steady reading, the moving average over its window only.
+TEST(NoiseFilterUnit, Smoothing) {
+    NoiseFilter none(Settings(Smoothing::None));
+    none.Update(20_degC);
+    EXPECT_EQ(none.Update(25_degC), 25_degC);
+
+    FilterSettings averageSettings = Settings(Smoothing::MovingAverage);
+    averageSettings.window = 4;
+    NoiseFilter average(averageSettings);
+    average.Update(20_degC);
+    EXPECT_EQ(average.Update(21_degC), 20.5_degC);
+    for (int i = 0; i < 4; ++i) {
+        average.Update(24_degC);
+    }
+    EXPECT_EQ(average.Value(), 24_degC);
+
+    NoiseFilter exponential(Settings(Smoothing::Exponential));
+    exponential.Update(20_degC);
+    EXPECT_EQ(exponential.Update(24_degC), 21_degC);
+    for (int i = 0; i < 40; ++i) {
+        exponential.Update(24_degC);
+    }
+    EXPECT_EQ(exponential.Value(), 24_degC);
+}
+
+// The Kalman filter keeps noisy readings of a constant temperature much closer to it than the readings are.
+TEST(NoiseFilterUnit, KalmanRejectsNoise) {
+    NoiseFilter kalman(Settings(Smoothing::Kalman));
+    std::mt19937 random(3);
+    std::normal_distribution<double> noise(0.0, 5.0);
+    double worstReading = 0.0;
+    double worstEstimate = 0.0;
+    for (int i = 0; i < 500; ++i) {
+        Temperature reading = 22_degC + Temperature::FromDeciCelsius(static_cast<std::int32_t>(noise(random)));
+        Temperature estimate = kalman.Update(reading);
+        if (i >= 50) {
+            worstReading = std::max(worstReading, std::abs((reading - 22_degC).ToCelsius()));
+            worstEstimate = std::max(worstEstimate, std::abs((estimate - 22_degC).ToCelsius()));
+        }
+    }
+    EXPECT_GT(worstReading, 1.0);
+    EXPECT_LT(worstEstimate, 0.5);
+}
+
+// Noise around a threshold crosses it at every sample unfiltered, and once smoothed.
+TEST(FilteredThermometerUnit, SmoothingRemovesNoiseCrossings) {
+    for (Smoothing smoothing : {Smoothing::None, Smoothing::Exponential, Smoothing::Kalman}) {
+        FakeThermometer sensor;
+        sensor.temperature = 20_degC;
+        ClockedFilteredThermometer meter(sensor, Settings(smoothing));
+        std::vector<bool> notifications;
+        meter.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+        EXPECT_TRUE(meter.SetTemperatureThresholds(25_degC, 15_degC));
+        EXPECT_FALSE(meter.SetTemperatureThresholds(15_degC, 15_degC));
+
+        for (int sample = 0; sample < 100; ++sample) {
+            sensor.temperature = Noisy(sample < 50 ? 20_degC : 25_degC, sample);
+            meter.Poll();
+        }
+        if (smoothing == Smoothing::None) {
+            EXPECT_EQ(notifications.size(), 25u);
+        }
+        else {
+            EXPECT_LE(notifications.size(), 1u) << "smoothing " << static_cast<int>(smoothing);
+        }
+        EXPECT_EQ(meter.Notifications(), meter.Forwarded());
+    }
+}
+
+// A burst of crossings is one decision, and the state the burst settled in is forwarded when the window closes.
+TEST(FilteredThermometerUnit, DebounceMergesBursts) {
+    FakeThermometer sensor;
+    ClockedFilteredThermometer meter(sensor, Settings(Smoothing::None, 10s));
+    std::vector<bool> notifications;
+    meter.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    meter.SetTemperatureThresholds(25_degC, 15_degC);
+
+    // Forwarded at once, then merged.
+    for (Temperature reading : {26_degC, 20_degC, 14_degC, 20_degC, 26_degC}) {
+        sensor.temperature = reading;
+        meter.Poll();
+        FakeClock::Advance(1s);
+    }
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    // The burst ended on the same decision: nothing more to forward.
+    FakeClock::Advance(10s);
+    meter.Poll();
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    // The next crossing is forwarded at once, and a burst ending on the other side at the end of the window.
+    for (Temperature reading : {14_degC, 20_degC, 26_degC, 20_degC}) {
+        sensor.temperature = reading;
+        meter.Poll();
+        FakeClock::Advance(1s);
+    }
+    EXPECT_EQ(notifications, (std::vector<bool>{true, false}));
+    FakeClock::Advance(10s);
+    meter.Poll();
+    EXPECT_EQ(notifications, (std::vector<bool>{true, false, true}));
+    EXPECT_EQ(meter.Notifications(), 5u);
+
+    // New thresholds already exceeded notify at once, even in a window.
+    sensor.temperature = 14_degC;
+    meter.Poll();
+    EXPECT_TRUE(meter.SetTemperatureThresholds(30_degC, 16_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{true, false, true, false}));
+    EXPECT_EQ(meter.Forwarded(), 4u);
+}
+
+// The filtered thermometer drives a thermostat like any other thermometer.
+TEST(FilteredThermometerUnit, DrivesThermostat) {
+    FakeThermometer sensor;
+    sensor.temperature = 20_degC;
+    ClockedFilteredThermometer meter(sensor, Settings(Smoothing::Exponential, 1min));
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+    stat.SetTemperatureThresholds(25_degC, 15_degC);
+    int writes = controller.writes;
+
+    for (int sample = 0; sample < 60; ++sample) {
+        sensor.temperature = Noisy(25_degC, sample);
+        meter.Poll();
+        FakeClock::Advance(5s);
+    }
+    EXPECT_EQ(controller.writes, writes);
+    for (int sample = 0; sample < 60; ++sample) {
+        sensor.temperature = Noisy(28_degC, sample);
+        meter.Poll();
+        FakeClock::Advance(5s);
+    }
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_EQ(controller.writes, writes + 2);
+}
+
+// On a noisy trace hovering on the thresholds, the filter cuts the actuator commands of a replay.
+TEST(FilteredThermometerUnit, ReplayReducesCommands) {
+    Trace trace;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> noise(-8, 8);
+    for (int i = 0; i < 24 * 60; ++i) {
+        // A slow swing between 15 °C and 25 °C, with up to 0.8 °C of noise.
+        double swing = 20.0 + 5.0 * std::sin(i / 120.0);
+        Temperature reading = Temperature::FromCelsiusRounded(swing) + Temperature::FromDeciCelsius(noise(random));
+        trace.push_back(TraceSample{std::chrono::minutes(i), reading});
+    }
+    ReplayConfiguration thresholds = [](ReplayThermostat &stat) { stat.SetTemperatureThresholds(24_degC, 16_degC); };
+
+    CommandStream raw = ReplayTrace(trace, thresholds);
+    FilterSettings settings = Settings(Smoothing::Kalman, 15min);
+    CommandStream filtered = ReplayTrace(trace, thresholds, &settings);
+    EXPECT_GT(raw.size(), 2 * filtered.size());
+    EXPECT_GE(filtered.size(), 4u);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../src/polling_thermometer.h"
+#include "../src/thermostat.h"
+#include "../src/timer_wheel.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Timer recording the ticks at which it fires.
+struct RecordingTimer {
+    TimerNode node;
+    TimerWheel *wheel = nullptr;
+    std::vector<std::uint64_t> fired;
+    std::uint64_t period = 0; // Reschedules itself with this delay when not zero.
+
+    RecordingTimer() {
+        this->node.callback = [](void *context) {
+            RecordingTimer *timer = static_cast<RecordingTimer *>(context);
+            timer->fired.push_back(timer->wheel->Now());
+            if (timer->period != 0) {
+                timer->wheel->Schedule(timer->node, timer->period);
+            }
+        };
+        this->node.context = this;
+    }
+};
+
+} // namespace
+
+// Timers fire exactly at their expiry tick, whichever level of the wheel they were stored in.
+TEST(TimerWheelUnit, FiresAtExpiry) {
+    TimerWheel wheel;
+    std::mt19937 random(7);
+    std::vector<std::unique_ptr<RecordingTimer>> timers;
+    std::vector<std::uint64_t> delays;
+    for (int i = 0; i < 2000; ++i) {
+        timers.push_back(std::make_unique<RecordingTimer>());
+        timers.back()->wheel = &wheel;
+        // Spread the delays over every level.
+        std::uint64_t delay = 1 + random() % ((std::uint64_t(1) << (6 * (1 + i % 4))) - 1);
+        delays.push_back(delay);
+        wheel.Advance(random() % 3);
+        delays.back() += wheel.Now();
+        wheel.Schedule(timers.back()->node, delay);
+    }
+
+    wheel.Advance(1 << 24);
+    EXPECT_EQ(wheel.Size(), 0u);
+    for (std::size_t i = 0; i < timers.size(); ++i) {
+        ASSERT_EQ(timers[i]->fired, (std::vector<std::uint64_t>{delays[i]})) << "timer " << i;
+    }
+}
+
+// Cancelled timers do not fire, timers can reschedule themselves from their callback, and long delays are capped.
+TEST(TimerWheelUnit, CancelRescheduleAndCap) {
+    TimerWheel wheel;
+    RecordingTimer cancelled;
+    RecordingTimer periodic;
+    RecordingTimer distant;
+    cancelled.wheel = periodic.wheel = distant.wheel = &wheel;
+    periodic.period = 100;
+
+    wheel.Schedule(cancelled.node, 10);
+    wheel.Schedule(periodic.node, 100);
+    wheel.Schedule(distant.node, std::uint64_t(1) << 40);
+    wheel.Cancel(cancelled.node);
+    wheel.Advance(350);
+
+    EXPECT_TRUE(cancelled.fired.empty());
+    EXPECT_EQ(periodic.fired, (std::vector<std::uint64_t>{100, 200, 300}));
+    wheel.Cancel(periodic.node);
+
+    wheel.Advance(TimerWheel::maxDelay);
+    EXPECT_EQ(distant.fired, (std::vector<std::uint64_t>{TimerWheel::maxDelay}));
+}
+
+// Polls notify threshold crossings as the Thermometer interface documents.
+TEST(PollingThermometerUnit, NotifiesCrossings) {
+    PollScheduler scheduler(100ms);
+    Temperature sensor = 20_degC;
+    PollingThermometer meter(scheduler, [&sensor]() { return sensor; }, PollingPolicy{1s, 1s});
+    std::vector<bool> notifications;
+    meter.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    EXPECT_TRUE(meter.SetTemperatureThresholds(25_degC, 15_degC));
+
+    sensor = 30_degC;
+    EXPECT_EQ(meter.GetTemperature(), 30_degC);
+    scheduler.Advance(9);
+    EXPECT_TRUE(notifications.empty());
+    scheduler.Advance(1);
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    // Already exceeded thresholds notify when set.
+    EXPECT_TRUE(meter.SetTemperatureThresholds(28_degC, 15_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{true, true}));
+
+    sensor = 10_degC;
+    scheduler.Advance(10);
+    EXPECT_EQ(notifications, (std::vector<bool>{true, true, false}));
+    EXPECT_EQ(meter.Polls(), 2u);
+}
+
+// The poll interval backs off while the temperature is stable, and speeds up when it changes.
+TEST(PollingThermometerUnit, AdaptiveInterval) {
+    PollScheduler scheduler(1s);
+    Temperature sensor = 20_degC;
+    PollingThermometer meter(scheduler, [&sensor]() { return sensor; }, PollingPolicy{1s, 16s});
+    EXPECT_EQ(meter.PollInterval(), 1s);
+
+    scheduler.Advance(1 + 2 + 4 + 8);
+    EXPECT_EQ(meter.Polls(), 4u);
+    EXPECT_EQ(meter.PollInterval(), 16s);
+    scheduler.Advance(16 * 4);
+    EXPECT_EQ(meter.PollInterval(), 16s);
+
+    sensor = 21_degC;
+    scheduler.Advance(16);
+    EXPECT_EQ(meter.PollInterval(), 8s);
+    sensor = 22_degC;
+    scheduler.Advance(8);
+    sensor = 23_degC;
+    scheduler.Advance(4);
+    EXPECT_EQ(meter.PollInterval(), 2s);
+}
+
+// Thousands of thermostats on polled sensors share one scheduler.
+TEST(PollingThermometerUnit, DrivesThermostats) {
+    constexpr int zones = 5000;
+    PollScheduler scheduler(100ms);
+    std::vector<Temperature> sensors(zones, 20_degC);
+    std::vector<std::unique_ptr<PollingThermometer>> meters;
+    std::vector<std::unique_ptr<RecordingTemperatureController>> controllers;
+    std::vector<std::unique_ptr<Thermostat>> stats;
+    for (int i = 0; i < zones; ++i) {
+        PollingPolicy policy{std::chrono::milliseconds(100 * (1 + i % 10)), 10s};
+        meters.push_back(std::make_unique<PollingThermometer>(scheduler, [&sensors, i]() { return sensors[i]; }, policy));
+        controllers.push_back(std::make_unique<RecordingTemperatureController>());
+        stats.push_back(std::make_unique<Thermostat>(*meters.back(), *controllers.back()));
+        stats.back()->SetTemperatureThresholds(25_degC, 15_degC);
+    }
+    EXPECT_EQ(scheduler.ScheduledPolls(), static_cast<std::size_t>(zones));
+
+    for (int i = 0; i < zones; i += 2) {
+        sensors[i] = 10_degC;
+    }
+    // Every sensor is polled within its maximum interval.
+    scheduler.Advance(scheduler.TicksFor(10s));
+    for (int i = 0; i < zones; ++i) {
+        ASSERT_EQ(controllers[i]->heating, i % 2 == 0) << "zone " << i;
+    }
+
+    // The stable sensors backed off towards the maximum interval.
+    std::uint64_t polls = 0;
+    for (const std::unique_ptr<PollingThermometer> &meter : meters) {
+        polls += meter->Polls();
+    }
+    EXPECT_LT(polls, static_cast<std::uint64_t>(zones) * 10);
+}
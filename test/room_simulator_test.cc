@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "../src/room_simulator.h"
+#include "../src/thermostat.h"
+#include "../src/threshold_monitor.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+// Readings crossing a threshold notify the callback once per crossing.
+TEST(ThresholdMonitorUnit, NotifiesCrossings) {
+    ThresholdMonitor monitor(-40_degC, 125_degC);
+    std::vector<bool> notifications;
+    monitor.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    monitor.Update(20_degC);
+    EXPECT_TRUE(monitor.SetThresholds(25_degC, 15_degC));
+
+    for (int reading : {24, 25, 26, 27, 25, 26, 16, 15, 14, 13, 20}) {
+        monitor.Update(Temperature::FromCelsius(reading));
+    }
+    EXPECT_EQ(notifications, (std::vector<bool>{true, true, false}));
+}
+
+// Setting thresholds exceeded by the current temperature notifies immediately, invalid thresholds are rejected
+// and out of range thresholds are clamped to the measurable range.
+TEST(ThresholdMonitorUnit, SetThresholds) {
+    ThresholdMonitor monitor(-40_degC, 125_degC);
+    std::vector<bool> notifications;
+    monitor.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    monitor.Update(30_degC);
+
+    EXPECT_FALSE(monitor.SetThresholds(10_degC, 10_degC));
+    EXPECT_FALSE(monitor.SetThresholds(10_degC, 20_degC));
+    EXPECT_TRUE(notifications.empty());
+
+    EXPECT_TRUE(monitor.SetThresholds(25_degC, 15_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    EXPECT_TRUE(monitor.SetThresholds(1000_degC, -1000_degC));
+    EXPECT_EQ(monitor.HighThreshold(), 125_degC);
+    EXPECT_EQ(monitor.LowThreshold(), -40_degC);
+    EXPECT_EQ(notifications.size(), 1u);
+}
+
+// Without heating the room relaxes to the outside temperature, with heating it settles above it.
+TEST(RoomSimulatorUnit, RoomPhysics) {
+    RoomParameters parameters;
+    parameters.initialTemperature = 20.0;
+    SimulatedRoom room(parameters);
+
+    for (int i = 0; i < 24 * 60; ++i) {
+        room.Step(10min, 0.0);
+    }
+    EXPECT_NEAR(room.Temperature(), 0.0, 0.1);
+    EXPECT_EQ(room.GetThermometer().GetTemperature(), 0_degC);
+
+    room.GetController().Heat(true);
+    for (int i = 0; i < 24 * 60; ++i) {
+        room.Step(10min, 0.0);
+    }
+    EXPECT_NEAR(room.Temperature(), parameters.heaterPower / parameters.conductance, 0.1);
+    EXPECT_EQ(room.GetController().Transitions(), 1u);
+    EXPECT_DOUBLE_EQ(room.HeatingTime().count(), 24.0 * 60.0 * 600.0);
+}
+
+// The simulated thermometer notifies a thermostat, which drives the simulated controller.
+TEST(RoomSimulatorUnit, ThermostatKeepsRoomInBand) {
+    Climate climate;
+    climate.meanTemperature = 5.0;
+    RoomSimulation simulation(climate);
+    SimulatedRoom &room = simulation.AddRoom();
+    Thermostat stat(room.GetThermometer(), room.GetController());
+    ASSERT_TRUE(stat.SetDeadbandMode(21_degC, 2_degC));
+
+    simulation.Run(std::chrono::hours(24 * 7), 1min, 1);
+    EXPECT_EQ(simulation.Now(), std::chrono::hours(24 * 7));
+    EXPECT_GE(room.Temperature(), 18.0);
+    EXPECT_LE(room.Temperature(), 24.0);
+    EXPECT_GT(room.GetController().Transitions(), 0u);
+    EXPECT_GT(room.HeatingTime().count(), 0.0);
+}
+
+// A year of operation of many rooms, split across threads, gives the same result as a single thread.
+TEST(RoomSimulatorUnit, ParallelYear) {
+    constexpr int roomCount = 32;
+    auto runYear = [](unsigned threads) {
+        RoomSimulation simulation;
+        std::vector<std::unique_ptr<Thermostat>> stats;
+        for (int i = 0; i < roomCount; ++i) {
+            RoomParameters parameters;
+            parameters.conductance = 100.0 + 5.0 * i;
+            SimulatedRoom &room = simulation.AddRoom(parameters);
+            stats.push_back(std::make_unique<Thermostat>(room.GetThermometer(), room.GetController()));
+            stats.back()->SetDeadbandMode(21_degC, 1_degC);
+        }
+        simulation.Run(std::chrono::hours(24 * 365), 5min, threads);
+
+        std::vector<std::uint64_t> transitions;
+        for (int i = 0; i < roomCount; ++i) {
+            transitions.push_back(simulation.Room(i).GetController().Transitions());
+        }
+        return transitions;
+    };
+
+    std::vector<std::uint64_t> single = runYear(1);
+    std::vector<std::uint64_t> parallel = runYear(4);
+    EXPECT_EQ(single, parallel);
+    EXPECT_GT(single[0], 0u);
+}
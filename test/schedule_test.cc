@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../src/schedule.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Thermostat recording the thresholds it is given.
+struct RecordingStat {
+    Temperature high;
+    Temperature low;
+    int updates = 0;
+
+    bool SetTemperatureThresholds(Temperature newHigh, Temperature newLow) {
+        this->high = newHigh;
+        this->low = newLow;
+        ++this->updates;
+        return newLow < newHigh;
+    }
+};
+
+using RecordingScheduler = BasicThermostatScheduler<RecordingStat>;
+
+// Office hours on weekdays, setback at night and during the weekend.
+std::vector<ScheduleEntry> Office() {
+    std::vector<ScheduleEntry> periods;
+    for (unsigned day = 0; day < 5; ++day) {
+        periods.push_back(ScheduleEntry{23_degC, 20_degC, WeekMinute(day, 7)});
+        periods.push_back(ScheduleEntry{28_degC, 15_degC, WeekMinute(day, 19)});
+    }
+    return periods;
+}
+
+} // namespace
+
+static_assert(ToScheduleTime(std::chrono::local_days(std::chrono::year(1970) / 1 / 12) + 7h + 30min).count() ==
+              minutesPerWeek + WeekMinute(0, 7, 30));
+
+// Invalid schedules are rejected, identical schedules are stored once and equal consecutive periods are merged.
+TEST(ScheduleTableUnit, Deduplicates) {
+    ScheduleTable table;
+    ScheduleTable::ScheduleId id = 0;
+    EXPECT_FALSE(table.Add({}, id));
+    EXPECT_FALSE(table.Add({{20_degC, 25_degC, 0}}, id));
+    EXPECT_FALSE(table.Add({{25_degC, 20_degC, minutesPerWeek}}, id));
+    EXPECT_FALSE(table.Add({{25_degC, 20_degC, 60}, {26_degC, 20_degC, 60}}, id));
+
+    ScheduleTable::ScheduleId office = 0;
+    ASSERT_TRUE(table.Add(Office(), office));
+    EXPECT_EQ(table.Periods(), 10u);
+    std::vector<ScheduleEntry> periods = Office();
+    std::vector<ScheduleEntry> reversed(periods.rbegin(), periods.rend());
+    ASSERT_TRUE(table.Add(reversed, id));
+    EXPECT_EQ(id, office);
+
+    // A Monday midnight setback continues the Friday evening one, and a second night setback is no transition.
+    std::vector<ScheduleEntry> redundant = Office();
+    redundant.push_back({28_degC, 15_degC, 0});
+    redundant.push_back({28_degC, 15_degC, WeekMinute(0, 22)});
+    ASSERT_TRUE(table.Add(redundant, id));
+    EXPECT_EQ(id, office);
+
+    ScheduleTable::ScheduleId constant = 0;
+    ASSERT_TRUE(table.Add({{24_degC, 18_degC, 0}, {24_degC, 18_degC, 600}}, constant));
+    EXPECT_NE(constant, office);
+    EXPECT_EQ(table.Size(), 2u);
+    EXPECT_EQ(table.Periods(), 11u);
+}
+
+// Lookups find the period in effect in any week, and the start of the next one.
+TEST(ScheduleTableUnit, Lookup) {
+    ScheduleTable table;
+    ScheduleTable::ScheduleId office = 0;
+    ASSERT_TRUE(table.Add(Office(), office));
+    ScheduleTime next;
+
+    // Monday 03:00 is still in the setback that started on Friday evening.
+    ScheduleTime week = ScheduleTime(5 * minutesPerWeek);
+    EXPECT_EQ(table.Lookup(office, week + 3h, next).low, 15_degC);
+    EXPECT_EQ(next, week + 7h);
+    EXPECT_EQ(table.Lookup(office, week + 7h, next).low, 20_degC);
+    EXPECT_EQ(next, week + 19h);
+    EXPECT_EQ(table.Lookup(office, week + ScheduleTime(WeekMinute(5, 12)), next).low, 15_degC);
+    EXPECT_EQ(next, week + ScheduleTime(minutesPerWeek) + 7h);
+    EXPECT_EQ(table.Lookup(office, ScheduleTime(-1), next).low, 15_degC);
+    EXPECT_EQ(next, 7h);
+
+    ScheduleTable::ScheduleId constant = 0;
+    ASSERT_TRUE(table.Add({{24_degC, 18_degC, 600}}, constant));
+    EXPECT_EQ(table.Lookup(constant, week, next).high, 24_degC);
+    EXPECT_EQ(next, ScheduleTime::max());
+}
+
+// Attached thermostats get the current period, and only the thermostats whose period changes are visited.
+TEST(ThermostatSchedulerUnit, AppliesTransitions) {
+    ScheduleTable table;
+    ScheduleTable::ScheduleId office = 0;
+    ScheduleTable::ScheduleId constant = 0;
+    ASSERT_TRUE(table.Add(Office(), office));
+    ASSERT_TRUE(table.Add({{24_degC, 18_degC, 0}}, constant));
+
+    std::vector<RecordingStat> stats(4);
+    RecordingScheduler scheduler(table, 3, 6h);
+    RecordingScheduler::ZoneId zone = 0;
+    ASSERT_TRUE(scheduler.Attach(stats[0], office, zone));
+    ASSERT_TRUE(scheduler.Attach(stats[1], office, zone));
+    ASSERT_TRUE(scheduler.Attach(stats[2], constant, zone));
+    EXPECT_FALSE(scheduler.Attach(stats[3], office, zone));
+    EXPECT_EQ(stats[0].low, 15_degC);
+    EXPECT_EQ(stats[2].high, 24_degC);
+
+    EXPECT_EQ(scheduler.Advance(6h + 59min), 0u);
+    EXPECT_EQ(scheduler.Advance(7h), 2u);
+    EXPECT_EQ(stats[0].low, 20_degC);
+    EXPECT_EQ(stats[1].low, 20_degC);
+    EXPECT_EQ(stats[2].updates, 1);
+
+    // After a gap only the current period is applied.
+    EXPECT_EQ(scheduler.Advance(ScheduleTime(WeekMinute(2, 8))), 2u);
+    EXPECT_EQ(stats[0].low, 20_degC);
+    EXPECT_EQ(stats[0].updates, 3);
+
+    // A detached thermostat is left alone, and its slot is reused.
+    scheduler.Detach(1);
+    EXPECT_EQ(scheduler.Size(), 2u);
+    EXPECT_EQ(scheduler.Advance(ScheduleTime(WeekMinute(2, 19))), 1u);
+    EXPECT_EQ(stats[1].low, 20_degC);
+    ASSERT_TRUE(scheduler.Attach(stats[3], office, zone));
+    EXPECT_EQ(zone, 1u);
+    EXPECT_EQ(stats[3].low, 15_degC);
+
+    EXPECT_FALSE(scheduler.SetSchedule(0, 7));
+    ASSERT_TRUE(scheduler.SetSchedule(0, constant));
+    EXPECT_EQ(stats[0].high, 24_degC);
+    EXPECT_EQ(scheduler.Advance(ScheduleTime(WeekMinute(3, 7))), 1u);
+    EXPECT_EQ(stats[3].low, 20_degC);
+}
+
+// A schedule drives a thermostat: the morning period raises the low threshold and starts heating.
+TEST(ThermostatSchedulerUnit, DrivesThermostat) {
+    ScheduleTable table;
+    ScheduleTable::ScheduleId office = 0;
+    ASSERT_TRUE(table.Add(Office(), office));
+    FakeThermometer meter;
+    meter.temperature = 18_degC;
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+
+    ThermostatScheduler scheduler(table, 1, 0min);
+    ThermostatScheduler::ZoneId zone = 0;
+    ASSERT_TRUE(scheduler.Attach(stat, office, zone));
+    EXPECT_FALSE(controller.heating);
+    scheduler.Advance(7h);
+    EXPECT_TRUE(controller.heating);
+    EXPECT_EQ(meter.low, 20_degC);
+    scheduler.Advance(19h);
+    EXPECT_EQ(meter.low, 15_degC);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../src/sharded_executor.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+// Events of one shard, checking that they are handled in order and never by two threads at once.
+struct ShardLog {
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    std::vector<int> order;
+    int next = 0;
+};
+
+void LogEvent(void *context, bool) {
+    ShardLog *log = static_cast<ShardLog *>(context);
+    if (log->inside.fetch_add(1) != 0) {
+        log->overlapped = true;
+    }
+    log->order.push_back(log->next++);
+    std::this_thread::yield();
+    log->inside.fetch_sub(1);
+}
+
+// Blocks the worker that handles it until the flag is set, at most a few seconds so a failure cannot hang.
+void BlockEvent(void *context, bool) {
+    std::atomic<bool> *released = static_cast<std::atomic<bool> *>(context);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!released->load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void ReleaseEvent(void *context, bool) {
+    static_cast<std::atomic<bool> *>(context)->store(true);
+}
+
+struct Zone {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    std::unique_ptr<Thermostat> stat;
+};
+
+} // namespace
+
+// Zones are spread over the shards, and each zone always maps to the same loop.
+TEST(ShardedExecutorUnit, RoutesZones) {
+    ShardedExecutor executor(4, 2);
+    EXPECT_EQ(executor.Shards(), 4u);
+    EXPECT_EQ(executor.Workers(), 2u);
+    EXPECT_EQ(executor.ShardOf(6), 2u);
+    EXPECT_EQ(&executor.LoopFor(6), &executor.Loop(2));
+    EXPECT_NE(&executor.LoopFor(6), &executor.LoopFor(7));
+    EXPECT_EQ(ShardedExecutor(0, 1).Shards(), 1u);
+}
+
+// Each shard handles its events in order, one at a time, whichever workers pick them up.
+TEST(ShardedExecutorUnit, SerializesShards) {
+    ShardedExecutor executor(8, 4, 4096, 16);
+    std::vector<ShardLog> logs(8);
+    executor.Start();
+
+    std::vector<std::thread> sensors;
+    for (int t = 0; t < 4; ++t) {
+        sensors.emplace_back([&executor, &logs, t]() {
+            for (std::uint32_t zone = t; zone < 8; zone += 4) {
+                for (int i = 0; i < 500; ++i) {
+                    executor.LoopFor(zone).Send(&LogEvent, &logs[zone], true);
+                }
+            }
+        });
+    }
+    for (std::thread &sensor : sensors) {
+        sensor.join();
+    }
+    executor.WaitIdle();
+
+    for (ShardLog &log : logs) {
+        EXPECT_FALSE(log.overlapped);
+        ASSERT_EQ(log.order.size(), 500u);
+        for (int i = 0; i < 500; ++i) {
+            EXPECT_EQ(log.order[i], i);
+        }
+    }
+}
+
+// While a worker is busy on one of its shards, its other shard is stolen by the idle worker.
+TEST(ShardedExecutorUnit, StealsFromBusyWorker) {
+    ShardedExecutor executor(4, 2, 64, 4);
+    std::atomic<bool> released(false);
+
+    // Shards 0 and 2 belong to worker 0. Whichever shard worker 0 takes first, it blocks until the other is handled.
+    executor.LoopFor(0).Post(&BlockEvent, &released, true);
+    executor.LoopFor(2).Post(&ReleaseEvent, &released, true);
+    executor.Start();
+    executor.WaitIdle();
+
+    EXPECT_TRUE(released);
+    EXPECT_GE(executor.Steals(), 1u);
+}
+
+// Threaded thermostats run on the shards of their zones, and events queued when stopping are still handled.
+TEST(ShardedExecutorUnit, DrivesThermostats) {
+    ShardedExecutor executor(4, 2);
+    std::vector<Zone> zones(16);
+    for (std::uint32_t i = 0; i < zones.size(); ++i) {
+        zones[i].stat = std::make_unique<Thermostat>(zones[i].meter, zones[i].controller, executor.LoopFor(i));
+    }
+    executor.Start();
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        zones[i].meter.SetTemperature(i % 2 == 0 ? 50_degC : 0_degC);
+    }
+    executor.WaitIdle();
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        EXPECT_EQ(zones[i].controller.cooling, i % 2 == 0);
+        EXPECT_EQ(zones[i].controller.heating, i % 2 == 1);
+    }
+
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        zones[i].meter.SetTemperature(20_degC);
+        zones[i].meter.SetTemperature(i % 2 == 0 ? 0_degC : 50_degC);
+    }
+    executor.Stop();
+    std::uint64_t processed = 0;
+    for (ShardedExecutor::ShardId shard = 0; shard < executor.Shards(); ++shard) {
+        processed += executor.Loop(shard).GetStats().processed;
+    }
+    EXPECT_EQ(processed, 2 * zones.size());
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        EXPECT_EQ(zones[i].controller.heating, i % 2 == 0);
+    }
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/sysfs_thermometer.h"
+#include "../src/thermostat.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Fake sysfs tree in the test temporary directory, removed when the test ends.
+class FakeSysfs {
+public:
+    std::filesystem::path root;
+
+    explicit FakeSysfs(const std::string &name): root(testing::TempDir() + name) {
+        std::filesystem::remove_all(this->root);
+        this->Write("class/hwmon/hwmon0/name", "coretemp");
+        this->Write("class/hwmon/hwmon0/temp1_input", "45000");
+        this->Write("class/hwmon/hwmon0/temp1_label", "Package id 0");
+        this->Write("class/hwmon/hwmon0/temp2_input", "-1500");
+        this->Write("class/hwmon/hwmon0/fan1_input", "1200");
+        this->Write("class/thermal/thermal_zone0/type", "acpitz");
+        this->Write("class/thermal/thermal_zone0/temp", "27800");
+        this->Write("class/thermal/cooling_device0/cur_state", "0");
+    }
+    ~FakeSysfs() { std::filesystem::remove_all(this->root); }
+
+    std::string Path(const std::string &file) const { return (this->root / file).string(); }
+
+    // Rewrites a file in place, as the kernel updates an attribute.
+    void Write(const std::string &file, const std::string &content) {
+        std::filesystem::create_directories((this->root / file).parent_path());
+        std::ofstream(this->root / file) << content << "\n";
+    }
+};
+
+} // namespace
+
+// Temperature files of hwmon devices and thermal zones are found with their labels, other attributes are not.
+TEST(SysfsThermometerUnit, Discovery) {
+    FakeSysfs sysfs("sysfs_discovery");
+    std::vector<SysfsSensor> sensors = DiscoverSysfsSensors(sysfs.root.string());
+    ASSERT_EQ(sensors.size(), 3u);
+    EXPECT_EQ(sensors[0].path, sysfs.Path("class/hwmon/hwmon0/temp1_input"));
+    EXPECT_EQ(sensors[0].label, "coretemp Package id 0");
+    EXPECT_EQ(sensors[1].label, "coretemp temp2");
+    EXPECT_EQ(sensors[2].path, sysfs.Path("class/thermal/thermal_zone0/temp"));
+    EXPECT_EQ(sensors[2].label, "acpitz");
+
+    EXPECT_TRUE(DiscoverSysfsSensors(sysfs.Path("missing")).empty());
+}
+
+// Millidegrees are rounded to the nearest tenth of a degree, and anything else is rejected.
+TEST(SysfsThermometerUnit, Parse) {
+    Temperature temperature;
+    EXPECT_TRUE(SysfsThermometer::ParseMillidegrees("45499\n", 6, temperature));
+    EXPECT_EQ(temperature, 45.5_degC);
+    EXPECT_TRUE(SysfsThermometer::ParseMillidegrees("-1549", 5, temperature));
+    EXPECT_EQ(temperature, -1.5_degC);
+    EXPECT_FALSE(SysfsThermometer::ParseMillidegrees("", 0, temperature));
+    EXPECT_FALSE(SysfsThermometer::ParseMillidegrees("12a", 3, temperature));
+}
+
+// The file stays open and is re-read, and samples notify crossings as the Thermometer interface documents.
+TEST(SysfsThermometerUnit, ReadsAndNotifies) {
+    FakeSysfs sysfs("sysfs_reads");
+    SysfsReactor reactor;
+    SysfsThermometer meter(reactor);
+    EXPECT_FALSE(meter.Open(sysfs.Path("class/hwmon/hwmon0/temp9_input")));
+    sysfs.Write("class/hwmon/hwmon0/temp3_input", "garbage");
+    EXPECT_FALSE(meter.Open(sysfs.Path("class/hwmon/hwmon0/temp3_input")));
+
+    ASSERT_TRUE(meter.Open(sysfs.Path("class/thermal/thermal_zone0/temp")));
+    EXPECT_EQ(reactor.Size(), 1u);
+    EXPECT_EQ(meter.GetTemperature(), 27.8_degC);
+    std::vector<bool> notifications;
+    meter.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    EXPECT_TRUE(meter.SetTemperatureThresholds(30_degC, 20_degC));
+
+    sysfs.Write("class/thermal/thermal_zone0/temp", "31000");
+    EXPECT_EQ(meter.GetTemperature(), 31_degC);
+    EXPECT_TRUE(notifications.empty());
+    reactor.Sample();
+    reactor.Sample();
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    // Already exceeded thresholds notify when set, and unreadable content keeps the last reading.
+    EXPECT_TRUE(meter.SetTemperatureThresholds(32_degC, 20_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+    sysfs.Write("class/thermal/thermal_zone0/temp", "");
+    EXPECT_EQ(meter.GetTemperature(), 31_degC);
+
+    meter.Close();
+    EXPECT_EQ(reactor.Size(), 0u);
+}
+
+// One reactor thread samples every sensor and drives the thermostats.
+TEST(SysfsThermometerUnit, ReactorDrivesThermostats) {
+    FakeSysfs sysfs("sysfs_reactor");
+    SysfsReactor reactor(5ms);
+    std::vector<SysfsSensor> sensors = DiscoverSysfsSensors(sysfs.root.string());
+    std::vector<std::unique_ptr<SysfsThermometer>> meters;
+    std::vector<std::unique_ptr<RecordingTemperatureController>> controllers;
+    std::vector<std::unique_ptr<Thermostat>> stats;
+    for (const SysfsSensor &sensor : sensors) {
+        meters.push_back(std::make_unique<SysfsThermometer>(reactor));
+        ASSERT_TRUE(meters.back()->Open(sensor.path));
+        controllers.push_back(std::make_unique<RecordingTemperatureController>());
+        stats.push_back(std::make_unique<Thermostat>(*meters.back(), *controllers.back()));
+        stats.back()->SetTemperatureThresholds(50_degC, 0_degC);
+    }
+    ASSERT_TRUE(reactor.Start());
+
+    sysfs.Write("class/hwmon/hwmon0/temp1_input", "60000");
+    // The metrics are safe to read while the reactor runs, the controllers are not.
+    for (int i = 0; i < 400 && stats[0]->GetMetrics().callbacks == 0; ++i) {
+        std::this_thread::sleep_for(5ms);
+    }
+    reactor.Stop();
+    EXPECT_TRUE(controllers[0]->cooling);
+    EXPECT_TRUE(controllers[1]->heating);
+    EXPECT_FALSE(controllers[2]->heating || controllers[2]->cooling);
+}
+
+// A callback closing a thermometer, itself or one sampled earlier, does not skip the next thermometer.
+TEST(SysfsThermometerUnit, CloseFromCallback) {
+    FakeSysfs sysfs("sysfs_close");
+    SysfsReactor reactor;
+    std::vector<std::unique_ptr<SysfsThermometer>> meters;
+    std::vector<int> notifications(4, 0);
+    for (int i = 0; i < 4; ++i) {
+        std::string file = "class/thermal/thermal_zone" + std::to_string(i) + "/temp";
+        sysfs.Write(file, "20000");
+        meters.push_back(std::make_unique<SysfsThermometer>(reactor));
+        ASSERT_TRUE(meters.back()->Open(sysfs.Path(file)));
+        EXPECT_TRUE(meters.back()->SetTemperatureThresholds(30_degC, 10_degC));
+    }
+    // The first closes itself, the third closes the first two.
+    meters[0]->RegisterCallback([&](bool) { ++notifications[0]; meters[0]->Close(); });
+    meters[1]->RegisterCallback([&](bool) { ++notifications[1]; });
+    meters[2]->RegisterCallback([&](bool) { ++notifications[2]; meters[1]->Close(); meters[0]->Close(); });
+    meters[3]->RegisterCallback([&](bool) { ++notifications[3]; });
+
+    for (int i = 0; i < 4; ++i) {
+        sysfs.Write("class/thermal/thermal_zone" + std::to_string(i) + "/temp", "35000");
+    }
+    reactor.Sample();
+    EXPECT_EQ(notifications, (std::vector<int>{1, 1, 1, 1}));
+    EXPECT_EQ(reactor.Size(), 2u);
+    meters[2]->Close();
+    EXPECT_EQ(reactor.Size(), 1u);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/telemetry_log.h"
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+// Log file in the test temporary directory, removed when the test ends.
+class TelemetryFile {
+public:
+    std::string path;
+
+    explicit TelemetryFile(const std::string &name): path(testing::TempDir() + name) { std::remove(this->path.c_str()); }
+    ~TelemetryFile() { std::remove(this->path.c_str()); }
+};
+
+std::vector<TelemetryRecord> ReadAll(TelemetryReader &reader) {
+    std::vector<TelemetryRecord> records;
+    reader.ReadFrom(1, [&records](const TelemetryRecord &record) { records.push_back(record); });
+    return records;
+}
+
+} // namespace
+
+// Records are read back in order with their values.
+TEST(TelemetryLogUnit, AppendAndRead) {
+    TelemetryFile file("append_and_read.tlm");
+    TelemetryLog log;
+    ASSERT_TRUE(log.Open(file.path, 16));
+    log.Append(7, TelemetryEvent::Reading, 21, 0);
+    log.Append(7, TelemetryEvent::Actuation, 1, 0);
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    EXPECT_EQ(reader.Capacity(), 16u);
+    EXPECT_EQ(reader.NextSequence(), 3u);
+
+    std::vector<TelemetryRecord> records = ReadAll(reader);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].sequence, 1u);
+    EXPECT_EQ(records[0].thermostat, 7u);
+    EXPECT_EQ(records[0].event, TelemetryEvent::Reading);
+    EXPECT_EQ(records[0].first, 21);
+    EXPECT_EQ(records[1].sequence, 2u);
+    EXPECT_EQ(records[1].event, TelemetryEvent::Actuation);
+    EXPECT_EQ(records[1].first, 1);
+    EXPECT_LE(records[0].timestamp, records[1].timestamp);
+}
+
+// Once the ring is full the oldest records are overwritten and counted as lost by the reader.
+TEST(TelemetryLogUnit, RingWrapsAround) {
+    TelemetryFile file("ring_wraps_around.tlm");
+    TelemetryLog log;
+    ASSERT_TRUE(log.Open(file.path, 5));
+    for (int i = 1; i <= 20; ++i) {
+        log.Append(0, TelemetryEvent::Reading, i, 0);
+    }
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    EXPECT_EQ(reader.Capacity(), 8u);
+    std::vector<TelemetryRecord> records = ReadAll(reader);
+    ASSERT_EQ(records.size(), 8u);
+    EXPECT_EQ(records.front().first, 13);
+    EXPECT_EQ(records.back().first, 20);
+    EXPECT_EQ(reader.Lost(), 12u);
+}
+
+// Reopening a log continues after its last record; a different capacity or a foreign file is rejected.
+TEST(TelemetryLogUnit, Reopen) {
+    TelemetryFile file("reopen.tlm");
+    {
+        TelemetryLog log;
+        ASSERT_TRUE(log.Open(file.path, 16));
+        log.Append(1, TelemetryEvent::Enable, 1, 0);
+    }
+    TelemetryLog log;
+    EXPECT_FALSE(log.Open(file.path, 32));
+    ASSERT_TRUE(log.Open(file.path, 16));
+    log.Append(1, TelemetryEvent::Enable, 0, 0);
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    std::vector<TelemetryRecord> records = ReadAll(reader);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].sequence, 2u);
+    EXPECT_EQ(records[1].first, 0);
+
+    TelemetryFile foreign("foreign.tlm");
+    std::ofstream(foreign.path) << "not a telemetry log";
+    EXPECT_FALSE(reader.Open(foreign.path));
+    EXPECT_FALSE(log.Open(foreign.path, 16));
+}
+
+// A record claimed but not committed when the writer stopped blocks readers until the log is reopened, which
+// seals it as lost.
+TEST(TelemetryLogUnit, IncompleteRecordAfterCrash) {
+    TelemetryFile file("incomplete_record.tlm");
+    {
+        TelemetryLog log;
+        ASSERT_TRUE(log.Open(file.path, 16));
+        for (int i = 1; i <= 3; ++i) {
+            log.Append(0, TelemetryEvent::Reading, i, 0);
+        }
+    }
+    // Clear the sequence of the last record, as if the writer died while copying it.
+    {
+        std::fstream stream(file.path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(sizeof(TelemetryLogHeader) + 2 * sizeof(TelemetryRecord));
+        std::uint64_t zero = 0;
+        stream.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
+    }
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    EXPECT_EQ(ReadAll(reader).size(), 2u);
+
+    TelemetryLog log;
+    ASSERT_TRUE(log.Open(file.path, 16));
+    std::vector<TelemetryRecord> records = ReadAll(reader);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[2].event, TelemetryEvent::Lost);
+}
+
+// A reader tailing the log while it is written sees every record it did not fall behind on, in order and intact.
+TEST(TelemetryLogUnit, ReadWhileWriting) {
+    TelemetryFile file("read_while_writing.tlm");
+    TelemetryLog log;
+    ASSERT_TRUE(log.Open(file.path, 1024));
+    constexpr int total = 200000;
+
+    std::thread writer([&log]() {
+        for (int i = 1; i <= total; ++i) {
+            log.Append(static_cast<std::uint32_t>(i), TelemetryEvent::Reading, i, -i);
+        }
+    });
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    std::uint64_t next = 1;
+    std::uint64_t seen = 0;
+    bool intact = true;
+    std::uint64_t previous = 0;
+    while (next <= total) {
+        next = reader.ReadFrom(next, [&](const TelemetryRecord &record) {
+            intact = intact && record.sequence > previous && record.first == static_cast<int>(record.sequence) &&
+                     record.second == -record.first && record.thermostat == record.sequence;
+            previous = record.sequence;
+            ++seen;
+        });
+    }
+    writer.join();
+
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(seen + reader.Lost(), static_cast<std::uint64_t>(total));
+}
+
+// An attached thermostat records its readings, notifications, threshold changes, enable toggles and decisions.
+TEST(TelemetryLogUnit, ThermostatEvents) {
+    TelemetryFile file("thermostat_events.tlm");
+    TelemetryLog log;
+    ASSERT_TRUE(log.Open(file.path, 64));
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+    stat.AttachTelemetry(&log, 42);
+
+    meter.SetTemperature(50_degC);
+    stat.EnableThermostat(false);
+    stat.EnableThermostat(true);
+    ASSERT_TRUE(stat.SetTemperatureThresholds(60_degC, 0_degC));
+
+    TelemetryReader reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    std::vector<TelemetryRecord> records = ReadAll(reader);
+    std::vector<TelemetryEvent> events;
+    for (const TelemetryRecord &record : records) {
+        EXPECT_EQ(record.thermostat, 42u);
+        events.push_back(record.event);
+    }
+    EXPECT_EQ(events, (std::vector<TelemetryEvent>{
+            TelemetryEvent::Alarm, TelemetryEvent::Actuation,
+            TelemetryEvent::Enable,
+            TelemetryEvent::Enable, TelemetryEvent::Reading, TelemetryEvent::Actuation,
+            TelemetryEvent::Thresholds}));
+    EXPECT_EQ(records[1].second, 1);
+    EXPECT_EQ(records[4].first, (50_degC).DeciCelsius());
+    EXPECT_EQ(records[6].first, (60_degC).DeciCelsius());
+    EXPECT_EQ(records[6].second, 0);
+}
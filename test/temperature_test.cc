@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "../src/temperature.h"
+
+using namespace temperature_literals;
+
+// Conversions are usable in constant expressions.
+static_assert(Temperature::FromCelsius(21).DeciCelsius() == 210);
+static_assert(21.5_degC == Temperature::FromDeciCelsius(215));
+static_assert(212_degF == 100_degC);
+static_assert(Temperature::FromFahrenheit(-40) == -40_degC);
+static_assert((22_degC - 2_degC) < 20.1_degC);
+
+// Conversions between units round half away from zero.
+TEST(TemperatureUnit, Conversions) {
+    EXPECT_EQ(Temperature::FromMilliCelsius(45449), 45.4_degC);
+    EXPECT_EQ(Temperature::FromMilliCelsius(45450), 45.5_degC);
+    EXPECT_EQ(Temperature::FromMilliCelsius(-1550), -1.6_degC);
+    EXPECT_EQ(Temperature::FromCelsiusRounded(-0.04), 0_degC);
+    EXPECT_EQ((21.5_degC).Celsius(), 22);
+    EXPECT_EQ((-21.5_degC).Celsius(), -22);
+    EXPECT_EQ((21.5_degC).MilliCelsius(), 21500);
+    EXPECT_DOUBLE_EQ((21.5_degC).ToCelsius(), 21.5);
+
+    EXPECT_EQ(70_degF, 21.1_degC);
+    EXPECT_EQ(70.5_degF, 21.4_degC);
+    EXPECT_EQ((21.1_degC).Fahrenheit(), 70);
+    EXPECT_EQ((21.1_degC).DeciFahrenheit(), 700);
+    EXPECT_EQ((-17.8_degC).DeciFahrenheit(), 0);
+}
+
+// Differences and sums stay in tenths, and the extremes order below and above everything else.
+TEST(TemperatureUnit, Arithmetic) {
+    Temperature setpoint = 21_degC;
+    setpoint += 0.5_degC;
+    EXPECT_EQ(setpoint, 21.5_degC);
+    setpoint -= 1_degC;
+    EXPECT_EQ(setpoint - 0.5_degC, 20_degC);
+    EXPECT_EQ(-setpoint, -20.5_degC);
+    EXPECT_LT(Temperature::Lowest(), -273_degC);
+    EXPECT_GT(Temperature::Highest(), 1000_degC);
+}
+
+// A calibration maps ADC counts to temperatures and back.
+TEST(TemperatureUnit, AdcCalibration) {
+    constexpr AdcCalibration calibration{500, 20};
+    static_assert(calibration.ToTemperature(500) == 0_degC);
+    EXPECT_EQ(calibration.ToTemperature(920), 21_degC);
+    EXPECT_EQ(calibration.ToTemperature(931), 21.6_degC);
+    EXPECT_EQ(calibration.ToTemperature(300), -10_degC);
+    EXPECT_EQ(calibration.ToCounts(21.5_degC), 930);
+    EXPECT_EQ(calibration.ToCounts(-10_degC), 300);
+}
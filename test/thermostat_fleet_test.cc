@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include "../src/thermostat.h"
+#include "../src/thermostat_fleet.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+// Demonstrate happy scenario.
+TEST(ThermostatFleetUnit, Happy) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+
+    fleet.AddZone(20_degC);
+    fleet.Evaluate(changes);
+
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].zone, 0u);
+    EXPECT_FALSE(changes[0].heat);
+    EXPECT_FALSE(changes[0].cool);
+}
+
+// Initial temperature read as above high threshold, or below low threshold
+TEST(ThermostatFleetUnit, StartWithHighAndLowTemp) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+
+    fleet.AddZone(50_degC);
+    fleet.AddZone(-10_degC);
+    fleet.Evaluate(changes);
+
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_FALSE(changes[0].heat);
+    EXPECT_TRUE(changes[0].cool);
+    EXPECT_TRUE(changes[1].heat);
+    EXPECT_FALSE(changes[1].cool);
+}
+
+// Unchanged zones are not reported once their first state was written
+TEST(ThermostatFleetUnit, OnlyChangesAreReported) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+
+    for (int i = 0; i < 100; ++i) {
+        fleet.AddZone(20_degC);
+    }
+    fleet.Evaluate(changes);
+    EXPECT_EQ(changes.size(), 100u);
+
+    std::vector<Temperature> readings(100, 25_degC);
+    readings[42] = 45_degC;
+    readings[7] = 5_degC;
+    fleet.SetReadings(readings.data(), readings.size());
+    fleet.Evaluate(changes);
+
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].zone, 7u);
+    EXPECT_TRUE(changes[0].heat);
+    EXPECT_EQ(changes[1].zone, 42u);
+    EXPECT_TRUE(changes[1].cool);
+
+    fleet.Evaluate(changes);
+    EXPECT_TRUE(changes.empty());
+}
+
+// Receive notifications when temperature thresholds are breached
+TEST(ThermostatFleetUnit, HeatAndCoolSequence) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+    ThermostatFleet::ZoneId zone = fleet.AddZone(20_degC);
+    fleet.Evaluate(changes);
+
+    // Every notification writes the actuators, even if the state is unchanged, as Thermostat does.
+    for (bool isHigh : {true, true, false, true, false, false}) {
+        fleet.ThermometerCallback(zone, isHigh);
+        fleet.Evaluate(changes);
+        ASSERT_EQ(changes.size(), 1u);
+        EXPECT_EQ(changes[0].heat, !isHigh);
+        EXPECT_EQ(changes[0].cool, isHigh);
+    }
+}
+
+// Check whether invalid values for threshold configuration are rejected
+TEST(ThermostatFleetUnit, InvalidThresholds) {
+    ThermostatFleet fleet;
+    ThermostatFleet::ZoneId zone = fleet.AddZone(20_degC);
+
+    EXPECT_EQ(fleet.SetTemperatureThresholds(zone, -5_degC, 0_degC), false);
+    EXPECT_EQ(fleet.SetTemperatureThresholds(zone, 10_degC, 10_degC), false);
+    EXPECT_EQ(fleet.SetTemperatureThresholds(zone, 5_degC, 10_degC), false);
+    EXPECT_EQ(fleet.SetTemperatureThresholds(zone, 20_degC, 15_degC), true);
+}
+
+// Check that the actuators are left alone while a zone is disabled, and written again when it is reenabled
+TEST(ThermostatFleetUnit, ReenableZone) {
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+    ThermostatFleet::ZoneId zone = fleet.AddZone(20_degC);
+    fleet.Evaluate(changes);
+
+    fleet.EnableZone(zone, false);
+    fleet.ThermometerCallback(zone, true);
+    fleet.SetReading(zone, -10_degC);
+    fleet.Evaluate(changes);
+    EXPECT_TRUE(changes.empty());
+
+    fleet.EnableZone(zone, true);
+    fleet.Evaluate(changes);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_TRUE(changes[0].heat);
+    EXPECT_FALSE(changes[0].cool);
+}
+
+// Drive Thermostat objects and a fleet with the same random operations and check they reach the same decisions.
+TEST(ThermostatFleetUnit, MatchesThermostat) {
+    constexpr int zones = 64;
+    std::vector<std::unique_ptr<FakeThermometer>> meters;
+    std::vector<std::unique_ptr<RecordingTemperatureController>> controllers;
+    std::vector<std::unique_ptr<Thermostat>> stats;
+    ThermostatFleet fleet;
+    std::vector<ActuatorChange> changes;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> temperature(-20, 60);
+
+    for (int i = 0; i < zones; ++i) {
+        meters.push_back(std::make_unique<FakeThermometer>());
+        controllers.push_back(std::make_unique<RecordingTemperatureController>());
+        meters[i]->temperature = Temperature::FromCelsius(temperature(rng));
+        stats.push_back(std::make_unique<Thermostat>(*meters[i], *controllers[i]));
+        fleet.AddZone(meters[i]->temperature);
+        // Route every thermometer notification, including the ones fired when thresholds change, to both.
+        std::shared_ptr<TemperatureCallback> callback = std::make_shared<TemperatureCallback>(meters[i]->callback);
+        meters[i]->callback = [callback, &fleet, i](bool isHigh) {
+            (*callback)(isHigh);
+            fleet.ThermometerCallback(i, isHigh);
+        };
+    }
+    fleet.Evaluate(changes);
+
+    for (int round = 0; round < 200; ++round) {
+        std::vector<int> writes(zones);
+        for (int i = 0; i < zones; ++i) {
+            writes[i] = controllers[i]->writes;
+            switch (rng() % 4) {
+            case 0:
+                meters[i]->callback(rng() % 2);
+                break;
+            case 1: {
+                Temperature low = Temperature::FromCelsius(temperature(rng));
+                Temperature high = low + Temperature::FromCelsius(static_cast<int>(rng() % 20) - 5);
+                EXPECT_EQ(stats[i]->SetTemperatureThresholds(high, low), fleet.SetTemperatureThresholds(i, high, low));
+                break;
+            }
+            case 2: {
+                bool on = rng() % 2;
+                meters[i]->temperature = Temperature::FromCelsius(temperature(rng));
+                fleet.SetReading(i, meters[i]->temperature);
+                stats[i]->EnableThermostat(on);
+                fleet.EnableZone(i, on);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        fleet.Evaluate(changes);
+        for (const ActuatorChange &change : changes) {
+            EXPECT_NE(writes[change.zone], controllers[change.zone]->writes);
+        }
+        for (int i = 0; i < zones; ++i) {
+            EXPECT_EQ(fleet.IsHeating(i), controllers[i]->heating) << "zone " << i << " round " << round;
+            EXPECT_EQ(fleet.IsCooling(i), controllers[i]->cooling) << "zone " << i << " round " << round;
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include "../src/thermostat.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Times every event, so latency counts match the counters.
+using MeasuredThermostat = BasicThermostat<Thermometer, TemperatureController, std::chrono::steady_clock,
+                                           BasicThermostatMetrics<1>>;
+using UnmeasuredThermostat = BasicThermostat<Thermometer, TemperatureController, std::chrono::steady_clock,
+                                             NullThermostatMetrics>;
+
+} // namespace
+
+static_assert(std::is_empty_v<NullThermostatMetrics>);
+static_assert(sizeof(UnmeasuredThermostat) < sizeof(MeasuredThermostat));
+
+// Latencies are counted in power of two buckets, percentiles report the bucket upper bound.
+TEST(ThermostatMetricsUnit, LatencyHistogram) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.Snapshot().Count(), 0u);
+    EXPECT_EQ(histogram.Snapshot().Percentile(0.5), 0ns);
+
+    histogram.Record(1ns);
+    histogram.Record(3ns);
+    histogram.Record(1000ns);
+    histogram.Record(-5ns);
+
+    LatencyHistogramSnapshot snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.Count(), 4u);
+    EXPECT_EQ(snapshot.buckets[0], 2u);
+    EXPECT_EQ(snapshot.buckets[1], 1u);
+    EXPECT_EQ(snapshot.buckets[9], 1u);
+    EXPECT_EQ(snapshot.Percentile(0.5), 4ns);
+    EXPECT_EQ(snapshot.Percentile(0.99), 1024ns);
+}
+
+// Each hot path updates its counter and latency histogram.
+TEST(ThermostatMetricsUnit, CountsHotPaths) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    MeasuredThermostat stat(meter, controller);
+
+    ThermostatMetricsSnapshot metrics = stat.GetMetrics();
+    EXPECT_EQ(metrics.callbacks, 0u);
+    EXPECT_EQ(metrics.manualChecks, 1u);
+    EXPECT_EQ(metrics.actuatorCalls, 1u);
+    EXPECT_EQ(metrics.thresholdUpdates, 1u);
+
+    meter.SetTemperature(50_degC);
+    stat.EnableThermostat(false);
+    meter.SetTemperature(20_degC);
+    meter.SetTemperature(-5_degC);
+    stat.EnableThermostat(true);
+    // The current temperature is below the new low threshold, so the thermometer notifies straight away.
+    ASSERT_TRUE(stat.SetTemperatureThresholds(30_degC, 0_degC));
+
+    metrics = stat.GetMetrics();
+    EXPECT_EQ(metrics.callbacks, 3u);
+    EXPECT_EQ(metrics.ignoredCallbacks, 1u);
+    EXPECT_EQ(metrics.manualChecks, 2u);
+    EXPECT_EQ(metrics.actuatorCalls, 4u);
+    EXPECT_EQ(metrics.thresholdUpdates, 2u);
+    EXPECT_EQ(metrics.callbackLatency.Count(), metrics.callbacks - metrics.ignoredCallbacks);
+    EXPECT_EQ(metrics.actuatorLatency.Count(), metrics.actuatorCalls);
+    EXPECT_EQ(metrics.thresholdLatency.Count(), metrics.thresholdUpdates);
+    EXPECT_TRUE(controller.heating);
+}
+
+// Deadband mode re-arms the thermometer on every transition, which counts as a threshold update.
+TEST(ThermostatMetricsUnit, CountsDeadbandThresholdUpdates) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    MeasuredThermostat stat(meter, controller);
+    ASSERT_TRUE(stat.SetDeadbandMode(21_degC, 2_degC));
+
+    meter.SetTemperature(18_degC);
+    meter.SetTemperature(22_degC);
+
+    ThermostatMetricsSnapshot metrics = stat.GetMetrics();
+    EXPECT_EQ(metrics.callbacks, 2u);
+    EXPECT_EQ(metrics.thresholdUpdates, 4u);
+    EXPECT_FALSE(controller.heating);
+}
+
+// Without metrics nothing is recorded.
+TEST(ThermostatMetricsUnit, NullMetrics) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    UnmeasuredThermostat stat(meter, controller);
+    meter.SetTemperature(50_degC);
+
+    ThermostatMetricsSnapshot metrics = stat.GetMetrics();
+    EXPECT_EQ(metrics.callbacks, 0u);
+    EXPECT_EQ(metrics.actuatorCalls, 0u);
+    EXPECT_EQ(metrics.actuatorLatency.Count(), 0u);
+    EXPECT_TRUE(controller.cooling);
+}
+
+// Only one event in the sample period is timed, every event is counted.
+TEST(ThermostatMetricsUnit, SampledLatencies) {
+    BasicThermostatMetrics<4> metrics;
+    for (int i = 0; i < 10; ++i) {
+        metrics.OnActuation(metrics.StartActuation());
+    }
+
+    ThermostatMetricsSnapshot snapshot = metrics.Snapshot();
+    EXPECT_EQ(snapshot.actuatorCalls, 10u);
+    EXPECT_EQ(snapshot.actuatorLatency.Count(), 2u);
+}
+
+// Manual checks, actuations and threshold updates come from the caller's thread and the sensor thread at once, and
+// none is lost.
+TEST(ThermostatMetricsUnit, ConcurrentUpdates) {
+    ThermostatMetrics metrics;
+    constexpr int updates = 100000;
+    auto update = [&metrics]() {
+        for (int i = 0; i < updates; ++i) {
+            metrics.OnManualCheck();
+            metrics.OnActuation(metrics.StartActuation());
+            metrics.OnThresholdUpdate(metrics.StartThresholdUpdate());
+        }
+    };
+    std::thread caller(update);
+    update();
+    caller.join();
+
+    ThermostatMetricsSnapshot snapshot = metrics.Snapshot();
+    EXPECT_EQ(snapshot.manualChecks, static_cast<std::uint64_t>(2 * updates));
+    EXPECT_EQ(snapshot.actuatorCalls, static_cast<std::uint64_t>(2 * updates));
+    EXPECT_EQ(snapshot.thresholdUpdates, static_cast<std::uint64_t>(2 * updates));
+}
+
+// Snapshots can be taken while the thermometer thread runs callbacks, and never go backwards.
+TEST(ThermostatMetricsUnit, SnapshotWhileRunning) {
+    FakeThermometer meter;
+    RecordingTemperatureController controller;
+    MeasuredThermostat stat(meter, controller);
+    constexpr int crossings = 20000;
+
+    std::thread sensor([&meter]() {
+        for (int i = 0; i < crossings; ++i) {
+            meter.SetTemperature(i % 2 == 0 ? 50_degC : 20_degC);
+        }
+    });
+    std::uint64_t previous = 0;
+    for (int i = 0; i < 1000; ++i) {
+        std::uint64_t callbacks = stat.GetMetrics().callbacks;
+        EXPECT_GE(callbacks, previous);
+        previous = callbacks;
+    }
+    sensor.join();
+
+    EXPECT_EQ(stat.GetMetrics().callbacks, static_cast<std::uint64_t>(crossings / 2));
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "../src/thermostat.h"
+#include "../src/thermostat_snapshot.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/mock_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Return;
+
+namespace {
+
+// Snapshot file in the test temporary directory, removed when the test ends.
+class SnapshotFile {
+public:
+    std::string path;
+
+    explicit SnapshotFile(const std::string &name): path(testing::TempDir() + name) { std::remove(this->path.c_str()); }
+    ~SnapshotFile() { std::remove(this->path.c_str()); }
+};
+
+} // namespace
+
+// States round trip through a snapshot file, and an aborted save leaves the previous snapshot in place.
+TEST(ThermostatSnapshotUnit, SaveAndOpen) {
+    SnapshotFile file("save_and_open.snap");
+    FakeThermometer meter;
+    meter.temperature = 5_degC;
+    RecordingTemperatureController controller;
+    Thermostat stat(meter, controller);
+    stat.SetTemperatureThresholds(25_degC, 15_degC);
+
+    ThermostatSnapshotWriter writer;
+    ASSERT_TRUE(writer.Create(file.path, 2));
+    writer[0] = stat.SaveState();
+    stat.SetDeadbandMode(21_degC, 2_degC, std::chrono::seconds(3));
+    writer[1] = stat.SaveState();
+    ASSERT_TRUE(writer.Commit());
+
+    ThermostatSnapshot snapshot;
+    ASSERT_TRUE(snapshot.Open(file.path));
+    ASSERT_EQ(snapshot.Size(), 2u);
+    EXPECT_EQ(snapshot[0].highTemperatureThreshold, 25_degC);
+    EXPECT_EQ(snapshot[0].lowTemperatureThreshold, 15_degC);
+    EXPECT_EQ(snapshot[0].lastReading, 5_degC);
+    EXPECT_EQ(snapshot[0].mode, 0);
+    EXPECT_EQ(snapshot[0].on, 1);
+    EXPECT_EQ(snapshot[0].heating, 1);
+    EXPECT_EQ(snapshot[0].cooling, 0);
+    EXPECT_EQ(snapshot[1].mode, 1);
+    EXPECT_EQ(snapshot[1].setpoint, 21_degC);
+    EXPECT_EQ(snapshot[1].deadband, 2_degC);
+    EXPECT_EQ(snapshot[1].minimumDwell, 3000000000);
+
+    ASSERT_TRUE(writer.Create(file.path, 5));
+    writer.Abort();
+    snapshot.Close();
+    ASSERT_TRUE(snapshot.Open(file.path));
+    EXPECT_EQ(snapshot.Size(), 2u);
+
+    // Files of another format or size are rejected.
+    std::ofstream(file.path, std::ios::app) << "trailing";
+    EXPECT_FALSE(snapshot.Open(file.path));
+    std::ofstream(file.path) << "not a snapshot";
+    EXPECT_FALSE(snapshot.Open(file.path));
+}
+
+// A restored thermostat registers its callback before setting the thresholds, and does not read the thermometer.
+TEST(ThermostatSnapshotUnit, RestoreDoesNotReadThermometer) {
+    MockThermometer meter;
+    RecordingTemperatureController controller;
+    ThermostatState state{};
+    state.highTemperatureThreshold = 25_degC;
+    state.lowTemperatureThreshold = 15_degC;
+    state.on = 1;
+    state.heating = 1;
+    {
+        InSequence sequence;
+        EXPECT_CALL(meter, RegisterCallback(_)).Times(1);
+        EXPECT_CALL(meter, SetTemperatureThresholds(25_degC, 15_degC)).WillOnce(Return(true));
+    }
+    EXPECT_CALL(meter, GetTemperature()).Times(0);
+
+    Thermostat stat(meter, controller, state);
+    EXPECT_EQ(controller.writes, 0);
+    EXPECT_EQ(stat.SaveState().heating, 1);
+}
+
+// The actuators are only written when a notification on restore calls for a different state.
+TEST(ThermostatSnapshotUnit, RestoreWritesOnlyChanges) {
+    FakeThermometer meter;
+    meter.temperature = 10_degC;
+    RecordingTemperatureController controller;
+    ThermostatState state{};
+    state.highTemperatureThreshold = 25_degC;
+    state.lowTemperatureThreshold = 15_degC;
+    state.on = 1;
+    state.heating = 1;
+
+    // Still cold: the low threshold notifies, and the controller is already heating.
+    Thermostat unchanged(meter, controller, state);
+    EXPECT_EQ(controller.writes, 0);
+
+    // Warmed up past the high threshold while down: the thermostat switches to cooling.
+    FakeThermometer warm;
+    warm.temperature = 30_degC;
+    Thermostat changed(warm, controller, state);
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_FALSE(controller.heating);
+
+    // Later notifications behave as usual.
+    controller.writes = 0;
+    meter.SetTemperature(20_degC);
+    meter.SetTemperature(30_degC);
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_GT(controller.writes, 0);
+}
+
+// A thermostat restored in deadband mode keeps its state and re-arms the thresholds for it.
+TEST(ThermostatSnapshotUnit, RestoreDeadband) {
+    FakeThermometer meter;
+    meter.temperature = 18_degC;
+    RecordingTemperatureController controller;
+    ThermostatState state{};
+    state.mode = 1;
+    state.setpoint = 21_degC;
+    state.deadband = 2_degC;
+    state.on = 1;
+    state.heating = 1;
+
+    Thermostat stat(meter, controller, state);
+    EXPECT_EQ(controller.writes, 0);
+    EXPECT_EQ(meter.high, 21_degC);
+
+    meter.SetTemperature(22_degC);
+    EXPECT_FALSE(controller.heating);
+    EXPECT_FALSE(controller.cooling);
+}
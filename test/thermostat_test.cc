@@ -3,6 +3,8 @@
 #include "../src/test/mock_thermometer.h"
 #include "../src/test/mock_temperature_controller.h"
 
+using namespace temperature_literals;
+
 using ::testing::AtLeast;
 using ::testing::Return;
 using ::testing::_;
@@ -22,7 +24,7 @@ TEST(ThermostatUnit, Happy) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20)); 
+        .WillOnce(Return(20_degC)); 
     EXPECT_CALL(controller, Heat(false))
         .Times(1); 
     EXPECT_CALL(controller, Cool(false))
@@ -44,7 +46,7 @@ TEST(ThermostatUnit, StartWithHightemp) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(50)); 
+        .WillOnce(Return(50_degC)); 
     EXPECT_CALL(controller, Heat(false))
         .Times(1); 
     EXPECT_CALL(controller, Cool(true))
@@ -66,7 +68,7 @@ TEST(ThermostatUnit, StartWithLowTemp) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(-10)); 
+        .WillOnce(Return(-10_degC)); 
     EXPECT_CALL(controller, Heat(true))
         .Times(1); 
     EXPECT_CALL(controller, Cool(false))
@@ -88,7 +90,7 @@ TEST(ThermostatUnit, HeatWhenLowTemp) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
  
     // Expect 1x call for Heat(false) and Cool(false) (constructor)
     // Expect 1x call for Heat(true) and Cool(false) to heat the room
@@ -121,7 +123,7 @@ TEST(ThermostatUnit, CoolWhenHighTemp) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
  
     // Expect 1x call for Heat(false) and Cool(false) (constructor)
     // Expect 1x call for Heat(false) and Cool(true) to Cool the room
@@ -151,28 +153,28 @@ TEST(ThermostatUnit, AdjustThresholdsWhenRequested) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
     EXPECT_CALL(controller, Cool(false))
         .Times(1); 
     EXPECT_CALL(controller, Heat(false))
         .Times(1); 
 
     // Check that the underlying thermometer calls are made to adjust notification threshold
-    EXPECT_CALL(meter, SetTemperatureThresholds(20,15))
+    EXPECT_CALL(meter, SetTemperatureThresholds(20_degC, 15_degC))
         .WillOnce(Return(true)); 
-    EXPECT_CALL(meter, SetTemperatureThresholds(10,5))
+    EXPECT_CALL(meter, SetTemperatureThresholds(10_degC, 5_degC))
         .WillOnce(Return(true)); 
-    EXPECT_CALL(meter, SetTemperatureThresholds(80,0))
+    EXPECT_CALL(meter, SetTemperatureThresholds(80_degC, 0_degC))
         .WillOnce(Return(true)); 
 
     // This expectation will be met by the thermostat constructor, not the tests below
-    EXPECT_CALL(meter, SetTemperatureThresholds(40,10))
+    EXPECT_CALL(meter, SetTemperatureThresholds(40_degC, 10_degC))
         .WillOnce(Return(true)); 
 
     Thermostat stat(meter, controller);
-    stat.SetTemperatureThresholds(80,0);
-    stat.SetTemperatureThresholds(10,5);
-    stat.SetTemperatureThresholds(20,15);
+    stat.SetTemperatureThresholds(80_degC, 0_degC);
+    stat.SetTemperatureThresholds(10_degC, 5_degC);
+    stat.SetTemperatureThresholds(20_degC, 15_degC);
 }
 
 // Check whether invalid values for threshold configuration are rejected
@@ -188,7 +190,7 @@ TEST(ThermostatUnit, InvalidThresholds) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
     EXPECT_CALL(controller, Cool(false))
         .Times(1); 
     EXPECT_CALL(controller, Heat(false))
@@ -196,10 +198,10 @@ TEST(ThermostatUnit, InvalidThresholds) {
 
     Thermostat stat(meter, controller); 
     // Limiting the expectation of the numbe of calls to (meter, SetTemperatureThresholds) to 1 ensures that the calls below will be rejected.
-    EXPECT_EQ(stat.SetTemperatureThresholds(-5,0), false);
-    EXPECT_EQ(stat.SetTemperatureThresholds(10,10), false);
-    EXPECT_EQ(stat.SetTemperatureThresholds(5,10), false);
-    EXPECT_EQ(stat.SetTemperatureThresholds(20,80), false);
+    EXPECT_EQ(stat.SetTemperatureThresholds(-5_degC, 0_degC), false);
+    EXPECT_EQ(stat.SetTemperatureThresholds(10_degC, 10_degC), false);
+    EXPECT_EQ(stat.SetTemperatureThresholds(5_degC, 10_degC), false);
+    EXPECT_EQ(stat.SetTemperatureThresholds(20_degC, 80_degC), false);
 }
 
 // Check that the temperature controller isn't triggered if the thermostat is deisabled
@@ -215,7 +217,7 @@ TEST(ThermostatUnit, NoActionWhenThermostatDisabled) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
     EXPECT_CALL(controller, Cool(false))
         .Times(1); 
     EXPECT_CALL(controller, Heat(false))
@@ -250,10 +252,10 @@ TEST(ThermostatUnit, ReenableThermostat) {
     // 3x when thermostat is reenabled - return 20, then 50, then -10
     EXPECT_CALL(meter, GetTemperature())
         .Times(4)
-        .WillOnce(Return(20))
-        .WillOnce(Return(20))
-        .WillOnce(Return(50))
-        .WillOnce(Return(-10));
+        .WillOnce(Return(20_degC))
+        .WillOnce(Return(20_degC))
+        .WillOnce(Return(50_degC))
+        .WillOnce(Return(-10_degC));
 
     // From constructor, expect Heat(false) and Cool(false) - temperature within low and high thresholds
     // After first thermostat disable-reenable, expect Heat(false) and Cool(false) - temperature within high and low thresholds
@@ -313,7 +315,7 @@ TEST(ThermostatUnit, HeatAndCoolSequence) {
         .Times(1); 
     EXPECT_CALL(meter, GetTemperature())
         .Times(AtLeast(1))
-        .WillOnce(Return(20));
+        .WillOnce(Return(20_degC));
 
     {
         InSequence seq;
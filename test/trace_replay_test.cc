@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "../src/trace_replay.h"
+#include "../src/work_stealing_pool.h"
+
+using namespace std::chrono_literals;
+using namespace temperature_literals;
+
+namespace {
+
+// Trace sweeping between the given temperatures, one sample per minute.
+Trace Sweep(int low, int high, int samples) {
+    Trace trace;
+    int temperature = (low + high) / 2;
+    int direction = 1;
+    for (int i = 0; i < samples; ++i) {
+        trace.push_back(TraceSample{std::chrono::minutes(i), Temperature::FromCelsius(temperature)});
+        if (temperature >= high || temperature <= low) {
+            direction = temperature >= high ? -1 : 1;
+        }
+        temperature += direction;
+    }
+    return trace;
+}
+
+} // namespace
+
+// Every task runs once, including tasks submitted by tasks, and idle workers steal queued tasks.
+TEST(WorkStealingPoolUnit, RunsEveryTask) {
+    WorkStealingPool pool(4);
+    std::atomic<int> done(0);
+    for (int i = 0; i < 100; ++i) {
+        pool.Submit([&pool, &done]() {
+            for (int j = 0; j < 10; ++j) {
+                pool.Submit([&done]() { done.fetch_add(1); });
+            }
+            done.fetch_add(1);
+        });
+    }
+    pool.Wait();
+    EXPECT_EQ(done.load(), 1100);
+    EXPECT_EQ(pool.Size(), 4u);
+}
+
+// The trace thermometer notifies crossings, and notifies at once when new thresholds are already exceeded.
+TEST(TraceReplayUnit, ThermometerFollowsContract) {
+    TraceThermometer meter(30_degC);
+    std::vector<bool> notifications;
+    meter.RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+
+    EXPECT_FALSE(meter.SetTemperatureThresholds(10_degC, 10_degC));
+    EXPECT_TRUE(meter.SetTemperatureThresholds(25_degC, 15_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{true}));
+
+    meter.Feed(20_degC);
+    meter.Feed(10_degC);
+    meter.Feed(12_degC);
+    EXPECT_EQ(meter.GetTemperature(), 12_degC);
+    EXPECT_EQ(notifications, (std::vector<bool>{true, false}));
+}
+
+// A trace crossing the thresholds records the thermostat decisions at the time of the samples.
+TEST(TraceReplayUnit, ReplayRecordsCommands) {
+    Trace trace{{0ms, 20_degC}, {1min, 26_degC}, {2min, 20_degC}, {3min, 14_degC}};
+    CommandStream commands = ReplayTrace(trace, [](ReplayThermostat &stat) {
+        stat.SetTemperatureThresholds(25_degC, 15_degC);
+    });
+
+    // Idle at start, cooling at 26, heating at 14.
+    CommandStream expected{
+            {0ms, Actuator::Heat, false}, {0ms, Actuator::Cool, false},
+            {1min, Actuator::Cool, true}, {1min, Actuator::Heat, false},
+            {3min, Actuator::Heat, true}, {3min, Actuator::Cool, false}};
+    EXPECT_EQ(commands, expected);
+}
+
+// The dwell time of the deadband mode uses the trace time.
+TEST(TraceReplayUnit, DwellUsesTraceTime) {
+    Trace trace{{0ms, 21_degC}, {1min, 17_degC}, {2min, 22_degC}, {3min, 22_degC}, {12min, 22_degC}};
+    CommandStream commands = ReplayTrace(trace, [](ReplayThermostat &stat) {
+        stat.SetDeadbandMode(21_degC, 2_degC, 10min);
+    });
+
+    // Heating starts at 1min, reaching the setpoint at 2min only stops it once the dwell time has elapsed.
+    ASSERT_GE(commands.size(), 4u);
+    EXPECT_EQ(commands[commands.size() - 3], (ActuatorCommand{1min, Actuator::Cool, false}));
+    EXPECT_EQ(commands[commands.size() - 2], (ActuatorCommand{12min, Actuator::Heat, false}));
+    EXPECT_EQ(commands.back(), (ActuatorCommand{12min, Actuator::Cool, false}));
+}
+
+// Replaying on many threads gives the same streams as one thread, and a changed policy is reported.
+TEST(TraceReplayUnit, ParallelReplayAndDivergence) {
+    std::vector<Trace> traces;
+    for (int i = 0; i < 64; ++i) {
+        traces.push_back(Sweep(10 - i % 5, 30 + i % 7, 200 + 50 * (i % 9)));
+    }
+    ReplayConfiguration thresholds = [](ReplayThermostat &stat) { stat.SetTemperatureThresholds(25_degC, 15_degC); };
+
+    WorkStealingPool single(1);
+    WorkStealingPool pool(4);
+    ReplayResult baseline = ReplayTraces(traces, thresholds, single);
+    ReplayResult candidate = ReplayTraces(traces, thresholds, pool);
+    EXPECT_EQ(baseline.samples, candidate.samples);
+    EXPECT_GT(candidate.SamplesPerSecond(), 0.0);
+    EXPECT_TRUE(CompareCommandStreams(baseline.commands, candidate.commands).empty());
+
+    ReplayConfiguration raised = [](ReplayThermostat &stat) { stat.SetTemperatureThresholds(26_degC, 15_degC); };
+    ReplayResult changed = ReplayTraces(traces, raised, pool);
+    std::vector<ReplayDivergence> divergences = CompareCommandStreams(baseline.commands, changed.commands);
+    EXPECT_EQ(divergences.size(), traces.size());
+    EXPECT_EQ(divergences.front().trace, 0u);
+    EXPECT_EQ(divergences.front().command, 2u);
+}
+
+// Traces and command streams round trip through their text files.
+TEST(TraceReplayUnit, Files) {
+    std::string tracePath = testing::TempDir() + "trace_replay_trace.csv";
+    std::string streamsPath = testing::TempDir() + "trace_replay_streams.txt";
+    std::ofstream(tracePath) << "0,20\n60000,26\n\n120000,14\n";
+
+    Trace trace;
+    ASSERT_TRUE(LoadTrace(tracePath, trace));
+    ASSERT_EQ(trace.size(), 3u);
+    EXPECT_EQ(trace[1].time, 1min);
+    EXPECT_EQ(trace[1].temperature, 26_degC);
+
+    std::vector<CommandStream> streams{ReplayTrace(trace, {}), {}, ReplayTrace(trace, {})};
+    ASSERT_TRUE(SaveCommandStreams(streamsPath, streams));
+    std::vector<CommandStream> loaded;
+    ASSERT_TRUE(LoadCommandStreams(streamsPath, loaded));
+    EXPECT_EQ(loaded, streams);
+
+    std::ofstream(tracePath) << "0;20\n";
+    EXPECT_FALSE(LoadTrace(tracePath, trace));
+    std::remove(tracePath.c_str());
+    std::remove(streamsPath.c_str());
+}
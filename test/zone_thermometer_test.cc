@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../src/thermostat.h"
+#include "../src/zone_thermometer.h"
+#include "../src/test/fake_thermometer.h"
+#include "../src/test/recording_temperature_controller.h"
+
+using namespace temperature_literals;
+
+namespace {
+
+// Aggregate in tenths of a degree computed from scratch, as the reference for the incremental one.
+int Reference(Aggregation kind, std::vector<int> readings) {
+    std::sort(readings.begin(), readings.end());
+    std::size_t n = readings.size();
+    switch (kind) {
+    case Aggregation::Min:
+        return readings.front();
+    case Aggregation::Max:
+        return readings.back();
+    case Aggregation::Median:
+        if (n % 2 == 1) {
+            return readings[n / 2];
+        }
+        return static_cast<int>(std::lround((readings[n / 2 - 1] + readings[n / 2]) / 2.0));
+    case Aggregation::Mean:
+    default:
+        return static_cast<int>(std::lround(std::accumulate(readings.begin(), readings.end(), 0.0) / n));
+    }
+}
+
+// Sensors of one zone, with a zone thermometer over them.
+struct Zone {
+    std::vector<std::unique_ptr<FakeThermometer>> sensors;
+    std::unique_ptr<ZoneThermometer> thermometer;
+
+    Zone(std::vector<Temperature> temperatures, Aggregation kind, Temperature resolution = 1_degC) {
+        std::vector<Thermometer *> pointers;
+        for (Temperature temperature : temperatures) {
+            this->sensors.push_back(std::make_unique<FakeThermometer>());
+            this->sensors.back()->temperature = temperature;
+            pointers.push_back(this->sensors.back().get());
+        }
+        this->thermometer = std::make_unique<ZoneThermometer>(pointers, kind, resolution);
+    }
+};
+
+} // namespace
+
+// Incremental aggregates match aggregates computed from scratch over random updates.
+TEST(ZoneThermometerUnit, AggregateMatchesReference) {
+    std::mt19937 random(11);
+    for (Aggregation kind : {Aggregation::Mean, Aggregation::Median, Aggregation::Min, Aggregation::Max}) {
+        for (std::size_t sensors : {1u, 2u, 5u, 32u}) {
+            SensorAggregate aggregate(kind, sensors);
+            std::vector<int> readings(sensors, 0);
+            EXPECT_EQ(aggregate.Value(), 0_degC);
+            for (int step = 0; step < 2000; ++step) {
+                std::size_t sensor = random() % sensors;
+                readings[sensor] = static_cast<int>(random() % 801) - 400;
+                aggregate.Update(sensor, Temperature::FromDeciCelsius(readings[sensor]));
+                ASSERT_EQ(aggregate.Value().DeciCelsius(), Reference(kind, readings))
+                        << "aggregation " << static_cast<int>(kind) << ", " << sensors << " sensors, step " << step;
+            }
+        }
+    }
+}
+
+// The zone follows the sensors that move by the resolution or more, and ignores smaller moves.
+TEST(ZoneThermometerUnit, FollowsSensors) {
+    Zone zone({20_degC, 22_degC, 24_degC, 30_degC}, Aggregation::Median, 1_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 23_degC);
+
+    zone.sensors[0]->SetTemperature(20.9_degC);
+    EXPECT_EQ(zone.thermometer->SensorReading(0), 20_degC);
+    zone.sensors[0]->SetTemperature(19_degC);
+    EXPECT_EQ(zone.thermometer->SensorReading(0), 19_degC);
+    zone.sensors[0]->SetTemperature(26_degC);
+    EXPECT_EQ(zone.thermometer->SensorReading(0), 26_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 25_degC);
+
+    zone.sensors[3]->SetTemperature(10_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 23_degC);
+}
+
+// With the default resolution, a move of a single sensor by that resolution reaches the aggregate.
+TEST(ZoneThermometerUnit, DefaultResolution) {
+    Zone zone({20_degC, 20_degC}, Aggregation::Max, ZoneThermometer::minimumResolution);
+    zone.sensors[0]->SetTemperature(20.1_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 20_degC);
+    zone.sensors[0]->SetTemperature(20.2_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 20.2_degC);
+    zone.sensors[0]->SetTemperature(20_degC);
+    EXPECT_EQ(zone.thermometer->GetTemperature(), 20_degC);
+
+    // Resolutions finer than the minimum are raised to it.
+    ZoneThermometer fine({zone.sensors[1].get()}, Aggregation::Max, 0.1_degC);
+    zone.sensors[1]->SetTemperature(20.2_degC);
+    EXPECT_EQ(fine.GetTemperature(), 20.2_degC);
+}
+
+// The zone notifies crossings of its aggregate as the Thermometer interface documents, and drives a thermostat.
+TEST(ZoneThermometerUnit, DrivesThermostat) {
+    Zone zone({20_degC, 20_degC, 20_degC, 20_degC}, Aggregation::Min, 1_degC);
+    std::vector<bool> notifications;
+    zone.thermometer->RegisterCallback([&notifications](bool isHigh) { notifications.push_back(isHigh); });
+    EXPECT_FALSE(zone.thermometer->SetTemperatureThresholds(15_degC, 15_degC));
+    EXPECT_TRUE(zone.thermometer->SetTemperatureThresholds(25_degC, 15_degC));
+    EXPECT_TRUE(notifications.empty());
+
+    zone.sensors[2]->SetTemperature(12_degC);
+    EXPECT_EQ(notifications, (std::vector<bool>{false}));
+    // Already exceeded thresholds notify when set.
+    EXPECT_TRUE(zone.thermometer->SetTemperatureThresholds(25_degC, 14_degC));
+    EXPECT_EQ(notifications, (std::vector<bool>{false, false}));
+
+    RecordingTemperatureController controller;
+    Thermostat stat(*zone.thermometer, controller);
+    stat.SetTemperatureThresholds(25_degC, 15_degC);
+    EXPECT_TRUE(controller.heating);
+    zone.sensors[2]->SetTemperature(30_degC);
+    zone.sensors[0]->SetTemperature(30_degC);
+    zone.sensors[1]->SetTemperature(30_degC);
+    EXPECT_TRUE(controller.heating);
+    zone.sensors[3]->SetTemperature(30_degC);
+    EXPECT_TRUE(controller.cooling);
+    EXPECT_FALSE(controller.heating);
+}
@@ -0,0 +1,151 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/trace_replay.h"
+
+namespace {
+
+void PrintUsage() {
+    std::cerr << "usage: trace_replay [--threads N] [--thresholds HIGH LOW | --deadband SETPOINT BAND [DWELL_MS]]\n"
+                 "                    [--filter none|exponential|average|kalman] [--debounce MS]\n"
+                 "                    [--record FILE] [--compare FILE] TRACE...\n"
+                 "Replays sensor traces (\"milliseconds,temperature\" lines) through the thermostat. Temperatures\n"
+                 "are in degrees Celsius, e.g. 21.5. --filter and --debounce put a filtered thermometer with default\n"
+                 "settings between the traces and the thermostat. --record saves the command streams, --compare\n"
+                 "reports where they differ from saved ones.\n";
+}
+
+bool ParseInt(const char *text, long &value) {
+    char *end = nullptr;
+    value = std::strtol(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+bool ParseSmoothing(const char *text, Smoothing &value) {
+    const char *const names[] = {"none", "exponential", "average", "kalman"};
+    const Smoothing kinds[] = {Smoothing::None, Smoothing::Exponential, Smoothing::MovingAverage, Smoothing::Kalman};
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (std::strcmp(text, names[i]) == 0) {
+            value = kinds[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseTemperature(const char *text, Temperature &value) {
+    char *end = nullptr;
+    value = Temperature::FromCelsiusRounded(std::strtod(text, &end));
+    return end != text && *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    unsigned threads = 0;
+    ReplayConfiguration configure;
+    FilterSettings filter;
+    bool filtered = false;
+    std::string recordPath;
+    std::string comparePath;
+    std::vector<std::string> tracePaths;
+
+    for (int i = 1; i < argc; ++i) {
+        long first = 0;
+        Temperature high;
+        Temperature low;
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc && ParseInt(argv[i + 1], first) && first >= 0) {
+            threads = static_cast<unsigned>(first);
+            i += 1;
+        }
+        else if (std::strcmp(argv[i], "--thresholds") == 0 && i + 2 < argc && ParseTemperature(argv[i + 1], high) &&
+                 ParseTemperature(argv[i + 2], low)) {
+            configure = [high, low](ReplayThermostat &stat) { stat.SetTemperatureThresholds(high, low); };
+            i += 2;
+        }
+        else if (std::strcmp(argv[i], "--deadband") == 0 && i + 2 < argc && ParseTemperature(argv[i + 1], high) &&
+                 ParseTemperature(argv[i + 2], low)) {
+            Temperature setpoint = high;
+            Temperature band = low;
+            long dwell = 0;
+            i += 2;
+            if (i + 1 < argc && ParseInt(argv[i + 1], dwell)) {
+                i += 1;
+            }
+            configure = [setpoint, band, dwell](ReplayThermostat &stat) {
+                stat.SetDeadbandMode(setpoint, band, std::chrono::milliseconds(dwell));
+            };
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc &&
+                 ParseSmoothing(argv[i + 1], filter.smoothing)) {
+            filtered = true;
+            i += 1;
+        }
+        else if (std::strcmp(argv[i], "--debounce") == 0 && i + 1 < argc && ParseInt(argv[i + 1], first) &&
+                 first >= 0) {
+            filter.debounce = std::chrono::milliseconds(first);
+            filtered = true;
+            i += 1;
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            comparePath = argv[++i];
+        }
+        else if (argv[i][0] == '-') {
+            PrintUsage();
+            return 2;
+        }
+        else {
+            tracePaths.push_back(argv[i]);
+        }
+    }
+    if (tracePaths.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<Trace> traces(tracePaths.size());
+    for (std::size_t i = 0; i < tracePaths.size(); ++i) {
+        if (!LoadTrace(tracePaths[i], traces[i])) {
+            std::cerr << "cannot read trace " << tracePaths[i] << '\n';
+            return 2;
+        }
+    }
+
+    WorkStealingPool pool(threads);
+    ReplayResult result = ReplayTraces(traces, configure, pool, filtered ? &filter : nullptr);
+    std::size_t commands = 0;
+    for (const CommandStream &stream : result.commands) {
+        commands += stream.size();
+    }
+    std::cout << "replayed " << traces.size() << " traces, " << result.samples << " samples in "
+              << std::chrono::duration<double, std::milli>(result.elapsed).count() << " ms on " << pool.Size()
+              << " threads: " << result.SamplesPerSecond() << " samples/s, " << result.steals << " steals, "
+              << commands << " actuator commands\n";
+
+    if (!recordPath.empty() && !SaveCommandStreams(recordPath, result.commands)) {
+        std::cerr << "cannot write " << recordPath << '\n';
+        return 2;
+    }
+
+    if (!comparePath.empty()) {
+        std::vector<CommandStream> baseline;
+        if (!LoadCommandStreams(comparePath, baseline)) {
+            std::cerr << "cannot read command streams " << comparePath << '\n';
+            return 2;
+        }
+        std::vector<ReplayDivergence> divergences = CompareCommandStreams(baseline, result.commands);
+        for (const ReplayDivergence &divergence : divergences) {
+            std::cout << "divergence: "
+                      << (divergence.trace < tracePaths.size() ? tracePaths[divergence.trace] : "missing trace")
+                      << " at command " << divergence.command << '\n';
+        }
+        std::cout << divergences.size() << " of " << traces.size() << " traces diverge\n";
+        return divergences.empty() ? 0 : 1;
+    }
+    return 0;
+}